@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace NetworkMonitor::Benchmarks {
+
+/*! \brief A registered benchmark.
+ */
+struct Benchmark {
+    std::string name {};
+    std::function<void ()> run {};
+};
+
+/*! \brief Get all the registered benchmarks.
+ */
+inline std::vector<Benchmark>& GetBenchmarks()
+{
+    static std::vector<Benchmark> benchmarks {};
+    return benchmarks;
+}
+
+/*! \brief Register a benchmark at static initialization time.
+ */
+struct Registrar {
+    Registrar(
+        const std::string& name,
+        std::function<void ()> run
+    )
+    {
+        GetBenchmarks().push_back({name, std::move(run)});
+    }
+};
+
+/*! \brief Prevent the compiler from optimizing away a computed value.
+ */
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/*! \brief Time `iterations` calls of `fn` and print the time per call.
+ *
+ *  `fn` is called once before timing starts, to warm up caches and scratch
+ *  buffers.
+ */
+template <typename Fn>
+double Measure(
+    const std::string& label,
+    const size_t iterations,
+    Fn&& fn
+)
+{
+    fn();
+    const auto start {std::chrono::steady_clock::now()};
+    for (size_t idx {0}; idx < iterations; ++idx) {
+        fn();
+    }
+    const auto stop {std::chrono::steady_clock::now()};
+    const double nsPerCall {
+        std::chrono::duration<double, std::nano>(stop - start).count()
+        / iterations
+    };
+    std::cout << "  " << std::left << std::setw(48) << label
+              << std::right << std::setw(14) << std::fixed
+              << std::setprecision(1) << nsPerCall << " ns/op" << std::endl;
+    return nsPerCall;
+}
+
+} // namespace NetworkMonitor::Benchmarks
+
+#define NETWORK_MONITOR_BENCHMARK_CONCAT_(a, b) a##b
+#define NETWORK_MONITOR_BENCHMARK_CONCAT(a, b) \
+    NETWORK_MONITOR_BENCHMARK_CONCAT_(a, b)
+
+/*! \brief Define and register a benchmark function.
+ */
+#define NETWORK_MONITOR_BENCHMARK(name)                                      \
+    static void name();                                                      \
+    static const NetworkMonitor::Benchmarks::Registrar                      \
+        NETWORK_MONITOR_BENCHMARK_CONCAT(gRegistrar_, name) {#name, name};  \
+    static void name()
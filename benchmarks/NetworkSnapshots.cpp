@@ -0,0 +1,69 @@
+#include "Benchmark.h"
+
+#include <network-monitor/FileDownloader.h>
+#include <network-monitor/NetworkSnapshots.h>
+#include <network-monitor/TransportNetwork.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::NetworkSnapshots;
+using NetworkMonitor::ParseJsonFile;
+using NetworkMonitor::StationHandle;
+using NetworkMonitor::TransportNetwork;
+
+using NetworkMonitor::Benchmarks::DoNotOptimize;
+using NetworkMonitor::Benchmarks::Measure;
+
+NETWORK_MONITOR_BENCHMARK(network_snapshots)
+{
+	TransportNetwork nw {};
+	if (!nw.FromJson(ParseJsonFile(BENCHMARKS_NETWORK_LAYOUT_JSON))) {
+		throw std::runtime_error("Could not load the network layout");
+	}
+	const auto nStations {static_cast<uint32_t>(nw.GetStationCount())};
+	NetworkSnapshots snapshots {nw};
+
+	uint32_t station {0};
+	Measure("Direct read", 1000000, [&]() {
+		DoNotOptimize(nw.GetRoutesServingStation(StationHandle {station}).size());
+		station = (station + 1) % nStations;
+	});
+	Measure("Snapshot read", 1000000, [&]() {
+		auto snapshot {snapshots.Read()};
+		DoNotOptimize(
+			snapshot->GetRoutesServingStation(StationHandle {station}).size()
+		);
+		station = (station + 1) % nStations;
+	});
+
+	// Readers keep reading while the layout is reloaded.
+	for (const size_t nReaders: {1, 4}) {
+		std::atomic<bool> done {false};
+		std::vector<std::thread> readers {};
+		for (size_t idx {0}; idx < nReaders; ++idx) {
+			readers.emplace_back([&snapshots, &done, nStations]() {
+				uint32_t station {0};
+				while (!done) {
+					auto snapshot {snapshots.Read()};
+					DoNotOptimize(snapshot->GetRoutesServingStation(
+						StationHandle {station}
+					).size());
+					station = (station + 1) % nStations;
+				}
+			});
+		}
+		Measure(
+			"Publish, " + std::to_string(nReaders) + " readers",
+			100,
+			[&]() { snapshots.Publish(nw); }
+		);
+		done = true;
+		for (auto& reader: readers) {
+			reader.join();
+		}
+	}
+}
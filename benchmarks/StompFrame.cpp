@@ -0,0 +1,159 @@
+#include "Benchmark.h"
+
+#include <network-monitor/StompFrame.h>
+#include <network-monitor/StompParser.h>
+
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+using NetworkMonitor::BufferedStompFrame;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompHeader;
+using NetworkMonitor::StompParser;
+
+using NetworkMonitor::Benchmarks::DoNotOptimize;
+using NetworkMonitor::Benchmarks::Measure;
+
+// A passenger event, as pushed by the network events feed.
+static std::string GetPassengerEventFrame()
+{
+	const std::string body {
+		"{\"datetime\":\"2020-11-01T07:18:50.234000Z\","
+		"\"passenger_event\":\"in\","
+		"\"station_id\":\"station_211\"}"
+	};
+	return "MESSAGE\n"
+		"destination:/passengers\n"
+		"message-id:a8b1c8f4-4c4b-4e5b-9e3e-27e42fc7fe4b\n"
+		"subscription:2dc7a5a6-65c4-4a32-a4b6-ca4fdda1d1b6\n"
+		"content-type:application/json\n"
+		"content-length:" + std::to_string(body.size()) + "\n"
+		"\n"
+		+ body + std::string(1, '\0');
+}
+
+NETWORK_MONITOR_BENCHMARK(stomp_frame)
+{
+	const auto plain {GetPassengerEventFrame()};
+	StompError error {};
+
+	// Both frames take ownership of a copy of the received message.
+	Measure("StompFrame", 1000000, [&]() {
+		StompFrame frame {error, std::string {plain}};
+		DoNotOptimize(frame.GetBody().size());
+	});
+	Measure("BufferedStompFrame", 1000000, [&]() {
+		BufferedStompFrame frame {error, std::string {plain}};
+		DoNotOptimize(frame.GetBody().size());
+	});
+
+	// Lookups of the headers a passenger event handler reads.
+	const StompFrame frame {error, plain};
+	Measure("StompFrame::GetHeaderValue", 1000000, [&]() {
+		DoNotOptimize(frame.GetHeaderValue(StompHeader::kDestination).size());
+		DoNotOptimize(frame.GetHeaderValue(StompHeader::kContentType).size());
+		DoNotOptimize(frame.GetHeaderValue(StompHeader::kReceipt).size());
+	});
+	if (error != StompError::kOk) {
+		throw std::runtime_error("Could not parse the frame");
+	}
+}
+
+// A frame with every known header, each with a 36-character value.
+static std::string GetHeaderHeavyFrame()
+{
+	std::string frame {"SEND\n"};
+	for (size_t idx {0}; idx < static_cast<size_t>(StompHeader::kUnknown); ++idx) {
+		const auto header {static_cast<StompHeader>(idx)};
+		frame += ToString(header);
+		frame += header == StompHeader::kContentLength
+			? ":0"
+			: ":2dc7a5a6-65c4-4a32-a4b6-ca4fdda1d1b6";
+		frame += "\n";
+	}
+	return frame + "\n" + std::string(1, '\0');
+}
+
+// A MESSAGE frame with a 64 KiB JSON body, with or without content-length.
+static std::string GetBodyHeavyFrame(
+	const bool hasContentLength
+)
+{
+	std::string body {"["};
+	while (body.size() < 64 * 1024) {
+		body += "{\"passenger_event\":\"in\",\"station_id\":\"station_211\"},\n";
+	}
+	body.back() = ']';
+	return "MESSAGE\n"
+		"destination:/passengers\n"
+		"message-id:a8b1c8f4-4c4b-4e5b-9e3e-27e42fc7fe4b\n"
+		"subscription:2dc7a5a6-65c4-4a32-a4b6-ca4fdda1d1b6\n"
+		+ (hasContentLength
+			? "content-length:" + std::to_string(body.size()) + "\n"
+			: "")
+		+ "\n"
+		+ body + std::string(1, '\0');
+}
+
+NETWORK_MONITOR_BENCHMARK(stomp_frame_scanning)
+{
+	StompError error {};
+	const auto check {[&error]() {
+		if (error != StompError::kOk) {
+			throw std::runtime_error("Could not parse the frame");
+		}
+	}};
+
+	// Copying the message is part of each measure: "copy" is its share.
+	for (const auto& [label, plain, iterations]: {
+		std::tuple {"Header-heavy", GetHeaderHeavyFrame(), 1000000},
+		std::tuple {"Body-heavy", GetBodyHeavyFrame(false), 20000},
+		std::tuple {"Body-heavy, content-length", GetBodyHeavyFrame(true), 20000},
+	}) {
+		const std::string size {" (" + std::to_string(plain.size()) + " B)"};
+		Measure(label + size + ", copy", iterations, [&]() {
+			std::string copy {plain};
+			DoNotOptimize(copy.data());
+		});
+		Measure(label + size, iterations, [&]() {
+			BufferedStompFrame frame {error, std::string {plain}};
+			DoNotOptimize(frame.GetBody().size());
+		});
+		check();
+	}
+}
+
+NETWORK_MONITOR_BENCHMARK(stomp_parser)
+{
+	// A stream of passenger events, with a heart-beat after each.
+	constexpr size_t nFrames {64};
+	const auto frame {GetPassengerEventFrame() + "\n"};
+	std::string stream {};
+	for (size_t idx {0}; idx < nFrames; ++idx) {
+		stream += frame;
+	}
+
+	size_t nParsed {0};
+	StompParser parser {[&nParsed](auto error, auto&& parsed) {
+		nParsed += error == StompError::kOk;
+		DoNotOptimize(parsed.GetBody().size());
+	}};
+	const std::string_view streamView {stream};
+	for (const size_t chunkSize: {frame.size(), size_t {1024}, stream.size()}) {
+		Measure(
+			std::to_string(nFrames) + " frames, chunks of "
+				+ std::to_string(chunkSize) + " B",
+			10000,
+			[&]() {
+				for (size_t offset {0}; offset < stream.size(); offset += chunkSize) {
+					parser.Push(streamView.substr(offset, chunkSize));
+				}
+			}
+		);
+	}
+	if (nParsed % nFrames != 0 || parser.GetBufferedSize() != 0) {
+		throw std::runtime_error("Could not parse the stream");
+	}
+}
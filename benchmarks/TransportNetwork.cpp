@@ -0,0 +1,434 @@
+#include "Benchmark.h"
+
+#include <network-monitor/FileDownloader.h>
+#include <network-monitor/MappedTransportNetwork.h>
+#include <network-monitor/TransportNetwork.h>
+
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::ParseJsonFile;
+using NetworkMonitor::StationHandle;
+using NetworkMonitor::TransportNetwork;
+
+using NetworkMonitor::Benchmarks::DoNotOptimize;
+using NetworkMonitor::Benchmarks::Measure;
+
+static TransportNetwork LoadNetworkLayout()
+{
+	TransportNetwork nw {};
+	if (!nw.FromJson(ParseJsonFile(BENCHMARKS_NETWORK_LAYOUT_JSON))) {
+		throw std::runtime_error("Could not load the network layout");
+	}
+	return nw;
+}
+
+// Random pairs of stations, the same for every run.
+static std::vector<std::pair<StationHandle, StationHandle>> GetStationPairs(
+	const TransportNetwork& nw,
+	const size_t nPairs
+)
+{
+	const auto nStations {nw.GetStationCount()};
+	std::mt19937 generator {42};
+	std::uniform_int_distribution<uint32_t> station(0, nStations - 1);
+	std::vector<std::pair<StationHandle, StationHandle>> pairs {};
+	for (size_t idx {0}; idx < nPairs; ++idx) {
+		pairs.push_back({{station(generator)}, {station(generator)}});
+	}
+	return pairs;
+}
+
+NETWORK_MONITOR_BENCHMARK(fastest_travel_time)
+{
+	auto nw {LoadNetworkLayout()};
+	const auto pairs {GetStationPairs(nw, 1024)};
+
+	size_t idx {0};
+	Measure("Dijkstra, network-layout.json", 20000, [&]() {
+		const auto& [stationA, stationB] {pairs[idx++ % pairs.size()]};
+		DoNotOptimize(nw.GetFastestTravelTime(stationA, stationB));
+	});
+
+	Measure("Contraction hierarchy build", 20, [&]() {
+		nw.BuildContractionHierarchy();
+	});
+
+	idx = 0;
+	Measure("Contraction hierarchy, network-layout.json", 200000, [&]() {
+		const auto& [stationA, stationB] {pairs[idx++ % pairs.size()]};
+		DoNotOptimize(nw.GetFastestTravelTime(stationA, stationB));
+	});
+
+	// Adjacent stations, taken from the first hop of the fastest itineraries.
+	std::vector<std::pair<std::string, std::string>> hops {};
+	NetworkMonitor::ItineraryHandles itinerary {};
+	for (const auto& [stationA, stationB]: pairs) {
+		if (nw.GetFastestPath(stationA, stationB, itinerary)
+			&& itinerary.stations.size() > 1) {
+			hops.emplace_back(
+				nw.GetStationId(itinerary.stations[0]),
+				nw.GetStationId(itinerary.stations[1])
+			);
+		}
+	}
+
+	idx = 0;
+	Measure("Contraction hierarchy update (SetTravelTime)", 2000, [&]() {
+		const auto& [stationA, stationB] {hops[idx++ % hops.size()]};
+		DoNotOptimize(nw.SetTravelTime(stationA, stationB, idx % 7 + 1));
+	});
+}
+
+NETWORK_MONITOR_BENCHMARK(travel_time_matrix)
+{
+	auto nw {LoadNetworkLayout()};
+	const auto pairs {GetStationPairs(nw, 1024)};
+
+	Measure("Travel time matrix build", 20, [&]() {
+		nw.BuildTravelTimeMatrix();
+	});
+
+	size_t idx {0};
+	Measure("Travel time matrix lookup", 1000000, [&]() {
+		const auto& [stationA, stationB] {pairs[idx++ % pairs.size()]};
+		DoNotOptimize(nw.LookupTravelTime(stationA, stationB));
+	});
+}
+
+NETWORK_MONITOR_BENCHMARK(travel_suggestions)
+{
+	auto nw {LoadNetworkLayout()};
+	const auto pairs {GetStationPairs(nw, 1024)};
+	nw.SetLineChangePenalty(5);
+	nw.SetCrowdingCost(0.01);
+
+	std::vector<NetworkMonitor::ItineraryHandles> suggestions {};
+	for (const size_t count: {1, 3, 8}) {
+		size_t idx {0};
+		Measure(
+			"Suggestions, k = " + std::to_string(count),
+			2000,
+			[&]() {
+				const auto& [stationA, stationB] {pairs[idx++ % pairs.size()]};
+				DoNotOptimize(nw.GetTravelSuggestions(
+					stationA,
+					stationB,
+					count,
+					suggestions
+				));
+			}
+		);
+	}
+}
+
+NETWORK_MONITOR_BENCHMARK(passenger_events)
+{
+	using EventType = NetworkMonitor::PassengerEvent::Type;
+
+	auto nw {LoadNetworkLayout()};
+	const auto nStations {static_cast<uint32_t>(nw.GetStationCount())};
+	constexpr size_t nEvents {1 << 20};
+
+	// Record nEvents events split across nThreads threads. With a single
+	// station all threads hit the same counter.
+	auto record {[&nw, nStations](const size_t nThreads, const bool spread) {
+		std::vector<std::thread> threads {};
+		for (size_t thread {0}; thread < nThreads; ++thread) {
+			threads.emplace_back([&nw, nStations, nThreads, spread, thread]() {
+				uint32_t station {static_cast<uint32_t>(thread) % nStations};
+				for (size_t idx {0}; idx < nEvents / nThreads; ++idx) {
+					nw.RecordPassengerEvent(
+						StationHandle {spread ? station : 0},
+						idx % 2 ? EventType::Out : EventType::In
+					);
+					station = station + 1 == nStations ? 0 : station + 1;
+				}
+			});
+		}
+		for (auto& thread: threads) {
+			thread.join();
+		}
+	}};
+
+	for (const size_t nThreads: {1, 2, 4, 8}) {
+		for (const bool spread: {false, true}) {
+			Measure(
+				"1M events, " + std::to_string(nThreads) + " threads, "
+				+ (spread ? "all stations" : "one station"),
+				10,
+				[&]() { record(nThreads, spread); }
+			);
+		}
+	}
+
+	// Same, with the passenger flow statistics. Events have no timestamp, so
+	// each one also reads the clock.
+	nw.EnablePassengerFlows();
+	for (const size_t nThreads: {1, 4}) {
+		Measure(
+			"1M events, " + std::to_string(nThreads) + " threads, with flows",
+			10,
+			[&]() { record(nThreads, true); }
+		);
+	}
+}
+
+NETWORK_MONITOR_BENCHMARK(passenger_event_batches)
+{
+	using NetworkMonitor::PassengerEvent;
+	using EventType = PassengerEvent::Type;
+
+	auto nw {LoadNetworkLayout()};
+
+	// Events spread over random stations, and bursts of events at a few busy
+	// stations.
+	const auto pairs {GetStationPairs(nw, 256)};
+	std::vector<PassengerEvent> spread {};
+	std::vector<PassengerEvent> bursts {};
+	for (const auto& [stationA, stationB]: pairs) {
+		spread.push_back({std::string {nw.GetStationId(stationA)}, EventType::In});
+		spread.push_back({std::string {nw.GetStationId(stationB)}, EventType::Out});
+	}
+	for (size_t idx {0}; idx < spread.size(); ++idx) {
+		bursts.push_back(spread[idx / 32 % 4]);
+	}
+
+	for (const auto& [label, events]: {
+		std::pair {"spread", &spread},
+		std::pair {"bursts", &bursts},
+	}) {
+		Measure(std::string {"512 events, "} + label + ", one by one", 2000, [&]() {
+			for (const auto& event: *events) {
+				DoNotOptimize(nw.RecordPassengerEvent(event));
+			}
+		});
+		Measure(std::string {"512 events, "} + label + ", batch", 2000, [&]() {
+			DoNotOptimize(nw.RecordPassengerEvents(*events));
+		});
+	}
+}
+
+NETWORK_MONITOR_BENCHMARK(network_load)
+{
+	const auto snapshotPath {
+		std::filesystem::temp_directory_path() / "network-monitor-benchmark.bin"
+	};
+	if (!LoadNetworkLayout().SaveSnapshot(snapshotPath)) {
+		throw std::runtime_error("Could not save the snapshot");
+	}
+
+	Measure("Load from JSON file", 20, [&]() {
+		DoNotOptimize(LoadNetworkLayout().GetStationCount());
+	});
+	Measure("Load from JSON file, streaming", 20, [&]() {
+		TransportNetwork nw {};
+		DoNotOptimize(nw.FromJsonFile(BENCHMARKS_NETWORK_LAYOUT_JSON));
+	});
+	Measure("Load from snapshot file", 20, [&]() {
+		TransportNetwork nw {};
+		DoNotOptimize(nw.LoadSnapshot(snapshotPath));
+	});
+	Measure("Map snapshot file", 20, [&]() {
+		NetworkMonitor::MappedTransportNetwork nw {};
+		DoNotOptimize(nw.Open(snapshotPath));
+	});
+
+	// ID lookups, in memory and in the mapping.
+	const auto nw {LoadNetworkLayout()};
+	NetworkMonitor::MappedTransportNetwork mapped {};
+	mapped.Open(snapshotPath);
+	std::vector<std::string> ids {};
+	for (uint32_t idx {0}; idx < nw.GetStationCount(); ++idx) {
+		ids.emplace_back(nw.GetStationId(StationHandle {idx}));
+	}
+	size_t idx {0};
+	Measure("Station lookup, in memory", 1000000, [&]() {
+		DoNotOptimize(nw.GetStationHandle(ids[idx++ % ids.size()]));
+	});
+	Measure("Station lookup, mapped", 1000000, [&]() {
+		DoNotOptimize(mapped.GetStationHandle(ids[idx++ % ids.size()]));
+	});
+	std::filesystem::remove(snapshotPath);
+}
+
+// A grid of about 100k stations: one line per row and per column, each with
+// a route in both directions.
+static NetworkMonitor::NetworkLayout GetGridLayout(
+	const size_t side
+)
+{
+	auto stationId {[side](const size_t row, const size_t column) {
+		return "station_" + std::to_string(row * side + column);
+	}};
+	NetworkMonitor::NetworkLayout layout {};
+	layout.stations.reserve(side * side);
+	for (size_t row {0}; row < side; ++row) {
+		for (size_t column {0}; column < side; ++column) {
+			layout.stations.push_back({stationId(row, column), "Station"});
+		}
+	}
+	for (const bool vertical: {false, true}) {
+		for (size_t line {0}; line < side; ++line) {
+			const auto lineId {
+				std::string {vertical ? "column_" : "row_"} + std::to_string(line)
+			};
+			std::vector<NetworkMonitor::Id> stops {};
+			for (size_t idx {0}; idx < side; ++idx) {
+				stops.push_back(
+					vertical ? stationId(idx, line) : stationId(line, idx)
+				);
+				if (idx > 0) {
+					layout.travelTimes.push_back({
+						stops[idx - 1],
+						stops[idx],
+						static_cast<uint32_t>(1 + (line + idx) % 5)
+					});
+				}
+			}
+			std::vector<NetworkMonitor::Id> reversed {stops.rbegin(), stops.rend()};
+			layout.lines.push_back({lineId, lineId, {
+				{lineId + "_0", "outbound", lineId, stops.front(), stops.back(), stops},
+				{lineId + "_1", "inbound", lineId, reversed.front(), reversed.back(),
+					reversed},
+			}});
+		}
+	}
+	return layout;
+}
+
+NETWORK_MONITOR_BENCHMARK(network_bulk_build)
+{
+	const auto layout {GetGridLayout(316)};
+
+	Measure("Build 100k stations, item by item", 3, [&]() {
+		TransportNetwork nw {};
+		for (const auto& station: layout.stations) {
+			nw.AddStation(station);
+		}
+		for (const auto& line: layout.lines) {
+			nw.AddLine(line);
+		}
+		for (const auto& travelTime: layout.travelTimes) {
+			nw.SetTravelTime(
+				travelTime.startStationId,
+				travelTime.endStationId,
+				travelTime.travelTime
+			);
+		}
+		DoNotOptimize(nw.GetStationCount());
+	});
+	Measure("Build 100k stations, bulk", 3, [&]() {
+		TransportNetwork nw {};
+		std::vector<std::string> errors {};
+		DoNotOptimize(nw.FromLayout(layout, errors));
+	});
+}
+
+NETWORK_MONITOR_BENCHMARK(network_copy)
+{
+	const auto nw {LoadNetworkLayout()};
+	Measure("Clone network layout", 200, [&]() {
+		DoNotOptimize(nw.Clone().GetStationCount());
+	});
+
+	TransportNetwork grid {};
+	std::vector<std::string> errors {};
+	if (!grid.FromLayout(GetGridLayout(316), errors)) {
+		throw std::runtime_error("Could not build the grid network");
+	}
+	Measure("Clone 100k stations", 5, [&]() {
+		DoNotOptimize(grid.Clone().GetStationCount());
+	});
+}
+
+NETWORK_MONITOR_BENCHMARK(closures)
+{
+	auto nw {LoadNetworkLayout()};
+	const auto pairs {GetStationPairs(nw, 1024)};
+	nw.BuildContractionHierarchy();
+
+	// Routes taken from the first hop of the fastest itineraries.
+	std::vector<NetworkMonitor::RouteHandle> routes {};
+	NetworkMonitor::ItineraryHandles itinerary {};
+	for (const auto& [stationA, stationB]: pairs) {
+		if (nw.GetFastestPath(stationA, stationB, itinerary)
+			&& !itinerary.routes.empty()) {
+			routes.push_back(itinerary.routes[0]);
+		}
+	}
+
+	size_t idx {0};
+	Measure("Route closure and reopening, contraction hierarchy", 1000, [&]() {
+		const auto route {routes[idx++ % routes.size()]};
+		nw.DisableRoute(route);
+		nw.EnableRoute(route);
+	});
+
+	nw.BuildTravelTimeMatrix();
+	Measure("Route closure and reopening, travel time matrix", 20, [&]() {
+		const auto route {routes[idx++ % routes.size()]};
+		nw.DisableRoute(route);
+		nw.EnableRoute(route);
+	});
+
+	nw.DisableRoute(routes[0]);
+	nw.DisableStation(pairs[0].first);
+	idx = 0;
+	Measure("Dijkstra with closures, network-layout.json", 20000, [&]() {
+		const auto& [stationA, stationB] {pairs[idx++ % pairs.size()]};
+		DoNotOptimize(nw.GetFastestPath(stationA, stationB, itinerary));
+	});
+}
+
+NETWORK_MONITOR_BENCHMARK(network_patch)
+{
+	const auto src = ParseJsonFile(BENCHMARKS_NETWORK_LAYOUT_JSON);
+
+	// Replace the stops of a route with a shorter list, then put them back.
+	const auto& routeJson {src.at("lines").at(0).at("routes").at(0)};
+	nlohmann::json shortRoute = routeJson;
+	auto& stops {shortRoute.at("route_stops")};
+	stops.erase(stops.begin() + stops.size() / 2, stops.end());
+	auto makePatch {[&src](const nlohmann::json& route) {
+		nlohmann::json travelTimes = nlohmann::json::array();
+		for (const auto& travelTime: src.at("travel_times")) {
+			if (travelTime.at("route_id") == route.at("route_id")) {
+				travelTimes.push_back(travelTime);
+			}
+		}
+		return nlohmann::json {
+			{"remove", {{"routes", {route.at("route_id")}}}},
+			{"add", {{"routes", {route}}}},
+			{"travel_times", travelTimes},
+		};
+	}};
+	const std::vector<nlohmann::json> patches {
+		makePatch(shortRoute),
+		makePatch(routeJson),
+	};
+
+	auto nw {LoadNetworkLayout()};
+	std::vector<std::string> errors {};
+	if (!nw.ApplyPatch(patches[0], errors)) {
+		throw std::runtime_error("Could not apply the patch: " + errors.front());
+	}
+	size_t idx {1};
+	Measure("Route patch, network-layout.json", 1000, [&]() {
+		DoNotOptimize(nw.ApplyPatch(patches[idx++ % 2], errors));
+	});
+
+	nw.BuildContractionHierarchy();
+	Measure("Route patch, contraction hierarchy", 1000, [&]() {
+		DoNotOptimize(nw.ApplyPatch(patches[idx++ % 2], errors));
+	});
+
+	Measure("Reload, network-layout.json", 20, [&]() {
+		TransportNetwork reloaded {};
+		DoNotOptimize(reloaded.FromJsonFile(BENCHMARKS_NETWORK_LAYOUT_JSON));
+	});
+}
@@ -0,0 +1,25 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <string>
+
+// Run all the registered benchmarks, or only the ones whose name contains one
+// of the command line arguments.
+int main(int argc, char* argv[])
+{
+	using NetworkMonitor::Benchmarks::GetBenchmarks;
+
+	for (const auto& benchmark: GetBenchmarks()) {
+		bool selected {argc == 1};
+		for (int idx {1}; idx < argc; ++idx) {
+			selected |= benchmark.name.find(argv[idx]) != std::string::npos;
+		}
+		if (!selected) {
+			continue;
+		}
+
+		std::cout << benchmark.name << std::endl;
+		benchmark.run();
+	}
+	return 0;
+}
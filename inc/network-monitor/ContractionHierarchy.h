@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief Contraction hierarchy over a weighted directed graph.
+ *
+ *  The hierarchy answers point-to-point shortest distance queries with a
+ *  bidirectional Dijkstra search that only ever moves "up" the hierarchy, so it
+ *  settles a small fraction of the nodes a plain Dijkstra search would.
+ *
+ *  Nodes are contracted in minimum-degree order and every fill-in arc is kept
+ *  as a shortcut, regardless of the arc weights. The shape of the hierarchy
+ *  then only depends on the graph topology: changing the weight of an arc only
+ *  requires updating the shortcuts that depend on it, without contracting the
+ *  graph again.
+ *
+ *  Nodes are identified by their index in [0, nNodes).
+ */
+class ContractionHierarchy {
+public:
+    /*! \brief Weight of an arc, or distance between two nodes, that does not
+     *         exist.
+     */
+    static constexpr uint32_t kInfinity {std::numeric_limits<uint32_t>::max()};
+
+    /*! \brief Directed arc of the input graph.
+     */
+    struct Arc {
+        uint32_t from {0};
+        uint32_t to {0};
+        uint32_t weight {0};
+    };
+
+    /*! \brief Default constructor. Corresponds to an empty hierarchy.
+     */
+    ContractionHierarchy();
+
+    /*! \brief Contract a graph.
+     *
+     *  Arcs with an endpoint outside [0, nNodes) are ignored. When there are
+     *  parallel arcs, the lightest one is used.
+     */
+    ContractionHierarchy(
+        const uint32_t nNodes,
+        const std::vector<Arc>& arcs
+    );
+
+    /*! \brief Check if the hierarchy contains any node.
+     */
+    bool Empty() const;
+
+    /*! \brief Get the shortest distance from node `from` to node `to`.
+     *
+     *  \returns kInfinity if `to` cannot be reached from `from`, or if either
+     *           node is not in the hierarchy.
+     */
+    uint32_t GetDistance(
+        const uint32_t from,
+        const uint32_t to
+    ) const;
+
+    /*! \brief Change the weight of an arc of the input graph.
+     *
+     *  Only the shortcuts that depend on the arc are updated.
+     *
+     *  \returns false if the arc endpoints are not adjacent in the hierarchy.
+     *           Arcs between nodes that were not adjacent in the input graph
+     *           can only be added by contracting the graph again.
+     */
+    bool UpdateArc(
+        const Arc& arc
+    );
+
+private:
+    // Each undirected arc of the hierarchy is stored once, with the lower-ranked
+    // node. `m_upWeights[arc]` is the weight from the lower-ranked node to the
+    // higher-ranked one, `m_downWeights[arc]` is the weight in the opposite
+    // direction.
+    std::vector<uint32_t>   m_ranks {};
+    std::vector<uint32_t>   m_order {};
+
+    std::vector<uint32_t>   m_upOffsets {0};
+    std::vector<uint32_t>   m_upTargets {};
+    std::vector<uint32_t>   m_upWeights {};
+    std::vector<uint32_t>   m_downWeights {};
+    std::vector<uint32_t>   m_inputUpWeights {};
+    std::vector<uint32_t>   m_inputDownWeights {};
+
+    // Arcs reaching each node from lower-ranked nodes.
+    std::vector<uint32_t>   m_downOffsets {0};
+    std::vector<uint32_t>   m_downSources {};
+    std::vector<uint32_t>   m_downArcs {};
+
+    uint32_t FindArc(
+        const uint32_t lower,
+        const uint32_t higher
+    ) const;
+
+    void Customize();
+
+    bool RecomputeArc(
+        const uint32_t lower,
+        const uint32_t arc
+    );
+};
+
+} // namespace NetworkMonitor
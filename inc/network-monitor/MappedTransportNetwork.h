@@ -0,0 +1,218 @@
+#pragma once
+
+#include <network-monitor/TransportNetwork.h>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace NetworkMonitor {
+
+/*! \brief Read-only transport network backed by a memory-mapped snapshot file.
+ *
+ *  The network is queried in place from a file written by
+ *  TransportNetwork::SaveSnapshot: IDs are string views into the mapping, the
+ *  ID lookups use the hash tables stored in the file and the graph edges are
+ *  the offset arrays of the file. Opening the network does not allocate or
+ *  parse anything; pages are loaded on first access, and processes that map the
+ *  same file share one physical copy of it.
+ *
+ *  Handles are the same as the handles of the TransportNetwork that saved the
+ *  snapshot. Stations, lines and routes removed from that network are not in
+ *  this one.
+ *
+ *  All queries are const and thread-safe.
+ */
+class MappedTransportNetwork {
+public:
+    /*! \brief A contiguous range of route handles.
+     */
+    struct RouteRange {
+        const RouteHandle* first {nullptr};
+        const RouteHandle* last {nullptr};
+
+        const RouteHandle* begin() const { return first; }
+        const RouteHandle* end() const { return last; }
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+    };
+
+    /*! \brief Default constructor. Corresponds to an empty network.
+     */
+    MappedTransportNetwork();
+
+    /*! \brief Destructor
+     */
+    ~MappedTransportNetwork();
+
+    /*! \brief Move constructor
+     */
+    MappedTransportNetwork(
+        MappedTransportNetwork&& moved
+    );
+
+    /*! \brief Move assignment operator
+     */
+    MappedTransportNetwork& operator=(
+        MappedTransportNetwork&& moved
+    );
+
+    MappedTransportNetwork(const MappedTransportNetwork& copied) = delete;
+    MappedTransportNetwork& operator=(
+        const MappedTransportNetwork& copied
+    ) = delete;
+
+    /*! \brief Map a snapshot file.
+     *
+     *  The file header, the checksum and the structure of the sections are
+     *  verified. The content of the sections is trusted once the checksum
+     *  matches.
+     *
+     *  \returns false if the file could not be mapped or is not a valid
+     *           snapshot. The network is empty in this case.
+     */
+    bool Open(
+        const std::filesystem::path& source
+    );
+
+    /*! \brief Get the number of stations in the network.
+     */
+    size_t GetStationCount() const;
+
+    /*! \brief Resolve a station ID into a handle.
+     *
+     *  \returns An invalid handle if the station is not in the network.
+     */
+    StationHandle GetStationHandle(
+        std::string_view stationId
+    ) const;
+
+    /*! \brief Resolve a line ID into a handle.
+     *
+     *  \returns An invalid handle if the line is not in the network.
+     */
+    LineHandle GetLineHandle(
+        std::string_view lineId
+    ) const;
+
+    /*! \brief Resolve a route ID into a handle.
+     *
+     *  \returns An invalid handle if the route is not in the network, or if it
+     *           does not belong to the line.
+     */
+    RouteHandle GetRouteHandle(
+        const LineHandle line,
+        std::string_view routeId
+    ) const;
+
+    /*! \brief Get the ID of a station.
+     *
+     *  \returns An empty string if the handle is not valid for this network.
+     */
+    std::string_view GetStationId(
+        const StationHandle station
+    ) const;
+
+    /*! \brief Get the name of a station.
+     *
+     *  \returns An empty string if the handle is not valid for this network.
+     */
+    std::string_view GetStationName(
+        const StationHandle station
+    ) const;
+
+    /*! \brief Get the ID of a route.
+     *
+     *  \returns An empty string if the handle is not valid for this network.
+     */
+    std::string_view GetRouteId(
+        const RouteHandle route
+    ) const;
+
+    /*! \brief Get the routes serving a station, departing or terminating.
+     *
+     *  \returns An empty range if the handle is not valid for this network.
+     */
+    RouteRange GetRoutesServingStation(
+        const StationHandle station
+    ) const;
+
+    /*! \brief Get the travel time between 2 adjacent stations.
+     *
+     *  \returns 0 if the stations are not adjacent, or if either handle is not
+     *           valid for this network.
+     */
+    uint32_t GetTravelTime(
+        const StationHandle stationA,
+        const StationHandle stationB
+    ) const;
+
+    /*! \brief Get the total travel time between any 2 stations, on a specific
+     *         route.
+     *
+     *  \returns 0 if station B does not follow station A on the route, or if
+     *           any handle is not valid for this network.
+     */
+    uint32_t GetTravelTime(
+        const RouteHandle route,
+        const StationHandle stationA,
+        const StationHandle stationB
+    ) const;
+
+private:
+    template <typename T>
+    struct Array {
+        const T*    items {nullptr};
+        size_t      size {0};
+    };
+
+    struct IdTable {
+        Array<char>     chars {};
+        Array<uint32_t> offsets {};
+        Array<uint32_t> slots {};
+
+        uint32_t Find(
+            std::string_view id
+        ) const;
+
+        std::string_view Get(
+            const uint32_t index
+        ) const;
+    };
+
+    struct Edge {
+        uint32_t    route {0};
+        uint32_t    line {0};
+        uint32_t    next {0};
+        uint32_t    travelTime {0};
+    };
+
+    boost::interprocess::file_mapping   m_file {};
+    boost::interprocess::mapped_region  m_region {};
+
+    IdTable m_stationIds {};
+    IdTable m_lineIds {};
+    IdTable m_routeIds {};
+
+    Array<char>         m_stationNames {};
+    Array<uint32_t>     m_stationNameOffsets {};
+    Array<RouteHandle>  m_servingRoutes {};
+    Array<uint32_t>     m_servingRouteOffsets {};
+    Array<uint32_t>     m_edgeOffsets {};
+    Array<Edge>         m_edges {};
+    Array<uint32_t>     m_routeLines {};
+    Array<uint32_t>     m_stops {};
+    Array<uint32_t>     m_stopOffsets {};
+    Array<uint32_t>     m_cumulativeTravelTimes {};
+    Array<uint8_t>      m_removedStations {};
+    Array<uint8_t>      m_removedLines {};
+    Array<uint8_t>      m_removedRoutes {};
+
+    void Close();
+};
+
+} // namespace NetworkMonitor
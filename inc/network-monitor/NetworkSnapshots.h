@@ -0,0 +1,158 @@
+#pragma once
+
+#include <network-monitor/TransportNetwork.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace NetworkMonitor {
+
+/*! \brief Immutable snapshots of a TransportNetwork, for lock-free readers.
+ *
+ *  Readers get the current version of the network with Read() and can keep
+ *  using it for as long as they hold the returned Snapshot, even if a newer
+ *  version is published in the meantime. Reading neither takes a lock nor
+ *  touches a shared reference count: each reader announces itself in a reader
+ *  slot of its own.
+ *
+ *  Writers build a new version of the network and publish it with Publish() or
+ *  Update(). Publishing swaps the current version atomically, then waits until
+ *  no reader can still be using the previous version before destroying it.
+ *  Writers are serialized.
+ *
+ *  Snapshots only give const access to the network. The object must outlive
+ *  all its snapshots.
+ */
+class NetworkSnapshots {
+public:
+    /*! \brief Maximum number of snapshots held at the same time.
+     *
+     *  Read() waits for a slot to be released when they are all in use.
+     */
+    static constexpr size_t kMaxReaders {64};
+
+    /*! \brief A version of the network, held by a reader.
+     */
+    class Snapshot {
+    public:
+        /*! \brief Move constructor
+         */
+        Snapshot(
+            Snapshot&& moved
+        );
+
+        /*! \brief Destructor. Releases the version for the writers.
+         */
+        ~Snapshot();
+
+        Snapshot(const Snapshot& copied) = delete;
+        Snapshot& operator=(const Snapshot& copied) = delete;
+        Snapshot& operator=(Snapshot&& moved) = delete;
+
+        const TransportNetwork& operator*() const;
+
+        const TransportNetwork* operator->() const;
+
+    private:
+        friend class NetworkSnapshots;
+
+        Snapshot(
+            std::atomic<uint64_t>* slot,
+            const TransportNetwork* network
+        );
+
+        std::atomic<uint64_t>*  m_slot {nullptr};
+        const TransportNetwork* m_network {nullptr};
+    };
+
+    /*! \brief Default constructor. Publishes an empty network.
+     */
+    NetworkSnapshots();
+
+    /*! \brief Publish an initial version of the network.
+     */
+    explicit NetworkSnapshots(
+        TransportNetwork network
+    );
+
+    /*! \brief Destructor
+     */
+    ~NetworkSnapshots();
+
+    NetworkSnapshots(const NetworkSnapshots& copied) = delete;
+    NetworkSnapshots& operator=(const NetworkSnapshots& copied) = delete;
+
+    /*! \brief Get the current version of the network.
+     *
+     *  Lock-free, unless kMaxReaders snapshots are already held.
+     */
+    Snapshot Read() const;
+
+    /*! \brief Replace the current version of the network.
+     *
+     *  Blocks until the previous version is no longer held by any reader.
+     */
+    void Publish(
+        TransportNetwork network
+    );
+
+    /*! \brief Apply `fn` to a copy of the current version of the network, then
+     *         publish the copy.
+     *
+     *  `fn` takes a TransportNetwork& and returns false to discard the copy.
+     *  Concurrent writers cannot publish between the copy and the publication.
+     *
+     *  \returns The value returned by `fn`.
+     */
+    template <typename Fn>
+    bool Update(
+        Fn&& fn
+    )
+    {
+        std::lock_guard<std::mutex> lock {m_writerMutex};
+        auto network {std::make_unique<TransportNetwork>(
+            *m_current.load(std::memory_order_seq_cst)
+        )};
+        if (!fn(*network)) {
+            return false;
+        }
+        PublishLocked(std::move(network));
+        return true;
+    }
+
+    /*! \brief Get the number of versions published so far, including the
+     *         initial one.
+     */
+    uint64_t GetVersion() const;
+
+private:
+    // A reader slot holds 0 when it is free, kReservedSlot while a reader is
+    // claiming it, and otherwise the epoch at which its reader loaded the
+    // current version. A version replaced at epoch E can be destroyed once no
+    // slot holds an epoch lower than E.
+    static constexpr uint64_t kReservedSlot {
+        std::numeric_limits<uint64_t>::max()
+    };
+
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t>   epoch {0};
+    };
+
+    std::atomic<const TransportNetwork*>    m_current {nullptr};
+    alignas(64) std::atomic<uint64_t>       m_epoch {1};
+    mutable std::array<ReaderSlot, kMaxReaders> m_readers {};
+
+    std::mutex  m_writerMutex {};
+
+    void PublishLocked(
+        std::unique_ptr<TransportNetwork> network
+    );
+};
+
+} // namespace NetworkMonitor
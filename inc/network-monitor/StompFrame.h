@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <map>
 #include <unordered_map>
 #include <ostream>
@@ -31,7 +34,7 @@ enum class StompCommand {
 	kUnknown,
 };
 
-std::string ToString(const StompCommand& command);
+std::string_view ToString(const StompCommand& command);
 
 std::ostream& operator<<(std::ostream& out, const StompCommand& command);
 
@@ -60,7 +63,7 @@ enum class StompHeader {
 	kUnknown,
 };
 
-std::string ToString(const StompHeader& header);
+std::string_view ToString(const StompHeader& header);
 
 std::ostream& operator<<(std::ostream& out, const StompHeader& header);
 
@@ -84,7 +87,7 @@ enum class StompError {
 	kErrorUnknown,
 };
 
-std::string ToString(const StompError& error);
+std::string_view ToString(const StompError& error);
 
 std::ostream& operator<<(std::ostream& out, const StompError& error);
 
@@ -93,6 +96,8 @@ std::ostream& operator<<(std::ostream& out, const StompError& error);
 class StompFrame {
 public:
 
+	/*! \brief Headers of a frame to construct.
+	 */
 	using Headers = std::unordered_map<StompHeader, std::string>;
 
     /*! \brief Default constructor. Corresponds to an empty, invalid STOMP
@@ -163,19 +168,107 @@ public:
 	std::string 		ToString() const;
 
 private:
+    // Header values are indexed by header. Bit N of the mask is set if the
+    // frame has header N.
+    static constexpr size_t kHeaderCount {
+        static_cast<size_t>(StompHeader::kUnknown)
+    };
 
 	StompCommand		m_command = StompCommand::kUnknown;
-	Headers				m_headers {};
+	std::array<std::string, kHeaderCount>	m_headers {};
+	uint32_t			m_headerMask {0};
 	std::string			m_body {};
 
 	StompError	ParseAndValidateFrame(const std::string_view frame);
+};
 
-	StompError 	ValidateFrame(	
-		const StompCommand& command,
-		const Headers& 		headers,
-		const std::string& 	body
-	) const;
-	
+/*! \brief STOMP frame that owns the buffer it was parsed from.
+ *
+ *  Unlike StompFrame, the header values and the body are not copied out of the
+ *  frame: they are views into the buffer, which the frame takes over. Parsing
+ *  a frame does not allocate.
+ *
+ *  The views returned by the getters are valid until the frame is destroyed,
+ *  moved or assigned to.
+ */
+class BufferedStompFrame {
+public:
+    /*! \brief Default constructor. Corresponds to an empty, invalid STOMP
+     *         frame.
+     */
+    BufferedStompFrame();
+
+    /*! \brief Construct the STOMP frame from a string, which is moved into the
+     *         object if it is a valid frame.
+     *
+     *  The result of the operation is stored in the error code. The frame is
+     *  empty if the string is not a valid frame. Frames larger than 4GB are
+     *  rejected with StompError::kErrorBodyLength.
+     */
+    BufferedStompFrame(
+        StompError& ec,
+        std::string&& frame
+    );
+
+    /*! \brief Get STOMP frame command.
+     */
+    StompCommand GetCommand() const;
+
+    /*! \brief Get STOMP frame header value.
+     *
+     *  \returns An empty string if the frame does not have the header.
+     */
+    std::string_view GetHeaderValue(
+        const StompHeader header
+    ) const;
+
+    /*! \brief Get STOMP frame body.
+     */
+    std::string_view GetBody() const;
+
+private:
+    friend class StompParser;
+
+    // Position of a view into m_frame. Offsets, unlike pointers, survive
+    // moving a short string.
+    struct Span {
+        uint32_t    offset {0};
+        uint32_t    length {0};
+    };
+
+    static constexpr size_t kHeaderCount {
+        static_cast<size_t>(StompHeader::kUnknown)
+    };
+
+    using HeaderViews = std::array<std::string_view, kHeaderCount>;
+
+    std::string     m_frame {};
+    StompCommand    m_command {StompCommand::kUnknown};
+    std::array<Span, kHeaderCount>  m_headers {};
+    uint32_t        m_headerMask {0};
+    Span            m_body {};
+
+    // Construct the frame from a string whose body StompParser already found,
+    // followed by a NUL byte. Only the command and the headers are parsed.
+    BufferedStompFrame(
+        StompError& ec,
+        std::string&& frame,
+        const size_t bodyStart,
+        const size_t bodyLength
+    );
+
+    // Take over `frame`, which the views point into.
+    void Assign(
+        std::string&& frame,
+        const StompCommand command,
+        const HeaderViews& headers,
+        const uint32_t headerMask,
+        const std::string_view body
+    );
+
+    std::string_view GetView(
+        const Span span
+    ) const;
 };
 
 } // namespace NetworkMonitor
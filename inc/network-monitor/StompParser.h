@@ -0,0 +1,120 @@
+#pragma once
+
+#include <network-monitor/StompFrame.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace NetworkMonitor {
+
+/*! \brief Incremental parser for a stream of STOMP frames.
+ *
+ *  The stream is pushed in chunks of any size: a chunk can hold several
+ *  frames, the end of a frame, or only a part of one. The parser keeps the
+ *  incomplete frame across calls and passes each complete frame to the frame
+ *  handler as soon as its last byte is pushed. Bytes already scanned are not
+ *  scanned again when the rest of the frame arrives.
+ *
+ *  End-of-line heart-beats between frames are skipped. The body of a frame
+ *  with a content-length header ends after content-length bytes, even if they
+ *  include NUL bytes. Otherwise it ends at the first NUL byte.
+ *
+ *  Frames are only buffered while incomplete: frames that are whole in a chunk
+ *  are parsed from the chunk directly.
+ *
+ *  Invalid frames are reported to the frame handler. If the byte after a body
+ *  of content-length bytes is not NUL, or if a frame grows larger than the
+ *  maximum frame size, the parser drops the bytes up to the next NUL byte and
+ *  resumes after it.
+ */
+class StompParser {
+public:
+    /*! \brief Called for each complete frame, with the result of parsing it.
+     *
+     *  The frame is an rvalue reference; ownership is passed to the receiver.
+     *  It is empty if the error code is not StompError::kOk. Parsing resumes
+     *  after the end of an invalid frame.
+     *
+     *  The handler must not push to the parser that calls it.
+     */
+    using FrameHandler = std::function<void (StompError, BufferedStompFrame&&)>;
+
+    /*! \brief Default maximum size of a frame, in bytes.
+     */
+    static constexpr size_t kDefaultMaxFrameSize {16 * 1024 * 1024};
+
+    /*! \brief Construct a parser that passes the frames to `onFrame`.
+     *
+     *  Frames larger than `maxFrameSize` bytes are not buffered: they are
+     *  reported with StompError::kErrorBodyLength and dropped.
+     */
+    explicit StompParser(
+        FrameHandler onFrame,
+        const size_t maxFrameSize = kDefaultMaxFrameSize
+    );
+
+    /*! \brief Parse the next chunk of the stream.
+     *
+     *  The frame handler is called for each frame that the chunk completes,
+     *  in order, before this function returns.
+     */
+    void Push(
+        std::string_view chunk
+    );
+
+    /*! \brief Drop the incomplete frame, if any, and start over with a new
+     *         stream.
+     */
+    void Reset();
+
+    /*! \brief Get the number of bytes of the incomplete frame buffered so far.
+     */
+    size_t GetBufferedSize() const;
+
+private:
+    enum class State {
+        kBetweenFrames,
+        kHeaders,
+        kBody,
+        // Dropping the bytes of an invalid frame, up to the next NUL byte.
+        kSkipping,
+    };
+
+    FrameHandler    m_onFrame {};
+    size_t          m_maxFrameSize {kDefaultMaxFrameSize};
+
+    // The incomplete frame. Offsets are relative to its first byte.
+    std::string     m_buffer {};
+    State           m_state {State::kBetweenFrames};
+    size_t          m_scanned {0};
+    size_t          m_lineStart {0};
+    size_t          m_bodyStart {0};
+
+    // Only the first content-length header counts. The body ends at the first
+    // NUL byte if its value is not a valid length.
+    bool            m_hasContentLength {false};
+    bool            m_isValidContentLength {false};
+    size_t          m_contentLength {0};
+
+    // Parse the frames of `data`, which starts with the incomplete frame.
+    // Returns the offset of the frame left incomplete, or the size of `data`.
+    size_t Parse(
+        std::string_view data
+    );
+
+    // The body starts at `bodyStart`, relative to the start of the frame, and
+    // ends before the NUL byte that ends the frame.
+    void OnFrame(
+        std::string&& frame,
+        const size_t bodyStart
+    );
+
+    // Report an invalid frame, whose bytes are dropped.
+    void OnError(
+        const StompError error
+    );
+};
+
+} // namespace NetworkMonitor
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <network-monitor/ContractionHierarchy.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <limits>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
-#include <unordered_map>
 
 #include <nlohmann/json.hpp>
 
@@ -80,6 +89,22 @@ struct Line {
     bool operator==(const Line& other) const;
 };
 
+/*! \brief Travel time between 2 adjacent stations
+ */
+struct TravelTime {
+    Id startStationId {};
+    Id endStationId {};
+    uint32_t travelTime {0};
+};
+
+/*! \brief Complete layout of a network, for bulk construction
+ */
+struct NetworkLayout {
+    std::vector<Station> stations {};
+    std::vector<Line> lines {};
+    std::vector<TravelTime> travelTimes {};
+};
+
 /*! \brief Passenger event
  */
 struct PassengerEvent {
@@ -90,6 +115,88 @@ struct PassengerEvent {
 
     Id stationId;
     Type type;
+
+    // Only used for the passenger flow statistics. A default-constructed
+    // timestamp stands for the time at which the event is recorded.
+    std::chrono::system_clock::time_point timestamp {};
+};
+
+/*! \brief Number of passengers entering and exiting a station.
+ */
+struct PassengerFlow {
+    uint64_t in {0};
+    uint64_t out {0};
+};
+
+/*! \brief Rate of passengers entering and exiting a station, in passengers
+ *         per minute.
+ */
+struct PassengerFlowRate {
+    double in {0.0};
+    double out {0.0};
+};
+
+/*! \brief Handle to a station, line or route of a TransportNetwork.
+ *
+ *  A handle is resolved once from an ID and can then be used to query the
+ *  network without hashing the ID again. A handle is only meaningful for the
+ *  network that returned it.
+ *
+ *  A default-constructed handle is invalid.
+ */
+template <typename Tag>
+struct NetworkHandle {
+    uint32_t index {std::numeric_limits<uint32_t>::max()};
+
+    bool IsValid() const
+    {
+        return index != std::numeric_limits<uint32_t>::max();
+    }
+
+    bool operator==(const NetworkHandle& other) const
+    {
+        return index == other.index;
+    }
+
+    bool operator!=(const NetworkHandle& other) const
+    {
+        return index != other.index;
+    }
+};
+
+using StationHandle = NetworkHandle<struct StationHandleTag>;
+using LineHandle = NetworkHandle<struct LineHandleTag>;
+using RouteHandle = NetworkHandle<struct RouteHandleTag>;
+
+/*! \brief Itinerary between two stations.
+ *
+ *  `stations` lists all the stations visited, including the start and end
+ *  stations. `routes[idx]` is the route taken from `stations[idx]` to
+ *  `stations[idx + 1]`.
+ *
+ *  `totalTime` is the sum of the travel times between all stations, plus the
+ *  line change penalty for each change of line.
+ *
+ *  `crowdingCost` is the cost of the crowding at the stations visited, as
+ *  computed by TransportNetwork::GetTravelSuggestions. It is 0 for the
+ *  itineraries returned by TransportNetwork::GetFastestPath.
+ */
+struct Itinerary {
+    std::vector<Id> stations {};
+    std::vector<Id> routes {};
+    uint32_t totalTime {0};
+    uint32_t crowdingCost {0};
+};
+
+/*! \brief Itinerary between two stations, using handles.
+ *
+ *  Same as Itinerary, with handles instead of IDs.
+ */
+struct ItineraryHandles {
+    std::vector<StationHandle> stations {};
+    std::vector<RouteHandle> routes {};
+    uint32_t totalTime {0};
+    uint32_t crowdingCost {0};
 };
 
 /*! \brief Underground network representation
@@ -128,6 +235,18 @@ public:
         TransportNetwork&& moved
     );
 
+    /*! \brief Get an independent copy of the network.
+     *
+     *  The copy shares no state with this network: layout, travel times,
+     *  passenger counts and flows, settings and cached travel times are all
+     *  copied. Networks are stored as a few contiguous arrays, so cloning
+     *  costs a handful of block copies plus one allocation per station and per
+     *  line. This is the same as the copy constructor.
+     *
+     *  Not thread-safe with concurrent writers.
+     */
+    TransportNetwork Clone() const;
+
     /*! \brief Populate the network from a JSON object.
      *
      *  \param src Ownership of the source JSON object is moved to this method.
@@ -145,6 +264,129 @@ public:
         nlohmann::json&& src
     );
 
+    /*! \brief Populate the network from a JSON stream.
+     *
+     *  Same as FromJson, but the network is built as the JSON document is
+     *  parsed, without first building a JSON object for the whole document.
+     *  The sections of the document can come in any order; lines and travel
+     *  times that come before the stations they refer to are kept until the
+     *  stations are added.
+     *
+     *  \returns false if stations and lines where parsed successfully, but not
+     *           the travel times.
+     *
+     *  \throws std::runtime_error This method throws if the JSON document is
+     *                             malformed, if an item misses a field, or if
+     *                             there was an issue adding new stations or
+     *                             lines to the network.
+     */
+    bool FromJsonStream(
+        std::istream& src
+    );
+
+    /*! \brief Populate the network from a JSON file.
+     *
+     *  See FromJsonStream.
+     *
+     *  \throws std::runtime_error This method also throws if the file cannot
+     *                             be opened.
+     */
+    bool FromJsonFile(
+        const std::filesystem::path& source
+    );
+
+    /*! \brief Build the network from a complete layout in one go.
+     *
+     *  Faster than adding stations, lines and travel times one by one: routes
+     *  are validated in parallel, all containers are sized up front and the
+     *  graph is linked in a single pass. Travel times are checked for
+     *  adjacency once all stations and lines are valid.
+     *
+     *  The network must be empty. The layout is either built completely or not
+     *  at all.
+     *
+     *  \param errors Set to one message per validation error, in layout order.
+     *
+     *  \returns false if the layout is not valid or the network is not empty.
+     *           The network is left unchanged in this case.
+     */
+    bool FromLayout(
+        const NetworkLayout& layout,
+        std::vector<std::string>& errors
+    );
+
+    /*! \brief Apply a set of layout changes to the network, in place.
+     *
+     *  The patch is a JSON object with these optional items, applied in this
+     *  order:
+     *  - "remove": an object with "stations", "lines" and "routes" arrays of
+     *    IDs. Removing a line removes its routes. A station can only be
+     *    removed if the patch also removes all the routes serving it.
+     *  - "add": an object with "stations", "lines" and "routes" arrays, in the
+     *    same format as FromJson. Added routes join the line of their
+     *    "line_id", which must exist once the lines are added.
+     *  - "travel_times": an array of travel times, in the same format as
+     *    FromJson.
+     *
+     *  All routes between the same two stations share one travel time. The
+     *  travel times of the added routes default to those already between
+     *  their stations, including those of the routes the patch removes. A
+     *  patch that adds a route between stations with no travel time yet must
+     *  set it.
+     *
+     *  A route is modified by removing it and adding it again in the same
+     *  patch. Removed stations, lines and routes no longer resolve from their
+     *  ID, and their handle is reused if an item with the same ID is added
+     *  again.
+     *
+     *  Only the affected edges are updated, so the cost of a patch is
+     *  proportional to its size. The contraction hierarchy and the travel time
+     *  matrix are updated in place. A patch that adds new stations discards
+     *  both. A patch that links stations that were not adjacent discards the
+     *  contraction hierarchy only: the matrix is still updated in place.
+     *
+     *  The patch is validated completely before any change is made.
+     *
+     *  \param errors Set to one message per validation error.
+     *
+     *  \returns false if the patch is not valid. The network is left unchanged
+     *           in this case.
+     *
+     *  \throws nlohmann::json::exception If an item of the patch is missing a
+     *                                    field or has the wrong type.
+     */
+    bool ApplyPatch(
+        const nlohmann::json& patch,
+        std::vector<std::string>& errors
+    );
+
+    /*! \brief Save the network layout to a binary snapshot file.
+     *
+     *  The snapshot holds the stations, lines, routes and travel times, in the
+     *  layout the network uses in memory. Passenger counts and flows, query
+     *  settings and precomputed query structures are not saved.
+     *
+     *  Snapshots can only be loaded on machines with the same byte order.
+     *
+     *  \returns false if the file could not be written.
+     */
+    bool SaveSnapshot(
+        const std::filesystem::path& destination
+    ) const;
+
+    /*! \brief Replace the network with the content of a binary snapshot file.
+     *
+     *  Loading mostly copies arrays from the file, without parsing or
+     *  validating items one by one. The file is checked for its format
+     *  version and checksum, and for indices that would be out of bounds.
+     *
+     *  \returns false if the file could not be read or is not a valid snapshot.
+     *           The network is left unchanged in this case.
+     */
+    bool LoadSnapshot(
+        const std::filesystem::path& source
+    );
+
     /*! \brief Add a station to the network.
      *
      *  \returns false if there was an error while adding the station to the
@@ -166,13 +408,17 @@ public:
      *  This function assumes that the Line object is well-formed.
      *
      *  All stations served by this line must already be in the network. The
-     *  line cannot already be in the network.
+     *  line and its routes cannot already be in the network.
      */
     bool AddLine(
         const Line& line
     );
 
     /*! \brief Record a passenger event at a station.
+     *
+     *  Passenger events can be recorded from several threads at once, and
+     *  concurrently with GetPassengerCount. They must not run concurrently
+     *  with changes to the network layout.
      *
      *  \returns false if the station is not in the network or if the passenger
      *           event is not reconized.
@@ -181,6 +427,19 @@ public:
         const PassengerEvent& event
     );
 
+    /*! \brief Record a batch of passenger events.
+     *
+     *  Events are grouped by station and each station count is updated once
+     *  with the net change, so the batch is not applied atomically as a whole.
+     *  Thread-safe, like RecordPassengerEvent.
+     *
+     *  \returns The positions in `events` of the events that could not be
+     *           recorded, in increasing order. The other events are recorded.
+     */
+    std::vector<size_t> RecordPassengerEvents(
+        const std::vector<PassengerEvent>& events
+    );
+
     /*! \brief Get the number of passengers currently recorded at a station.
      *
      *  The returned number can be negative: This happens if we start recording
@@ -257,59 +516,843 @@ public:
         const Id& stationIdB
     ) const;
 
+    /*! \brief Resolve a station ID into a handle.
+     *
+     *  \returns An invalid handle if the station is not in the network.
+     */
+    StationHandle GetStationHandle(
+        const Id& stationId
+    ) const;
+
+    /*! \brief Resolve a line ID into a handle.
+     *
+     *  \returns An invalid handle if the line is not in the network.
+     */
+    LineHandle GetLineHandle(
+        const Id& lineId
+    ) const;
+
+    /*! \brief Resolve a route ID into a handle.
+     *
+     *  \returns An invalid handle if the route is not in the network, or if it
+     *           does not belong to the `lineId` line.
+     */
+    RouteHandle GetRouteHandle(
+        const Id& lineId,
+        const Id& routeId
+    ) const;
+
+    /*! \brief Get the ID of a station from its handle.
+     *
+     *  \returns An empty string if the handle is not valid for this network.
+     */
+    std::string_view GetStationId(
+        const StationHandle station
+    ) const;
+
+    /*! \brief Get the ID of a line from its handle.
+     *
+     *  \returns An empty string if the handle is not valid for this network.
+     */
+    std::string_view GetLineId(
+        const LineHandle line
+    ) const;
+
+    /*! \brief Get the ID of a route from its handle.
+     *
+     *  \returns An empty string if the handle is not valid for this network.
+     */
+    std::string_view GetRouteId(
+        const RouteHandle route
+    ) const;
+
+    /*! \brief Record a passenger event at a station.
+     *
+     *  Thread-safe, like RecordPassengerEvent(const PassengerEvent&). The
+     *  timestamp has the same meaning as PassengerEvent::timestamp.
+     *
+     *  \returns false if the handle is not valid for this network or if the
+     *           passenger event is not reconized.
+     */
+    bool RecordPassengerEvent(
+        const StationHandle station,
+        const PassengerEvent::Type type,
+        const std::chrono::system_clock::time_point timestamp = {}
+    );
+
+    /*! \brief Get the number of passengers currently recorded at a station.
+     *
+     *  \throws std::runtime_error if the handle is not valid for this network.
+     */
+    int64_t GetPassengerCount(
+        const StationHandle station
+    ) const;
+
+    /*! \brief Start recording passenger flows at all stations.
+     *
+     *  Each station keeps the number of entering and exiting passengers in
+     *  `nBuckets` buckets of `bucketWidth`, indexed by event timestamp. The
+     *  buckets form a ring: once a bucket is reused for a later time, the
+     *  earlier counts are lost. The default covers 24 hours in 1-minute
+     *  buckets, for 23KB per station.
+     *
+     *  Enabling the statistics again with a different configuration discards
+     *  the recorded flows. Not thread-safe.
+     *
+     *  \returns false if `bucketWidth` or `nBuckets` is 0.
+     */
+    bool EnablePassengerFlows(
+        const std::chrono::seconds bucketWidth = std::chrono::minutes {1},
+        const size_t nBuckets = 24 * 60
+    );
+
+    /*! \brief Check whether passenger flows are being recorded.
+     */
+    bool HasPassengerFlows() const;
+
+    /*! \brief Get the passenger flow at a station in [from, to).
+     *
+     *  The window is widened to whole buckets. Buckets that are no longer in
+     *  the ring count as empty.
+     *
+     *  \returns An empty flow if the handle is not valid for this network or
+     *           if passenger flows are not being recorded.
+     */
+    PassengerFlow GetPassengerFlow(
+        const StationHandle station,
+        const std::chrono::system_clock::time_point from,
+        const std::chrono::system_clock::time_point to
+    ) const;
+
+    /*! \brief Get the moving average of the passenger flow rate at a station.
+     *
+     *  Returns one rate per bucket in [from, to): the average rate over the
+     *  `window` ending with that bucket. `window` is rounded up to whole
+     *  buckets.
+     *
+     *  \returns An empty vector if the handle is not valid for this network, if
+     *           passenger flows are not being recorded, or if [from, to) spans
+     *           more buckets than the ring holds.
+     */
+    std::vector<PassengerFlowRate> GetPassengerFlowRates(
+        const StationHandle station,
+        const std::chrono::system_clock::time_point from,
+        const std::chrono::system_clock::time_point to,
+        const std::chrono::seconds window
+    ) const;
+
+    /*! \brief Get list of routes serving a given station.
+     *
+     *  Both the routes leaving from and the routes terminating at the station
+     *  are included. The list is maintained as lines are added, so this call
+     *  does not allocate.
+     *
+     *  \returns An empty vector if the handle is not valid for this network, or
+     *           if the station has legitimately no routes serving it.
+     */
+    const std::vector<RouteHandle>& GetRoutesServingStation(
+        const StationHandle station
+    ) const;
+
+    /*! \brief Get the travel time between 2 adjacent stations.
+     *
+     *  \returns 0 if the function could not find the travel time between the
+     *           two stations, or if station A and B are the same station.
+     */
+    uint32_t GetTravelTime(
+        const StationHandle stationA,
+        const StationHandle stationB
+    ) const;
+
+    /*! \brief Get the total travel time between any 2 stations, on a specific
+     *         route.
+     *
+     *  \returns 0 if the function could not find the travel time between the
+     *           two stations, or if station A and B are the same station.
+     */
+    uint32_t GetTravelTime(
+        const RouteHandle route,
+        const StationHandle stationA,
+        const StationHandle stationB
+    ) const;
+
+    /*! \brief Set the time cost of changing line during a journey.
+     *
+     *  The penalty is added to the itinerary travel time every time a journey
+     *  continues on a different line. It defaults to 0.
+     */
+    void SetLineChangePenalty(
+        const uint32_t penalty
+    );
+
+    /*! \brief Get the time cost of changing line during a journey.
+     */
+    uint32_t GetLineChangePenalty() const;
+
+    /*! \brief Get the fastest itinerary between 2 stations.
+     *
+     *  The itinerary minimizes the total travel time, including the line change
+     *  penalty.
+     *
+     *  \returns An itinerary with no stations if the two stations are not in
+     *           the network, or if there is no itinerary between them.
+     */
+    Itinerary GetFastestPath(
+        const Id& stationIdA,
+        const Id& stationIdB
+    ) const;
+
+    /*! \brief Get the fastest itinerary between 2 stations.
+     *
+     *  The vectors in `itinerary` are reused, so repeated queries with the
+     *  same output object do not allocate.
+     *
+     *  \returns false if the handles are not valid for this network, or if
+     *           there is no itinerary between the two stations.
+     */
+    bool GetFastestPath(
+        const StationHandle stationA,
+        const StationHandle stationB,
+        ItineraryHandles& itinerary
+    ) const;
+
+    /*! \brief Maximum number of itineraries returned by GetTravelSuggestions.
+     */
+    static constexpr size_t kMaxTravelSuggestions {16};
+
+    /*! \brief Set the cost of crowding at a station, per passenger.
+     *
+     *  Travel suggestions add `costPerPassenger` times the number of passengers
+     *  currently recorded at each station they go through, start station
+     *  excluded, to the itinerary travel time. Stations with a negative
+     *  passenger count have no crowding cost. It defaults to 0.
+     */
+    void SetCrowdingCost(
+        const double costPerPassenger
+    );
+
+    /*! \brief Get the cost of crowding at a station, per passenger.
+     */
+    double GetCrowdingCost() const;
+
+    /*! \brief Get the best itineraries between 2 stations, taking crowding into
+     *         account.
+     *
+     *  Itineraries are ranked by total time plus crowding cost, best first, and
+     *  do not visit any station twice. At most `count` itineraries are
+     *  returned, and never more than kMaxTravelSuggestions.
+     *
+     *  \returns An empty vector if the two stations are not in the network, or
+     *           if there is no itinerary between them.
+     */
+    std::vector<Itinerary> GetTravelSuggestions(
+        const Id& stationIdA,
+        const Id& stationIdB,
+        const size_t count
+    ) const;
+
+    /*! \brief Get the best itineraries between 2 stations, taking crowding into
+     *         account.
+     *
+     *  The first N entries of `suggestions` are filled in, where N is the
+     *  returned value. `suggestions` is grown if needed but never shrunk, so
+     *  that repeated queries with the same output vector do not allocate once
+     *  it has been through a query with as many results.
+     *
+     *  The itineraries are found with Yen's algorithm: a query runs one
+     *  fastest-path search per stop of each itinerary it returns.
+     *
+     *  \returns The number of itineraries found.
+     */
+    size_t GetTravelSuggestions(
+        const StationHandle stationA,
+        const StationHandle stationB,
+        const size_t count,
+        std::vector<ItineraryHandles>& suggestions
+    ) const;
+
+    /*! \brief Travel time returned for stations that cannot be reached.
+     */
+    static constexpr uint32_t kUnreachable {
+        std::numeric_limits<uint32_t>::max()
+    };
+
+    /*! \brief Preprocess the network to speed up GetFastestTravelTime.
+     *
+     *  Builds a contraction hierarchy of the network. The hierarchy is kept up
+     *  to date by SetTravelTime, but it is discarded when stations or lines are
+     *  added to the network: call this method again after changing the network
+     *  layout.
+     */
+    void BuildContractionHierarchy();
+
+    /*! \brief Check if the network has an up-to-date contraction hierarchy.
+     */
+    bool HasContractionHierarchy() const;
+
+    /*! \brief Get the travel time of the fastest itinerary between 2
+     *         stations.
+     *
+     *  The line change penalty is not included: the result is the travel time
+     *  of GetFastestPath with no line change penalty.
+     *
+     *  This query uses the contraction hierarchy if there is one, and falls
+     *  back to GetFastestPath otherwise.
+     *
+     *  \returns kUnreachable if the two stations are not in the network, or if
+     *           there is no itinerary between them.
+     */
+    uint32_t GetFastestTravelTime(
+        const Id& stationIdA,
+        const Id& stationIdB
+    ) const;
+
+    /*! \brief Get the travel time of the fastest itinerary between 2
+     *         stations.
+     *
+     *  \returns kUnreachable if the handles are not valid for this network, or
+     *           if there is no itinerary between the two stations.
+     */
+    uint32_t GetFastestTravelTime(
+        const StationHandle stationA,
+        const StationHandle stationB
+    ) const;
+
+    /*! \brief Get the number of stations in the network.
+     *
+     *  Station handles are numbered from 0 to GetStationCount() - 1.
+     */
+    uint32_t GetStationCount() const;
+
+    /*! \brief Compute the travel time between every pair of stations.
+     *
+     *  The result is stored in a dense matrix of GetStationCount()^2 entries,
+     *  computed in parallel on all available cores. Rows affected by
+     *  SetTravelTime are recomputed when the travel time changes. The matrix is
+     *  discarded when stations or lines are added to the network: call this
+     *  method again after changing the network layout.
+     *
+     *  Travel times are computed as in GetFastestTravelTime.
+     */
+    void BuildTravelTimeMatrix();
+
+    /*! \brief Check if the network has an up-to-date travel time matrix.
+     */
+    bool HasTravelTimeMatrix() const;
+
+    /*! \brief Look up the travel time between 2 stations in the travel time
+     *         matrix.
+     *
+     *  This is a single read from the matrix: the handles must be valid for
+     *  this network and the matrix must have been built with
+     *  BuildTravelTimeMatrix. No checks are performed.
+     *
+     *  \returns kUnreachable if there is no itinerary between the two
+     *           stations.
+     */
+    uint32_t LookupTravelTime(
+        const StationHandle stationA,
+        const StationHandle stationB
+    ) const;
+
+    /*! \brief Take a route out of service.
+     *
+     *  Travel time and path queries ignore the edges of a route that is out of
+     *  service. The network layout is unchanged: the route is still listed by
+     *  GetRoutesServingStation. The contraction hierarchy and the travel time
+     *  matrix are updated, if any.
+     *
+     *  Out-of-service state is not saved in snapshots.
+     *
+     *  \returns false if the handle is not valid for this network.
+     */
+    bool DisableRoute(
+        const RouteHandle route
+    );
+
+    /*! \brief Put a route back in service.
+     *
+     *  \returns false if the handle is not valid for this network.
+     */
+    bool EnableRoute(
+        const RouteHandle route
+    );
+
+    /*! \brief Take a station out of service.
+     *
+     *  Travel time and path queries ignore the edges leaving or reaching a
+     *  station that is out of service, so itineraries can neither stop at nor
+     *  go through it.
+     *
+     *  \returns false if the handle is not valid for this network.
+     */
+    bool DisableStation(
+        const StationHandle station
+    );
+
+    /*! \brief Put a station back in service.
+     *
+     *  \returns false if the handle is not valid for this network.
+     */
+    bool EnableStation(
+        const StationHandle station
+    );
+
+    /*! \brief Take the track between 2 adjacent stations out of service, in
+     *         both directions and for all routes.
+     *
+     *  \returns false if the handles are not valid for this network, or if the
+     *           stations are not adjacent.
+     */
+    bool DisableEdge(
+        const StationHandle stationA,
+        const StationHandle stationB
+    );
+
+    /*! \brief Put the track between 2 adjacent stations back in service.
+     *
+     *  Edges that are also out of service because of their route or one of
+     *  their stations stay out of service.
+     *
+     *  \returns false if the handles are not valid for this network, or if the
+     *           stations are not adjacent.
+     */
+    bool EnableEdge(
+        const StationHandle stationA,
+        const StationHandle stationB
+    );
+
 private:
 
-	struct GraphNode;
-	struct GraphEdge;
-	struct LineInternal;
-	struct RouteInternal;
+	// Internally, stations, lines and routes are identified by their position
+	// in the contiguous arrays below. The network is stored as a compressed
+	// sparse row (CSR) graph: the outgoing edges of station `idx` are
+	// `m_edges[m_edgeOffsets[idx]]` to `m_edges[m_edgeOffsets[idx + 1] - 1]`.
+
+	static constexpr uint32_t kInvalidIndex {
+		std::numeric_limits<uint32_t>::max()
+	};
+
+	// String-interning table for station, line and route IDs.
+	// All IDs are stored back to back in a single character buffer and
+	// indexed by an open-addressing hash table, so that each ID is hashed once
+	// when it is resolved into an index.
+	class IdTable {
+	public:
+		uint32_t Find(
+			std::string_view id
+		) const;
+
+		uint32_t Insert(
+			std::string_view id
+		);
+
+		std::string_view Get(
+			const uint32_t index
+		) const;
+
+		uint32_t Size() const;
+
+		void Reserve(
+			const size_t nIds
+		);
+
+	private:
+		friend class TransportNetwork;
+
+		std::string				m_chars {};
+		std::vector<uint32_t>	m_offsets {0};
+		std::vector<uint32_t>	m_slots {};
+
+		void Rehash(
+			const size_t nSlots
+		);
+
+		// Stable across platforms and builds, since the slots are saved in
+		// snapshots.
+		static size_t Hash(
+			std::string_view id
+		);
+
+		bool IsValid() const;
+	};
+
+	// Names of stations, lines or routes in a single character buffer: name
+	// `idx` is chars[ranges[idx].first, ranges[idx].second). Renaming an item
+	// appends its new name to the buffer.
+	struct NameTable {
+		std::string	chars {};
+		std::vector<std::pair<uint32_t, uint32_t>>	ranges {};
+
+		void Append(
+			std::string_view name
+		);
 
-    struct GraphNode {
-		Id 			id {};
-		std::string	name {};
-		uint64_t				passengerCount {0};
-		std::vector<GraphEdge>	edges {};
+		void Set(
+			const uint32_t index,
+			std::string_view name
+		);
+
+		std::string_view Get(
+			const uint32_t index
+		) const;
+
+		uint32_t Size() const;
+	};
+
+	struct GraphNode {
+		std::vector<RouteHandle>	servingRoutes {};
+	};
+
+	// Each counter sits on its own cache line, so that threads recording
+	// events at different stations do not contend. Copies are only made when
+	// the network itself is copied or grown, never concurrently with writers.
+	struct alignas(64) PassengerCounter {
+		std::atomic<int64_t>	count {0};
+
+		PassengerCounter() = default;
+
+		PassengerCounter(
+			const PassengerCounter& other
+		) : count {other.count.load(std::memory_order_relaxed)}
+		{
+		}
+
+		PassengerCounter& operator=(
+			const PassengerCounter& other
+		)
+		{
+			count.store(
+				other.count.load(std::memory_order_relaxed),
+				std::memory_order_relaxed
+			);
+			return *this;
+		}
+	};
+
+	struct FlowBucket {
+		std::atomic<uint64_t>	in {0};
+		std::atomic<uint64_t>	out {0};
+
+		FlowBucket() = default;
+
+		FlowBucket(
+			const FlowBucket& other
+		) : in {other.in.load(std::memory_order_relaxed)},
+			out {other.out.load(std::memory_order_relaxed)}
+		{
+		}
+
+		FlowBucket& operator=(
+			const FlowBucket& other
+		)
+		{
+			in.store(
+				other.in.load(std::memory_order_relaxed),
+				std::memory_order_relaxed
+			);
+			out.store(
+				other.out.load(std::memory_order_relaxed),
+				std::memory_order_relaxed
+			);
+			return *this;
+		}
 	};
 
+	// A default-constructed edge is a free slot, left behind by a removed
+	// route. Free slots are always closed, and they are reused by new edges
+	// leaving the same station.
 	struct GraphEdge {
-		std::shared_ptr<RouteInternal>	route;
-		std::shared_ptr<GraphNode>		next {nullptr};
-		uint32_t						travelTime {0};
+		uint32_t	route {kInvalidIndex};
+		uint32_t	line {kInvalidIndex};
+		uint32_t	next {kInvalidIndex};
+		uint32_t	travelTime {0};
+	};
+
+	// A change to the travel time of an edge, kUnreachable meaning that the
+	// edge does not exist or is closed.
+	struct EdgeChange {
+		uint32_t	from {kInvalidIndex};
+		uint32_t	next {kInvalidIndex};
+		uint32_t	oldTravelTime {kUnreachable};
+		uint32_t	newTravelTime {kUnreachable};
 	};
 
 	struct LineInternal {
-		Id 			id {};
-		std::string	name {};
-		std::unordered_map<Id, std::shared_ptr<RouteInternal>> routes {};
+		std::vector<uint32_t>	routes {};
 	};
 
+	// The stops of a route are the slice [firstStop, firstStop + nStops) of
+	// the route arrays below.
 	struct RouteInternal {
-		Id 			id;
-		std::string name;
-		std::shared_ptr<LineInternal>			line {nullptr};
-		std::vector<std::shared_ptr<GraphNode>>	stops {};
+		uint32_t	line {kInvalidIndex};
+		uint32_t	firstStop {0};
+		uint32_t	nStops {0};
+	};
+
+	struct EdgeRange {
+		const GraphEdge* first {nullptr};
+		const GraphEdge* last {nullptr};
+
+		const GraphEdge* begin() const { return first; }
+		const GraphEdge* end() const { return last; }
 	};
 
-	std::unordered_map<Id, std::shared_ptr<GraphNode>>		m_stations {};
-	std::unordered_map<Id, std::shared_ptr<LineInternal>>	m_lines {};
+	uint32_t	m_lineChangePenalty {0};
+	double		m_crowdingCost {0.0};
+
+	ContractionHierarchy	m_hierarchy {};
+
+	// Row-major, m_stations.size() x m_stations.size().
+	std::vector<uint32_t>	m_travelTimeMatrix {};
+
+	std::vector<GraphNode>		m_stations {};
+	std::vector<PassengerCounter>	m_passengerCounts {};
+
+	// Passenger flows, m_stations.size() x m_flowBucketCount buckets. The
+	// bucket for time t is t / m_flowBucketWidth, and it lives in slot
+	// bucket % m_flowBucketCount. Each word packs the bucket number in its
+	// upper 32 bits and the count in its lower 32 bits, so that a slot can be
+	// reused for a later bucket with a single compare-and-swap.
+	std::chrono::seconds	m_flowBucketWidth {0};
+	size_t					m_flowBucketCount {0};
+	std::vector<FlowBucket>	m_flowBuckets {};
+	std::vector<uint32_t>		m_edgeOffsets {0};
+	std::vector<GraphEdge>		m_edges {};
+	std::vector<LineInternal>	m_lines {};
+	std::vector<RouteInternal>	m_routes {};
+
+	// Arenas for the stops of all the routes, back to back in route order.
+	// Along with its stops, each route keeps the cumulative travel time from
+	// its first stop to each stop, and its (station, position) pairs sorted by
+	// station. The travel time between two stops is then a difference of two
+	// entries. Routes are never resized, so new routes are appended. A route
+	// added again after its removal gets a new slice, and its previous slice
+	// stays unused until the network is saved and loaded again.
+	std::vector<uint32_t>	m_routeStops {};
+	std::vector<uint32_t>	m_cumulativeTravelTimes {};
+	std::vector<std::pair<uint32_t, uint32_t>>	m_stopPositions {};
 
-	std::shared_ptr<GraphNode> GetStation(
+	// Out-of-service state. An edge is closed if it was disabled itself, or
+	// if its route or either of its stations was disabled. Queries only test
+	// m_closedEdges, which the Disable and Enable functions keep up to date.
+	std::vector<bool>	m_disabledStations {};
+	std::vector<bool>	m_disabledRoutes {};
+	std::vector<bool>	m_disabledEdges {};
+	std::vector<bool>	m_closedEdges {};
+	size_t				m_nClosedEdges {0};
+
+	// Stations, lines and routes removed by ApplyPatch. Their IDs stay in the
+	// ID tables, but they no longer resolve to a handle.
+	std::vector<bool>	m_removedStations {};
+	std::vector<bool>	m_removedLines {};
+	std::vector<bool>	m_removedRoutes {};
+
+	IdTable	m_stationIds {};
+	IdTable	m_lineIds {};
+	IdTable	m_routeIds {};
+
+	NameTable	m_stationNames {};
+	NameTable	m_lineNames {};
+	NameTable	m_routeNames {};
+
+	uint32_t GetStationIndex(
 		const Id& stationId
 	) const;
 
-	std::shared_ptr<LineInternal> GetLine(
+	uint32_t GetLineIndex(
 		const Id& lineId
 	) const;
 
-	std::shared_ptr<RouteInternal> GetRouteFromLine(
-		std::shared_ptr<LineInternal> line,
+	uint32_t GetRouteIndex(
+		const uint32_t line,
+		const Id& routeId
+	) const;
+
+	uint32_t GetRouteIndex(
 		const Id& routeId
 	) const;
 
-	bool AddRouteToLine(
-		std::shared_ptr<LineInternal> line,
-		const Route& route
+	// Handles of removed stations and routes are no longer valid, even though
+	// their index is still in range.
+	bool IsValidStation(
+		const StationHandle station
+	) const;
+
+	bool IsValidRoute(
+		const RouteHandle route
+	) const;
+
+	EdgeRange GetEdges(
+		const uint32_t station
+	) const;
+
+	void Reserve(
+		const size_t nStations,
+		const size_t nLines,
+		const size_t nRoutes,
+		const size_t nStops
+	);
+
+	// Sort the stop positions of a route, once its stops are set.
+	void IndexRouteStops(
+		const uint32_t route
+	);
+
+	uint32_t GetStopPosition(
+		const uint32_t route,
+		const uint32_t station
+	) const;
+
+	// Index of the edge from the stop at `position` to the next stop of a
+	// route.
+	uint32_t GetRouteEdge(
+		const uint32_t route,
+		const uint32_t position
+	) const;
+
+	// The Insert and Add functions below add an item with a new ID, or bring
+	// back a removed one, without any validation.
+	uint32_t InsertStation(
+		const Station& station
+	);
+
+	uint32_t InsertLine(
+		const Line& line,
+		std::vector<std::pair<uint32_t, GraphEdge>>& newEdges
+	);
+
+	uint32_t AddRouteToLine(
+		const uint32_t line,
+		const Route& route,
+		std::vector<std::pair<uint32_t, GraphEdge>>& newEdges
+	);
+
+	// Free the edges of a route and detach it from its line and stations.
+	void RemoveRoute(
+		const uint32_t route
+	);
+
+	void InsertEdges(
+		const std::vector<std::pair<uint32_t, GraphEdge>>& newEdges
+	);
+
+	bool SetTravelTime(
+		const uint32_t stationA,
+		const uint32_t stationB,
+		const uint32_t travelTime
+	);
+
+	uint32_t GetTravelTime(
+		const uint32_t stationA,
+		const uint32_t stationB
+	) const;
+
+	uint32_t GetTravelTime(
+		const uint32_t route,
+		const uint32_t stationA,
+		const uint32_t stationB
+	) const;
+
+	uint32_t GetCrowdingCost(
+		const uint32_t station
+	) const;
+
+	void InvalidateLayoutCaches();
+
+	// Open every station, route and edge, and mark them as not removed, once
+	// the layout is complete.
+	void ResetItemStates();
+
+	bool SetRouteDisabled(
+		const RouteHandle route,
+		const bool disabled
+	);
+
+	bool SetStationDisabled(
+		const StationHandle station,
+		const bool disabled
+	);
+
+	bool SetEdgeDisabled(
+		const StationHandle stationA,
+		const StationHandle stationB,
+		const bool disabled
+	);
+
+	// Recompute whether the edges, given as (station, edge) pairs, are closed,
+	// then update the contraction hierarchy and the travel time matrix.
+	void UpdateClosedEdges(
+		const std::vector<std::pair<uint32_t, uint32_t>>& edges
 	);
+
+	// Update the contraction hierarchy and the travel time matrix after the
+	// edges changed. The matrix must still hold the travel times from before
+	// the changes.
+	void UpdateCaches(
+		const std::vector<EdgeChange>& changes
+	);
+
+	// Weight of the arc between two stations in the contraction hierarchy: the
+	// travel time of the fastest open edge.
+	uint32_t GetArcWeight(
+		const uint32_t stationFrom,
+		const uint32_t stationTo
+	) const;
+
+	bool IsLayoutValid() const;
+
+	void RecordPassengerFlow(
+		const uint32_t station,
+		const PassengerEvent::Type type,
+		const std::chrono::system_clock::time_point timestamp
+	);
+
+	int64_t GetFlowBucket(
+		const std::chrono::system_clock::time_point timestamp
+	) const;
+
+	PassengerFlow GetFlowBucketCounts(
+		const uint32_t station,
+		const int64_t bucket
+	) const;
+
+	std::vector<uint32_t> GetAffectedMatrixRows(
+		const uint32_t stationA,
+		const uint32_t stationB,
+		const uint32_t travelTime
+	) const;
+
+	std::vector<uint32_t> GetAffectedMatrixRows(
+		const std::vector<EdgeChange>& changes
+	) const;
+
+	void ComputeMatrixRows(
+		const std::vector<uint32_t>& rows
+	);
+
+	void ComputeTravelTimes(
+		const uint32_t source,
+		uint32_t* travelTimes,
+		std::vector<std::pair<uint32_t, uint32_t>>& heap
+	) const;
+
+	uint32_t FindFastestPath(
+		const uint32_t stationA,
+		const uint32_t stationB,
+		const uint32_t lineChangePenalty,
+		std::vector<uint32_t>& pathEdges
+	) const;
+
+	// Best path from `station`, reached through `previousEdge`, to `stationB`
+	// for the travel suggestions. The path takes neither the banned stations
+	// nor, as its first edge, the banned edges of the search scratch buffers.
+	bool FindSpurPath(
+		const uint32_t station,
+		const uint32_t previousEdge,
+		const uint32_t stationB,
+		std::vector<uint32_t>& pathEdges
+	) const;
 };
 
 } // namespace NetworkMonitor
\ No newline at end of file
@@ -0,0 +1,407 @@
+#include "network-monitor/ContractionHierarchy.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <set>
+#include <utility>
+
+using NetworkMonitor::ContractionHierarchy;
+
+namespace {
+
+constexpr uint32_t kNoArc {std::numeric_limits<uint32_t>::max()};
+
+uint32_t AddWeights(
+	const uint32_t weightA,
+	const uint32_t weightB
+)
+{
+	const uint64_t sum {static_cast<uint64_t>(weightA) + weightB};
+	return std::min<uint64_t>(sum, ContractionHierarchy::kInfinity);
+}
+
+// Scratch buffers for the queries, reused across queries on the same thread.
+// The distance of node `idx` is only valid if `stamps[idx]` is equal to
+// `stamp`.
+struct SearchScratch {
+	using QueueItem = std::pair<uint32_t, uint32_t>;
+
+	std::vector<uint32_t>	distances {};
+	std::vector<uint32_t>	stamps {};
+	uint32_t				stamp {0};
+	std::vector<QueueItem>	queue {};
+
+	void Prepare(
+		const size_t nNodes
+	)
+	{
+		if (stamps.size() < nNodes) {
+			distances.resize(nNodes);
+			stamps.resize(nNodes, 0);
+		}
+		if (++stamp == 0) {
+			std::fill(stamps.begin(), stamps.end(), 0);
+			stamp = 1;
+		}
+		queue.clear();
+	}
+
+	uint32_t GetDistance(
+		const uint32_t node
+	) const
+	{
+		return stamps[node] == stamp ?
+			distances[node] : ContractionHierarchy::kInfinity;
+	}
+
+	void Push(
+		const uint32_t node,
+		const uint32_t distance
+	)
+	{
+		if (GetDistance(node) <= distance) {
+			return;
+		}
+		stamps[node] = stamp;
+		distances[node] = distance;
+		queue.emplace_back(distance, node);
+		std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem> {});
+	}
+
+	QueueItem Pop()
+	{
+		std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem> {});
+		const auto item {queue.back()};
+		queue.pop_back();
+		return item;
+	}
+
+	uint32_t TopDistance() const
+	{
+		return queue.empty() ? ContractionHierarchy::kInfinity : queue.front().first;
+	}
+};
+
+thread_local SearchScratch gForwardScratch {};
+thread_local SearchScratch gBackwardScratch {};
+
+} // namespace
+
+ContractionHierarchy::ContractionHierarchy() = default;
+
+ContractionHierarchy::ContractionHierarchy(
+	const uint32_t nNodes,
+	const std::vector<Arc>& arcs
+)
+{
+	// Undirected adjacency of the input graph.
+	std::vector<std::vector<uint32_t>> neighbors(nNodes);
+	auto connect {[&neighbors](const uint32_t nodeA, const uint32_t nodeB) {
+		auto& list {neighbors[nodeA]};
+		const auto it {std::lower_bound(list.begin(), list.end(), nodeB)};
+		if (it == list.end() || *it != nodeB) {
+			list.insert(it, nodeB);
+		}
+	}};
+	for (const auto& arc: arcs) {
+		if (arc.from >= nNodes || arc.to >= nNodes || arc.from == arc.to) {
+			continue;
+		}
+		connect(arc.from, arc.to);
+		connect(arc.to, arc.from);
+	}
+
+	// Contract the nodes in minimum-degree order. When a node is contracted,
+	// its remaining neighbors become pairwise adjacent. Outdated queue entries
+	// are skipped when popped.
+	m_ranks.assign(nNodes, 0);
+	m_order.reserve(nNodes);
+	std::vector<std::vector<uint32_t>> upNeighbors(nNodes);
+	std::vector<bool> contracted(nNodes, false);
+	using QueueItem = std::pair<size_t, uint32_t>;
+	std::priority_queue<
+		QueueItem, std::vector<QueueItem>, std::greater<QueueItem>
+	> queue {};
+	for (uint32_t node {0}; node < nNodes; ++node) {
+		queue.emplace(neighbors[node].size(), node);
+	}
+	while (!queue.empty()) {
+		const auto [degree, node] {queue.top()};
+		queue.pop();
+		if (contracted[node] || degree != neighbors[node].size()) {
+			continue;
+		}
+
+		contracted[node] = true;
+		m_ranks[node] = m_order.size();
+		m_order.push_back(node);
+
+		auto& nodeNeighbors {neighbors[node]};
+		for (const auto neighbor: nodeNeighbors) {
+			auto& list {neighbors[neighbor]};
+			list.erase(std::lower_bound(list.begin(), list.end(), node));
+		}
+		for (size_t idxA {0}; idxA < nodeNeighbors.size(); ++idxA) {
+			for (size_t idxB {idxA + 1}; idxB < nodeNeighbors.size(); ++idxB) {
+				connect(nodeNeighbors[idxA], nodeNeighbors[idxB]);
+				connect(nodeNeighbors[idxB], nodeNeighbors[idxA]);
+			}
+		}
+		for (const auto neighbor: nodeNeighbors) {
+			queue.emplace(neighbors[neighbor].size(), neighbor);
+		}
+		upNeighbors[node] = std::move(nodeNeighbors);
+		nodeNeighbors.clear();
+	}
+
+	// Upward arcs, sorted by target within each node.
+	m_upOffsets.assign(nNodes + 1, 0);
+	for (uint32_t node {0}; node < nNodes; ++node) {
+		m_upOffsets[node + 1] = m_upOffsets[node] + upNeighbors[node].size();
+	}
+	m_upTargets.reserve(m_upOffsets[nNodes]);
+	for (uint32_t node {0}; node < nNodes; ++node) {
+		m_upTargets.insert(
+			m_upTargets.end(),
+			upNeighbors[node].begin(),
+			upNeighbors[node].end()
+		);
+	}
+
+	// Downward arcs, sorted by source within each node.
+	m_downOffsets.assign(nNodes + 1, 0);
+	for (const auto target: m_upTargets) {
+		++m_downOffsets[target + 1];
+	}
+	for (uint32_t node {0}; node < nNodes; ++node) {
+		m_downOffsets[node + 1] += m_downOffsets[node];
+	}
+	m_downSources.resize(m_upTargets.size());
+	m_downArcs.resize(m_upTargets.size());
+	std::vector<uint32_t> cursor(m_downOffsets.begin(), m_downOffsets.end() - 1);
+	for (uint32_t node {0}; node < nNodes; ++node) {
+		for (auto arc {m_upOffsets[node]}; arc < m_upOffsets[node + 1]; ++arc) {
+			const auto slot {cursor[m_upTargets[arc]]++};
+			m_downSources[slot] = node;
+			m_downArcs[slot] = arc;
+		}
+	}
+
+	// Input metric.
+	m_inputUpWeights.assign(m_upTargets.size(), kInfinity);
+	m_inputDownWeights.assign(m_upTargets.size(), kInfinity);
+	for (const auto& arc: arcs) {
+		if (arc.from >= nNodes || arc.to >= nNodes || arc.from == arc.to) {
+			continue;
+		}
+		if (m_ranks[arc.from] < m_ranks[arc.to]) {
+			auto& weight {m_inputUpWeights[FindArc(arc.from, arc.to)]};
+			weight = std::min(weight, arc.weight);
+		} else {
+			auto& weight {m_inputDownWeights[FindArc(arc.to, arc.from)]};
+			weight = std::min(weight, arc.weight);
+		}
+	}
+
+	Customize();
+}
+
+bool ContractionHierarchy::Empty() const
+{
+	return m_order.empty();
+}
+
+uint32_t ContractionHierarchy::GetDistance(
+	const uint32_t from,
+	const uint32_t to
+) const
+{
+	const auto nNodes {m_order.size()};
+	if (from >= nNodes || to >= nNodes) {
+		return kInfinity;
+	}
+	if (from == to) {
+		return 0;
+	}
+
+	// Bidirectional upward search. The forward search follows the arcs in their
+	// direction of travel, the backward search follows them in reverse.
+	auto& forward {gForwardScratch};
+	auto& backward {gBackwardScratch};
+	forward.Prepare(nNodes);
+	backward.Prepare(nNodes);
+	forward.Push(from, 0);
+	backward.Push(to, 0);
+
+	uint32_t best {kInfinity};
+	auto step {[this, &best](
+		SearchScratch& search,
+		const SearchScratch& other,
+		const std::vector<uint32_t>& weights
+	) {
+		const auto [distance, node] {search.Pop()};
+		if (distance > search.GetDistance(node)) {
+			return;
+		}
+		best = std::min(best, AddWeights(distance, other.GetDistance(node)));
+		for (auto arc {m_upOffsets[node]}; arc < m_upOffsets[node + 1]; ++arc) {
+			const auto weight {weights[arc]};
+			if (weight != kInfinity) {
+				search.Push(m_upTargets[arc], AddWeights(distance, weight));
+			}
+		}
+	}};
+	while (std::min(forward.TopDistance(), backward.TopDistance()) < best) {
+		if (forward.TopDistance() <= backward.TopDistance()) {
+			step(forward, backward, m_upWeights);
+		} else {
+			step(backward, forward, m_downWeights);
+		}
+	}
+
+	return best;
+}
+
+bool ContractionHierarchy::UpdateArc(
+	const Arc& arc
+)
+{
+	const auto nNodes {m_order.size()};
+	if (arc.from >= nNodes || arc.to >= nNodes || arc.from == arc.to) {
+		return false;
+	}
+
+	const bool isUp {m_ranks[arc.from] < m_ranks[arc.to]};
+	const auto lower {isUp ? arc.from : arc.to};
+	const auto higher {isUp ? arc.to : arc.from};
+	const auto arcIdx {FindArc(lower, higher)};
+	if (arcIdx == kNoArc) {
+		return false;
+	}
+	(isUp ? m_inputUpWeights : m_inputDownWeights)[arcIdx] = arc.weight;
+
+	// A hierarchy arc depends on the arcs of the triangles it forms with
+	// lower-ranked nodes. Process the affected arcs by increasing rank of their
+	// lower node, so that every arc is recomputed after all the arcs it
+	// depends on.
+	std::set<std::pair<uint32_t, uint32_t>> pending {};
+	pending.emplace(m_ranks[lower], arcIdx);
+	while (!pending.empty()) {
+		const auto [rank, current] {*pending.begin()};
+		pending.erase(pending.begin());
+
+		const auto node {m_order[rank]};
+		if (!RecomputeArc(node, current)) {
+			continue;
+		}
+
+		const auto target {m_upTargets[current]};
+		for (auto other {m_upOffsets[node]}; other < m_upOffsets[node + 1]; ++other) {
+			const auto otherTarget {m_upTargets[other]};
+			if (otherTarget == target) {
+				continue;
+			}
+			const bool targetIsLower {m_ranks[target] < m_ranks[otherTarget]};
+			const auto dependentLower {targetIsLower ? target : otherTarget};
+			const auto dependentHigher {targetIsLower ? otherTarget : target};
+			pending.emplace(
+				m_ranks[dependentLower],
+				FindArc(dependentLower, dependentHigher)
+			);
+		}
+	}
+
+	return true;
+}
+
+// Private functions
+
+uint32_t ContractionHierarchy::FindArc(
+	const uint32_t lower,
+	const uint32_t higher
+) const
+{
+	const auto first {m_upTargets.begin() + m_upOffsets[lower]};
+	const auto last {m_upTargets.begin() + m_upOffsets[lower + 1]};
+	const auto it {std::lower_bound(first, last, higher)};
+	if (it == last || *it != higher) {
+		return kNoArc;
+	}
+
+	return it - m_upTargets.begin();
+}
+
+void ContractionHierarchy::Customize()
+{
+	m_upWeights = m_inputUpWeights;
+	m_downWeights = m_inputDownWeights;
+
+	// For every node, by increasing rank, shortcut the paths through it between
+	// any two of its higher-ranked neighbors. Each pair of neighbors is
+	// adjacent by construction.
+	for (const auto node: m_order) {
+		const auto first {m_upOffsets[node]};
+		const auto last {m_upOffsets[node + 1]};
+		for (auto arcA {first}; arcA < last; ++arcA) {
+			for (auto arcB {first}; arcB < last; ++arcB) {
+				const auto targetA {m_upTargets[arcA]};
+				const auto targetB {m_upTargets[arcB]};
+				if (m_ranks[targetA] >= m_ranks[targetB]) {
+					continue;
+				}
+				const auto shortcut {FindArc(targetA, targetB)};
+				m_upWeights[shortcut] = std::min(
+					m_upWeights[shortcut],
+					AddWeights(m_downWeights[arcA], m_upWeights[arcB])
+				);
+				m_downWeights[shortcut] = std::min(
+					m_downWeights[shortcut],
+					AddWeights(m_downWeights[arcB], m_upWeights[arcA])
+				);
+			}
+		}
+	}
+}
+
+bool ContractionHierarchy::RecomputeArc(
+	const uint32_t lower,
+	const uint32_t arc
+)
+{
+	const auto higher {m_upTargets[arc]};
+	auto upWeight {m_inputUpWeights[arc]};
+	auto downWeight {m_inputDownWeights[arc]};
+
+	// Walk the lower-ranked neighbors common to both endpoints.
+	auto idxA {m_downOffsets[lower]};
+	auto idxB {m_downOffsets[higher]};
+	const auto lastA {m_downOffsets[lower + 1]};
+	const auto lastB {m_downOffsets[higher + 1]};
+	while (idxA < lastA && idxB < lastB) {
+		if (m_downSources[idxA] < m_downSources[idxB]) {
+			++idxA;
+		} else if (m_downSources[idxB] < m_downSources[idxA]) {
+			++idxB;
+		} else {
+			const auto arcA {m_downArcs[idxA++]};
+			const auto arcB {m_downArcs[idxB++]};
+			upWeight = std::min(
+				upWeight,
+				AddWeights(m_downWeights[arcA], m_upWeights[arcB])
+			);
+			downWeight = std::min(
+				downWeight,
+				AddWeights(m_downWeights[arcB], m_upWeights[arcA])
+			);
+		}
+	}
+
+	if (upWeight == m_upWeights[arc] && downWeight == m_downWeights[arc]) {
+		return false;
+	}
+	m_upWeights[arc] = upWeight;
+	m_downWeights[arc] = downWeight;
+
+	return true;
+}
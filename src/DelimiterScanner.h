@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace NetworkMonitor {
+
+// Finds the positions of a set of delimiter characters in a buffer, in order.
+//
+// The buffer is read in blocks of 64 bytes: each block is compared against all
+// the delimiters at once, two 32-byte vectors at a time with AVX2 or four
+// 16-byte vectors with SSE2, and the matches are kept as a bitmask that
+// successive calls to Next() pop. Every byte is loaded once, however many
+// delimiters it is followed by. Targets without SSE2 compare one byte at a
+// time.
+//
+// The vector width is chosen at compile time: AVX2 is only used if the
+// library is compiled for it (e.g. -mavx2 or -march=native).
+template <char... Delimiters>
+class DelimiterScanner {
+public:
+	DelimiterScanner(
+		const std::string_view data
+	) : m_data {data.data()},
+		m_size {data.size()}
+	{
+	}
+
+	// Position of the next delimiter, or the size of the buffer if there are no
+	// delimiters left.
+	size_t Next()
+	{
+		while (m_mask == 0) {
+			if (m_next >= m_size) {
+				return m_size;
+			}
+			m_base = m_next;
+			if (m_size - m_base >= kBlockSize) {
+				m_mask = MatchBlock(m_data + m_base);
+				m_next = m_base + kBlockSize;
+			} else {
+				m_mask = MatchTail(m_data + m_base, m_size - m_base);
+				m_next = m_size;
+			}
+		}
+		const auto position {m_base + CountTrailingZeros(m_mask)};
+		m_mask &= m_mask - 1;
+		return position;
+	}
+
+private:
+	static constexpr size_t kBlockSize {64};
+
+	const char*	m_data {nullptr};
+	size_t		m_size {0};
+	size_t		m_next {0};
+	size_t		m_base {0};
+	uint64_t	m_mask {0};
+
+	static size_t CountTrailingZeros(
+		uint64_t mask
+	)
+	{
+#if defined(__GNUC__)
+		return static_cast<size_t>(__builtin_ctzll(mask));
+#else
+		size_t count {0};
+		for (; (mask & 1) == 0; mask >>= 1) {
+			++count;
+		}
+		return count;
+#endif
+	}
+
+	// Bit N is set if byte N of the last `nBytes` bytes of the buffer is a
+	// delimiter. Reading a whole block could cross the end of the buffer, so the
+	// bytes are copied to a block of their own.
+	static uint64_t MatchTail(
+		const char* bytes,
+		const size_t nBytes
+	)
+	{
+		alignas(64) char block[kBlockSize] {};
+		std::memcpy(block, bytes, nBytes);
+		return MatchBlock(block) & ((uint64_t {1} << nBytes) - 1);
+	}
+
+	// Bit N is set if byte N of the 64-byte block is a delimiter.
+	static uint64_t MatchBlock(
+		const char* block
+	)
+	{
+#if defined(__AVX2__)
+		uint64_t mask {0};
+		for (size_t offset {0}; offset < kBlockSize; offset += 32) {
+			const auto bytes {_mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(block + offset)
+			)};
+			auto matches {_mm256_setzero_si256()};
+			((matches = _mm256_or_si256(
+				matches,
+				_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(Delimiters))
+			)), ...);
+			mask |= uint64_t {static_cast<uint32_t>(
+				_mm256_movemask_epi8(matches)
+			)} << offset;
+		}
+		return mask;
+#elif defined(__SSE2__) || defined(_M_X64)
+		uint64_t mask {0};
+		for (size_t offset {0}; offset < kBlockSize; offset += 16) {
+			const auto bytes {_mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(block + offset)
+			)};
+			auto matches {_mm_setzero_si128()};
+			((matches = _mm_or_si128(
+				matches,
+				_mm_cmpeq_epi8(bytes, _mm_set1_epi8(Delimiters))
+			)), ...);
+			mask |= uint64_t {static_cast<uint32_t>(
+				_mm_movemask_epi8(matches)
+			)} << offset;
+		}
+		return mask;
+#else
+		uint64_t mask {0};
+		for (size_t idx {0}; idx < kBlockSize; ++idx) {
+			if (((block[idx] == Delimiters) || ...)) {
+				mask |= uint64_t {1} << idx;
+			}
+		}
+		return mask;
+#endif
+	}
+};
+
+} // namespace NetworkMonitor
@@ -0,0 +1,414 @@
+#include "network-monitor/MappedTransportNetwork.h"
+
+#include "SnapshotFormat.h"
+
+#include <boost/interprocess/exceptions.hpp>
+
+#include <cstring>
+#include <limits>
+#include <utility>
+
+using NetworkMonitor::LineHandle;
+using NetworkMonitor::MappedTransportNetwork;
+using NetworkMonitor::RouteHandle;
+using NetworkMonitor::StationHandle;
+
+namespace SnapshotFormat = NetworkMonitor::SnapshotFormat;
+
+namespace {
+
+constexpr uint32_t kInvalidIndex {std::numeric_limits<uint32_t>::max()};
+
+} // namespace
+
+// IdTable
+
+uint32_t MappedTransportNetwork::IdTable::Find(
+	std::string_view id
+) const
+{
+	if (slots.size == 0) {
+		return kInvalidIndex;
+	}
+
+	const size_t mask {slots.size - 1};
+	for (size_t slot {SnapshotFormat::HashId(id) & mask};;
+		slot = (slot + 1) & mask) {
+		const auto index {slots.items[slot]};
+		if (index == kInvalidIndex || Get(index) == id) {
+			return index;
+		}
+	}
+}
+
+std::string_view MappedTransportNetwork::IdTable::Get(
+	const uint32_t index
+) const
+{
+	return {
+		chars.items + offsets.items[index],
+		offsets.items[index + 1] - offsets.items[index]
+	};
+}
+
+// MappedTransportNetwork
+
+MappedTransportNetwork::MappedTransportNetwork() = default;
+
+MappedTransportNetwork::~MappedTransportNetwork() = default;
+
+MappedTransportNetwork::MappedTransportNetwork(
+	MappedTransportNetwork&& moved
+)
+{
+	*this = std::move(moved);
+}
+
+MappedTransportNetwork& MappedTransportNetwork::operator=(
+	MappedTransportNetwork&& moved
+)
+{
+	if (this == &moved) {
+		return *this;
+	}
+
+	// The views keep pointing to the same mapping, which only changes owner.
+	m_file = std::move(moved.m_file);
+	m_region = std::move(moved.m_region);
+	m_stationIds = moved.m_stationIds;
+	m_lineIds = moved.m_lineIds;
+	m_routeIds = moved.m_routeIds;
+	m_stationNames = moved.m_stationNames;
+	m_stationNameOffsets = moved.m_stationNameOffsets;
+	m_servingRoutes = moved.m_servingRoutes;
+	m_servingRouteOffsets = moved.m_servingRouteOffsets;
+	m_edgeOffsets = moved.m_edgeOffsets;
+	m_edges = moved.m_edges;
+	m_routeLines = moved.m_routeLines;
+	m_stops = moved.m_stops;
+	m_stopOffsets = moved.m_stopOffsets;
+	m_cumulativeTravelTimes = moved.m_cumulativeTravelTimes;
+	m_removedStations = moved.m_removedStations;
+	m_removedLines = moved.m_removedLines;
+	m_removedRoutes = moved.m_removedRoutes;
+	moved.Close();
+
+	return *this;
+}
+
+bool MappedTransportNetwork::Open(
+	const std::filesystem::path& source
+)
+{
+	namespace ipc = boost::interprocess;
+
+	Close();
+	try {
+		m_file = ipc::file_mapping {source.string().c_str(), ipc::read_only};
+		m_region = ipc::mapped_region {m_file, ipc::read_only};
+	} catch (const ipc::interprocess_exception&) {
+		Close();
+		return false;
+	}
+
+	const auto* data {static_cast<const char*>(m_region.get_address())};
+	const auto size {m_region.get_size()};
+	SnapshotFormat::Header header {};
+	if (size < sizeof(header)) {
+		Close();
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(header));
+	const auto* payload {data + sizeof(header)};
+	if (!SnapshotFormat::IsValidHeader(header, size)
+		|| header.checksum
+			!= SnapshotFormat::GetChecksum(payload, header.payloadSize)) {
+		Close();
+		return false;
+	}
+
+	// Sections we do not query are skipped.
+	SnapshotFormat::SectionCursor sections {payload, header.payloadSize};
+	auto next {[&sections](auto& array) {
+		return sections.Next(array.items, array.size);
+	}};
+	auto skip {[&next](const size_t nSections) {
+		Array<char> section {};
+		bool ok {true};
+		for (size_t idx {0}; idx < nSections; ++idx) {
+			ok = ok && next(section);
+		}
+		return ok;
+	}};
+	auto isValidOffsets {[](const Array<uint32_t>& offsets, const size_t size) {
+		return SnapshotFormat::IsValidOffsets(offsets.items, offsets.size, size);
+	}};
+	auto isValidIds {[&isValidOffsets](const IdTable& ids) {
+		const auto nSlots {ids.slots.size};
+		if (!isValidOffsets(ids.offsets, ids.chars.size)
+			|| (nSlots & (nSlots - 1)) != 0
+			|| (nSlots == 0 ? ids.offsets.size != 1 : nSlots < ids.offsets.size)) {
+			return false;
+		}
+
+		// Find() reads the IDs of the slots it probes and stops at the first
+		// free slot: every index must be in range and appear once per ID.
+		const auto nIds {ids.offsets.size - 1};
+		size_t nUsed {0};
+		for (size_t slot {0}; slot < nSlots; ++slot) {
+			const auto index {ids.slots.items[slot]};
+			if (index != kInvalidIndex) {
+				if (index >= nIds) {
+					return false;
+				}
+				++nUsed;
+			}
+		}
+		return nUsed == nIds;
+	}};
+	auto isValidIndices {[](const auto& array, const size_t size) {
+		for (size_t idx {0}; idx < array.size; ++idx) {
+			if (array.items[idx] >= size) {
+				return false;
+			}
+		}
+		return true;
+	}};
+
+	bool ok {true};
+	for (auto* ids: {&m_stationIds, &m_lineIds, &m_routeIds}) {
+		ok = ok
+			&& next(ids->chars)
+			&& next(ids->offsets)
+			&& next(ids->slots)
+			&& isValidIds(*ids);
+	}
+	ok = ok
+		&& next(m_stationNames)
+		&& next(m_stationNameOffsets)
+		&& next(m_servingRoutes)
+		&& next(m_servingRouteOffsets)
+		&& next(m_edgeOffsets)
+		&& next(m_edges)
+		&& skip(4)
+		&& skip(2)
+		&& next(m_routeLines)
+		&& next(m_stops)
+		&& next(m_stopOffsets)
+		&& next(m_cumulativeTravelTimes)
+		&& skip(1)
+		&& next(m_removedStations)
+		&& next(m_removedLines)
+		&& next(m_removedRoutes)
+		&& sections.AtEnd();
+	const auto nStations {ok ? m_stationIds.offsets.size - 1 : 0};
+	const auto nLines {ok ? m_lineIds.offsets.size - 1 : 0};
+	const auto nRoutes {ok ? m_routeIds.offsets.size - 1 : 0};
+	ok = ok
+		&& isValidOffsets(m_stationNameOffsets, m_stationNames.size)
+		&& m_stationNameOffsets.size == nStations + 1
+		&& isValidOffsets(m_servingRouteOffsets, m_servingRoutes.size)
+		&& m_servingRouteOffsets.size == nStations + 1
+		&& isValidOffsets(m_edgeOffsets, m_edges.size)
+		&& m_edgeOffsets.size == nStations + 1
+		&& m_routeLines.size == nRoutes
+		&& isValidOffsets(m_stopOffsets, m_stops.size)
+		&& m_stopOffsets.size == nRoutes + 1
+		&& m_cumulativeTravelTimes.size == m_stops.size
+		&& m_removedStations.size == nStations
+		&& m_removedLines.size == nLines
+		&& m_removedRoutes.size == nRoutes
+		&& isValidIndices(m_routeLines, nLines)
+		&& isValidIndices(m_stops, nStations);
+
+	// The queries index other sections with these values without checking them.
+	for (size_t idx {0}; ok && idx < m_servingRoutes.size; ++idx) {
+		ok = m_servingRoutes.items[idx].index < nRoutes;
+	}
+	for (size_t idx {0}; ok && idx < m_edges.size; ++idx) {
+		const auto& edge {m_edges.items[idx]};
+		ok = edge.route < nRoutes && edge.line < nLines && edge.next < nStations;
+	}
+	if (!ok) {
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+size_t MappedTransportNetwork::GetStationCount() const
+{
+	return m_edgeOffsets.size == 0 ? 0 : m_edgeOffsets.size - 1;
+}
+
+StationHandle MappedTransportNetwork::GetStationHandle(
+	std::string_view stationId
+) const
+{
+	const auto station {m_stationIds.Find(stationId)};
+	if (station == kInvalidIndex || m_removedStations.items[station]) {
+		return {};
+	}
+
+	return {station};
+}
+
+LineHandle MappedTransportNetwork::GetLineHandle(
+	std::string_view lineId
+) const
+{
+	const auto line {m_lineIds.Find(lineId)};
+	if (line == kInvalidIndex || m_removedLines.items[line]) {
+		return {};
+	}
+
+	return {line};
+}
+
+RouteHandle MappedTransportNetwork::GetRouteHandle(
+	const LineHandle line,
+	std::string_view routeId
+) const
+{
+	const auto route {m_routeIds.Find(routeId)};
+	if (route == kInvalidIndex
+		|| m_removedRoutes.items[route]
+		|| m_routeLines.items[route] != line.index) {
+		return {};
+	}
+
+	return {route};
+}
+
+std::string_view MappedTransportNetwork::GetStationId(
+	const StationHandle station
+) const
+{
+	if (station.index >= GetStationCount()
+		|| m_removedStations.items[station.index]) {
+		return {};
+	}
+
+	return m_stationIds.Get(station.index);
+}
+
+std::string_view MappedTransportNetwork::GetStationName(
+	const StationHandle station
+) const
+{
+	if (station.index >= GetStationCount()
+		|| m_removedStations.items[station.index]) {
+		return {};
+	}
+
+	const auto* offsets {m_stationNameOffsets.items};
+	return {
+		m_stationNames.items + offsets[station.index],
+		offsets[station.index + 1] - offsets[station.index]
+	};
+}
+
+std::string_view MappedTransportNetwork::GetRouteId(
+	const RouteHandle route
+) const
+{
+	if (route.index >= m_routeLines.size || m_removedRoutes.items[route.index]) {
+		return {};
+	}
+
+	return m_routeIds.Get(route.index);
+}
+
+MappedTransportNetwork::RouteRange MappedTransportNetwork::GetRoutesServingStation(
+	const StationHandle station
+) const
+{
+	if (station.index >= GetStationCount()) {
+		return {};
+	}
+
+	const auto* offsets {m_servingRouteOffsets.items};
+	return {
+		m_servingRoutes.items + offsets[station.index],
+		m_servingRoutes.items + offsets[station.index + 1]
+	};
+}
+
+uint32_t MappedTransportNetwork::GetTravelTime(
+	const StationHandle stationA,
+	const StationHandle stationB
+) const
+{
+	if (stationA.index >= GetStationCount()
+		|| stationB.index >= GetStationCount()) {
+		return 0;
+	}
+
+	const auto* offsets {m_edgeOffsets.items};
+	for (const auto& [from, to]: {
+		std::pair {stationA.index, stationB.index},
+		std::pair {stationB.index, stationA.index},
+	}) {
+		for (auto edge {offsets[from]}; edge < offsets[from + 1]; ++edge) {
+			if (m_edges.items[edge].next == to) {
+				return m_edges.items[edge].travelTime;
+			}
+		}
+	}
+
+	return 0;
+}
+
+uint32_t MappedTransportNetwork::GetTravelTime(
+	const RouteHandle route,
+	const StationHandle stationA,
+	const StationHandle stationB
+) const
+{
+	if (route.index >= m_routeLines.size) {
+		return 0;
+	}
+
+	// Routes are short: scanning their stops is cheaper than a hash lookup.
+	const auto first {m_stopOffsets.items[route.index]};
+	const auto last {m_stopOffsets.items[route.index + 1]};
+	for (auto stopA {first}; stopA < last; ++stopA) {
+		if (m_stops.items[stopA] != stationA.index) {
+			continue;
+		}
+		for (auto stopB {stopA + 1}; stopB < last; ++stopB) {
+			if (m_stops.items[stopB] == stationB.index) {
+				return m_cumulativeTravelTimes.items[stopB]
+					- m_cumulativeTravelTimes.items[stopA];
+			}
+		}
+		return 0;
+	}
+
+	return 0;
+}
+
+// Private functions
+
+void MappedTransportNetwork::Close()
+{
+	m_region = {};
+	m_file = {};
+	m_stationIds = {};
+	m_lineIds = {};
+	m_routeIds = {};
+	m_stationNames = {};
+	m_stationNameOffsets = {};
+	m_servingRoutes = {};
+	m_servingRouteOffsets = {};
+	m_edgeOffsets = {};
+	m_edges = {};
+	m_routeLines = {};
+	m_stops = {};
+	m_stopOffsets = {};
+	m_cumulativeTravelTimes = {};
+	m_removedStations = {};
+	m_removedLines = {};
+	m_removedRoutes = {};
+}
@@ -0,0 +1,136 @@
+#include "network-monitor/NetworkSnapshots.h"
+
+#include <functional>
+#include <thread>
+
+using NetworkMonitor::NetworkSnapshots;
+using NetworkMonitor::TransportNetwork;
+
+namespace {
+
+// Threads start looking for a free reader slot at a position of their own, so
+// that concurrent readers rarely compete for the same slot.
+size_t GetFirstReaderSlot()
+{
+	thread_local const size_t slot {
+		std::hash<std::thread::id> {}(std::this_thread::get_id())
+		% NetworkSnapshots::kMaxReaders
+	};
+	return slot;
+}
+
+} // namespace
+
+// Snapshot
+
+NetworkSnapshots::Snapshot::Snapshot(
+	std::atomic<uint64_t>* slot,
+	const TransportNetwork* network
+) : m_slot {slot},
+	m_network {network}
+{
+}
+
+NetworkSnapshots::Snapshot::Snapshot(
+	Snapshot&& moved
+) : m_slot {moved.m_slot},
+	m_network {moved.m_network}
+{
+	moved.m_slot = nullptr;
+	moved.m_network = nullptr;
+}
+
+NetworkSnapshots::Snapshot::~Snapshot()
+{
+	if (m_slot != nullptr) {
+		m_slot->store(0, std::memory_order_release);
+	}
+}
+
+const TransportNetwork& NetworkSnapshots::Snapshot::operator*() const
+{
+	return *m_network;
+}
+
+const TransportNetwork* NetworkSnapshots::Snapshot::operator->() const
+{
+	return m_network;
+}
+
+// NetworkSnapshots
+
+NetworkSnapshots::NetworkSnapshots()
+	: NetworkSnapshots(TransportNetwork {})
+{
+}
+
+NetworkSnapshots::NetworkSnapshots(
+	TransportNetwork network
+) : m_current {new TransportNetwork(std::move(network))}
+{
+}
+
+NetworkSnapshots::~NetworkSnapshots()
+{
+	delete m_current.load();
+}
+
+NetworkSnapshots::Snapshot NetworkSnapshots::Read() const
+{
+	// Claim a free slot.
+	auto slot {GetFirstReaderSlot()};
+	for (size_t attempt {1};; ++attempt) {
+		uint64_t expected {0};
+		if (m_readers[slot].epoch.compare_exchange_weak(
+			expected,
+			kReservedSlot,
+			std::memory_order_acquire,
+			std::memory_order_relaxed
+		)) {
+			break;
+		}
+		slot = (slot + 1) % kMaxReaders;
+		if (attempt % kMaxReaders == 0) {
+			std::this_thread::yield();
+		}
+	}
+
+	// The epoch must be announced before the current version is loaded: a
+	// writer that replaces the version we load will then see our epoch when it
+	// checks the reader slots.
+	auto& epoch {m_readers[slot].epoch};
+	epoch.store(m_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+	return {&epoch, m_current.load(std::memory_order_seq_cst)};
+}
+
+void NetworkSnapshots::Publish(
+	TransportNetwork network
+)
+{
+	std::lock_guard<std::mutex> lock {m_writerMutex};
+	PublishLocked(std::make_unique<TransportNetwork>(std::move(network)));
+}
+
+uint64_t NetworkSnapshots::GetVersion() const
+{
+	return m_epoch.load(std::memory_order_acquire);
+}
+
+void NetworkSnapshots::PublishLocked(
+	std::unique_ptr<TransportNetwork> network
+)
+{
+	std::unique_ptr<const TransportNetwork> previous {
+		m_current.exchange(network.release(), std::memory_order_seq_cst)
+	};
+	const auto epoch {m_epoch.fetch_add(1, std::memory_order_seq_cst) + 1};
+
+	// Grace period: wait for the readers that may hold the previous version.
+	for (const auto& reader: m_readers) {
+		auto readerEpoch {reader.epoch.load(std::memory_order_seq_cst)};
+		while (readerEpoch != 0 && readerEpoch < epoch) {
+			std::this_thread::yield();
+			readerEpoch = reader.epoch.load(std::memory_order_seq_cst);
+		}
+	}
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+// Binary snapshot format of a TransportNetwork, shared by
+// TransportNetwork::SaveSnapshot/LoadSnapshot and MappedTransportNetwork.
+//
+// A snapshot is a fixed header followed by a payload of sections. Each section
+// is an array of trivially copyable items: its size in bytes as a uint64_t,
+// then the items, padded to a multiple of 8 bytes. Since the header is also a
+// multiple of 8 bytes, the items of every section are 8-byte aligned relative
+// to the start of the file. The checksum is FNV-1a over the 64-bit words of
+// the payload.
+//
+// Sections, in order:
+//  - Station, line and route ID tables: characters, offsets, hash slots.
+//  - Station names: characters, offsets.
+//  - Routes serving each station: route indices, offsets.
+//  - Edge offsets per station, edges.
+//  - Line names: characters, offsets.
+//  - Routes of each line: route indices, offsets.
+//  - Route names: characters, offsets.
+//  - Line of each route.
+//  - Stops of each route: station indices, offsets.
+//  - Cumulative travel times of each route: travel times, offsets.
+//  - Removed stations, lines and routes: one byte per item, non-zero if the
+//    item was removed from the network.
+namespace NetworkMonitor::SnapshotFormat {
+
+constexpr char kMagic[8] {'N', 'M', 'N', 'E', 'T', 'W', 'R', 'K'};
+constexpr uint32_t kVersion {2};
+constexpr uint32_t kByteOrder {0x01020304};
+
+struct Header {
+	char		magic[8] {};
+	uint32_t	version {0};
+	uint32_t	byteOrder {0};
+	uint64_t	payloadSize {0};
+	uint64_t	checksum {0};
+};
+
+// Edges are saved in the layout TransportNetwork uses in memory.
+struct Edge {
+	uint32_t	route {0};
+	uint32_t	line {0};
+	uint32_t	next {0};
+	uint32_t	travelTime {0};
+};
+
+inline uint64_t GetChecksum(
+	const char* data,
+	const size_t size
+)
+{
+	uint64_t hash {0xcbf29ce484222325};
+	for (size_t offset {0}; offset + sizeof(uint64_t) <= size;
+		offset += sizeof(uint64_t)) {
+		uint64_t word {0};
+		std::memcpy(&word, data + offset, sizeof(word));
+		hash = (hash ^ word) * 0x100000001b3;
+	}
+	return hash;
+}
+
+// Hash of the interned IDs. Stable across platforms and builds, since the hash
+// slots of the ID tables are saved in snapshots.
+inline size_t HashId(
+	std::string_view id
+)
+{
+	// 64-bit FNV-1a.
+	uint64_t hash {0xcbf29ce484222325};
+	for (const auto c: id) {
+		hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+	}
+	return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+inline bool IsValidHeader(
+	const Header& header,
+	const uint64_t fileSize
+)
+{
+	return std::memcmp(header.magic, kMagic, sizeof(header.magic)) == 0
+		&& header.version == kVersion
+		&& header.byteOrder == kByteOrder
+		&& header.payloadSize % sizeof(uint64_t) == 0
+		&& fileSize == sizeof(Header) + header.payloadSize;
+}
+
+// Offsets of the items of nested arrays into their concatenation of `size`
+// items.
+inline bool IsValidOffsets(
+	const uint32_t* offsets,
+	const size_t nOffsets,
+	const size_t size
+)
+{
+	return nOffsets > 0
+		&& offsets[0] == 0
+		&& offsets[nOffsets - 1] == size
+		&& std::is_sorted(offsets, offsets + nOffsets);
+}
+
+// Walks the sections of a payload in place.
+class SectionCursor {
+public:
+	SectionCursor() = default;
+
+	SectionCursor(
+		const char* payload,
+		const size_t size
+	) : m_payload {payload},
+		m_size {size}
+	{
+	}
+
+	// Get the items of the next section. `items` points into the payload, so it
+	// is only suitably aligned if the payload is 8-byte aligned.
+	template <typename T>
+	bool Next(
+		const T*& items,
+		size_t& count
+	)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		static_assert(alignof(T) <= 8);
+		uint64_t nBytes {0};
+		if (m_size - m_offset < sizeof(nBytes)) {
+			return false;
+		}
+		std::memcpy(&nBytes, m_payload + m_offset, sizeof(nBytes));
+		m_offset += sizeof(nBytes);
+		if (nBytes % sizeof(T) != 0 || m_size - m_offset < nBytes) {
+			return false;
+		}
+		items = reinterpret_cast<const T*>(m_payload + m_offset);
+		count = nBytes / sizeof(T);
+		m_offset += (nBytes + 7) & ~uint64_t {7};
+		return true;
+	}
+
+	bool AtEnd() const
+	{
+		return m_offset == m_size;
+	}
+
+private:
+	const char*	m_payload {nullptr};
+	size_t		m_size {0};
+	size_t		m_offset {0};
+};
+
+} // namespace NetworkMonitor::SnapshotFormat
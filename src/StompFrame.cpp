@@ -1,8 +1,14 @@
 #include <network-monitor/StompFrame.h>
 
-#include <boost/bimap.hpp>
+#include "DelimiterScanner.h"
+
+#include <array>
 #include <charconv>
+#include <cstdint>
+#include <limits>
 
+using NetworkMonitor::BufferedStompFrame;
+using NetworkMonitor::DelimiterScanner;
 using NetworkMonitor::StompCommand;
 using NetworkMonitor::StompHeader;
 using NetworkMonitor::StompError;
@@ -10,18 +16,106 @@ using NetworkMonitor::StompFrame;
 
 using Headers = StompFrame::Headers;
 
-// https://stackoverflow.com/questions/20288871/how-to-construct-boost-bimap-from-static-list
-template <typename L, typename R>
-boost::bimap<L, R>
-MakeBimap(std::initializer_list<typename boost::bimap<L, R>::value_type> list)
+// Names of the values of an enum whose last value is kUnknown, indexed by
+// value.
+//
+// Names are looked up with a perfect hash generated at compile time. The slot
+// of a name only depends on its length and on its first and last characters:
+// the constructor searches for a seed that gives each name a slot of its own,
+// so a lookup is one load and one string comparison.
+template <typename Enum, size_t N>
+class NameLookup {
+public:
+	static constexpr size_t kSlotCount {64};
+
+	constexpr NameLookup(
+		const std::array<std::string_view, N + 1>& names
+	) : m_names {names}
+	{
+		static_assert(N < kSlotCount);
+		for (m_seed = 1; m_seed < kMaxSeed; ++m_seed) {
+			if (FillSlots()) {
+				return;
+			}
+		}
+	}
+
+	constexpr bool IsPerfect() const
+	{
+		return m_seed < kMaxSeed;
+	}
+
+	// Unknown values get the name of kUnknown.
+	constexpr std::string_view GetName(
+		const Enum value
+	) const
+	{
+		const auto idx {static_cast<size_t>(value)};
+		return m_names[idx < N ? idx : N];
+	}
+
+	// Unknown names get kUnknown.
+	constexpr Enum Find(
+		const std::string_view name
+	) const
+	{
+		if (name.empty()) {
+			return static_cast<Enum>(N);
+		}
+		const auto idx {m_slots[GetSlot(name, m_seed)]};
+		if (idx < N && m_names[idx] == name) {
+			return static_cast<Enum>(idx);
+		}
+		return static_cast<Enum>(N);
+	}
+
+private:
+	static constexpr size_t kMaxSeed {256};
+
+	std::array<std::string_view, N + 1>	m_names {};
+	std::array<uint8_t, kSlotCount>		m_slots {};
+	size_t								m_seed {0};
+
+	static constexpr size_t GetSlot(
+		const std::string_view name,
+		const size_t seed
+	)
+	{
+		const size_t first {static_cast<uint8_t>(name.front())};
+		const size_t last {static_cast<uint8_t>(name.back())};
+		return (first + last * seed + name.size() * seed * seed) % kSlotCount;
+	}
+
+	constexpr bool FillSlots()
+	{
+		for (auto& slot: m_slots) {
+			slot = N;
+		}
+		for (size_t idx {0}; idx < N; ++idx) {
+			auto& slot {m_slots[GetSlot(m_names[idx], m_seed)]};
+			if (slot != N) {
+				return false;
+			}
+			slot = static_cast<uint8_t>(idx);
+		}
+		return true;
+	}
+};
+
+// Bit of a header in a header mask.
+static constexpr uint32_t GetHeaderBit(const StompHeader header)
 {
-    return boost::bimap<L, R>(list.begin(), list.end());
+	return uint32_t {1} << static_cast<uint32_t>(header);
 }
 
+// Header values are indexed by header, and are only used if their bit is set
+// in the mask.
+template <typename HeaderValues>
 static std::string ConstructFrame(
 	const StompCommand& command,
-    const Headers& 		headers,
-    const std::string& 	body
+    const HeaderValues& headers,
+    const uint32_t      headerMask,
+    const std::string_view body
 )
 {
     using namespace std::string_literals;
@@ -30,10 +124,14 @@ static std::string ConstructFrame(
     std::string frame {""};
     frame += NetworkMonitor::ToString(command);
     frame += "\n";
-    for (const auto& [header, value]: headers) {
+    for (size_t idx {0}; idx < headers.size(); ++idx) {
+        const auto header {static_cast<StompHeader>(idx)};
+        if ((headerMask & GetHeaderBit(header)) == 0) {
+            continue;
+        }
         frame += NetworkMonitor::ToString(header);
         frame += ":";
-        frame += value;
+        frame += headers[idx];
         frame += "\n";
     }
     frame += "\n";
@@ -43,50 +141,35 @@ static std::string ConstructFrame(
 	return frame;
 }
 
-static bool HasHeader(const Headers& headers, const StompHeader& header)
-{
-	return headers.find(header) != headers.end();
-}
-
-static std::string_view GetHeaderValue(const Headers& headers, const StompHeader stompHeader) 
-{
-	auto headerIt {headers.find(stompHeader)};
-	if (headerIt == headers.end()) {
-		return {};
-	}
-
-	return headerIt->second;
-}
-
 // StompCommand 
 
-static const auto gStompCommands = MakeBimap<StompCommand, std::string_view>(
-{
-	{StompCommand::kAbort      , "ABORT"      	  },
-	{StompCommand::kAck        , "ACK"        	  },
-	{StompCommand::kBegin      , "BEGIN"      	  },
-	{StompCommand::kCommit     , "COMMIT"     	  },
-	{StompCommand::kConnect    , "CONNECT"        },
-	{StompCommand::kConnected  , "CONNECTED"      },
-	{StompCommand::kDisconnect , "DISCONNECT"     },
-	{StompCommand::kError      , "ERROR"      	  },
-	{StompCommand::kMessage    , "MESSAGE"    	  },
-	{StompCommand::kNack       , "NACK"       	  },
-	{StompCommand::kReceipt    , "RECEIPT"    	  },
-	{StompCommand::kSend       , "SEND"       	  },
-	{StompCommand::kStomp      , "STOMP"      	  },
-	{StompCommand::kSubscribe  , "SUBSCRIBE"  	  },
-	{StompCommand::kUnsubscribe, "UNSUBSCRIBE"	  },
-	{StompCommand::kUnknown	   , "UNKNOWN COMMAND"}
-});
-
-std::string NetworkMonitor::ToString(const StompCommand& command) {
-	auto commandIt {gStompCommands.left.find(command)};
-	if (commandIt == gStompCommands.left.end()) {
-		return ToString(StompCommand::kUnknown);
-	}
-
-	return std::string(commandIt->second);
+static constexpr NameLookup<
+	StompCommand,
+	static_cast<size_t>(StompCommand::kUnknown)
+> gStompCommands {{
+	"ABORT",			// kAbort
+	"ACK",				// kAck
+	"BEGIN",			// kBegin
+	"COMMIT",			// kCommit
+	"CONNECT",			// kConnect
+	"CONNECTED",		// kConnected
+	"DISCONNECT",		// kDisconnect
+	"ERROR",			// kError
+	"MESSAGE",			// kMessage
+	"NACK",				// kNack
+	"RECEIPT",			// kReceipt
+	"SEND",				// kSend
+	"STOMP",			// kStomp
+	"SUBSCRIBE",		// kSubscribe
+	"UNSUBSCRIBE",		// kUnsubscribe
+	"UNKNOWN COMMAND",	// kUnknown
+}};
+static_assert(gStompCommands.IsPerfect());
+static_assert(gStompCommands.Find("CONNECTED") == StompCommand::kConnected);
+static_assert(gStompCommands.Find("CONNECTX") == StompCommand::kUnknown);
+
+std::string_view NetworkMonitor::ToString(const StompCommand& command) {
+	return gStompCommands.GetName(command);
 }
 
 std::ostream& NetworkMonitor::operator<<(std::ostream& out, const StompCommand& command) {
@@ -95,37 +178,37 @@ std::ostream& NetworkMonitor::operator<<(std::ostream& out, const StompCommand&
 
 // StompHeader
 
-static const auto gStompHeaders = MakeBimap<StompHeader, std::string_view>(
-{
-	{StompHeader::kAcceptVersion, "accept-version"},
-	{StompHeader::kAck          , "ack"           },
-	{StompHeader::kContentLength, "content-length"},
-	{StompHeader::kContentType  , "content-type"  },
-	{StompHeader::kDestination  , "destination"   },
-	{StompHeader::kHeartBeat    , "heart-beat"    },
-	{StompHeader::kHost         , "host"          },
-	{StompHeader::kId           , "id"            },
-	{StompHeader::kLogin        , "login"         },
-	{StompHeader::kMessage      , "message"       },
-	{StompHeader::kMessageId    , "message-id"    },
-	{StompHeader::kPasscode     , "passcode"      },
-	{StompHeader::kReceipt      , "receipt"       },
-	{StompHeader::kReceiptId    , "receipt-id"    },
-	{StompHeader::kSession      , "session"       },
-	{StompHeader::kSubscription , "subscription"  },
-	{StompHeader::kTransaction  , "transaction"   },
-	{StompHeader::kServer       , "server"        },
-	{StompHeader::kVersion      , "version"       },
-	{StompHeader::kUnknown      , "unknown header"}
-});
-
-std::string NetworkMonitor::ToString(const StompHeader& header) {
-	auto headerIt {gStompHeaders.left.find(header)};
-	if (headerIt == gStompHeaders.left.end()) {
-		return ToString(StompHeader::kUnknown);
-	}
-
-	return std::string(headerIt->second);
+static constexpr NameLookup<
+	StompHeader,
+	static_cast<size_t>(StompHeader::kUnknown)
+> gStompHeaders {{
+	"accept-version",	// kAcceptVersion
+	"ack",				// kAck
+	"content-length",	// kContentLength
+	"content-type",		// kContentType
+	"destination",		// kDestination
+	"heart-beat",		// kHeartBeat
+	"host",				// kHost
+	"id",				// kId
+	"login",			// kLogin
+	"message",			// kMessage
+	"message-id",		// kMessageId
+	"passcode",			// kPasscode
+	"receipt",			// kReceipt
+	"receipt-id",		// kReceiptId
+	"session",			// kSession
+	"subscription",		// kSubscription
+	"transaction",		// kTransaction
+	"server",			// kServer
+	"version",			// kVersion
+	"unknown header",	// kUnknown
+}};
+static_assert(gStompHeaders.IsPerfect());
+static_assert(gStompHeaders.Find("content-type") == StompHeader::kContentType);
+static_assert(gStompHeaders.Find("content-typo") == StompHeader::kUnknown);
+
+std::string_view NetworkMonitor::ToString(const StompHeader& header) {
+	return gStompHeaders.GetName(header);
 }
 
 std::ostream& NetworkMonitor::operator<<(std::ostream& out, const StompHeader& header) {
@@ -134,36 +217,244 @@ std::ostream& NetworkMonitor::operator<<(std::ostream& out, const StompHeader& h
 
 // StompError
 
-auto gStompErrors = MakeBimap<StompError, std::string_view>(
+static constexpr std::array<
+	std::string_view,
+	static_cast<size_t>(StompError::kErrorUnknown) + 1
+> gStompErrors {
+	"StompError::kOk",
+	"StompError::kErrorCommandInvalid",
+	"StompError::kErrorHeaderMissing",
+	"StompError::kErrorHeaderEmpty",
+	"StompError::kErrorHeaderMissingNewLine",
+	"StompError::kErrorHeaderInvalidKey",
+	"StompError::kErrorHeaderEmptyValue",
+	"StompError::kErrorHeaderMissingSemicolon",
+	"StompError::kErrorHeaderContentLength",
+	"StompError::kErrorBodyNoNewLine",
+	"StompError::kErrorBodyEmpty",
+	"StompError::kErrorBodyLength",
+	"StompError::kErrorBodyMissingNull",
+	"StompError::kErrorSymbolAfterBody",
+	"StompError::kErrorUnknown",
+};
+
+std::string_view NetworkMonitor::ToString(const StompError& error) {
+	const auto idx {static_cast<size_t>(error)};
+	return gStompErrors[idx < gStompErrors.size() ? idx : gStompErrors.size() - 1];
+}
+
+std::ostream& NetworkMonitor::operator<<(std::ostream& out, const StompError& error) {
+    return out << ToString(error);
+}
+
+// Frame parsing, shared by StompFrame and BufferedStompFrame
+
+constexpr size_t kHeaderCount {static_cast<size_t>(StompHeader::kUnknown)};
+
+// Header values are views into the parsed frame, indexed by header.
+using HeaderValues = std::array<std::string_view, kHeaderCount>;
+
+struct ParsedFrame {
+	StompCommand		command {StompCommand::kUnknown};
+	HeaderValues		headers {};
+	uint32_t			headerMask {0};
+	std::string_view	body {};
+};
+
+static_assert(kHeaderCount <= 32, "Header masks are 32-bit");
+
+// Headers required by each command, indexed by command.
+static constexpr std::array<uint32_t, static_cast<size_t>(StompCommand::kUnknown)>
+	gRequiredHeaders {
+	// kAbort
+	GetHeaderBit(StompHeader::kTransaction),
+	// kAck
+	GetHeaderBit(StompHeader::kId),
+	// kBegin
+	GetHeaderBit(StompHeader::kTransaction),
+	// kCommit
+	GetHeaderBit(StompHeader::kTransaction),
+	// kConnect
+	GetHeaderBit(StompHeader::kAcceptVersion) | GetHeaderBit(StompHeader::kHost),
+	// kConnected
+	GetHeaderBit(StompHeader::kVersion),
+	// kDisconnect
+	0,
+	// kError
+	0,
+	// kMessage
+	GetHeaderBit(StompHeader::kDestination)
+		| GetHeaderBit(StompHeader::kMessageId)
+		| GetHeaderBit(StompHeader::kSubscription),
+	// kNack
+	GetHeaderBit(StompHeader::kId),
+	// kReceipt
+	GetHeaderBit(StompHeader::kReceiptId),
+	// kSend
+	GetHeaderBit(StompHeader::kDestination),
+	// kStomp
+	GetHeaderBit(StompHeader::kAcceptVersion) | GetHeaderBit(StompHeader::kHost),
+	// kSubscribe
+	GetHeaderBit(StompHeader::kDestination) | GetHeaderBit(StompHeader::kId),
+	// kUnsubscribe
+	GetHeaderBit(StompHeader::kId),
+};
+
+static StompError ValidateFrame(const ParsedFrame& parsed)
+{
+    const auto command {static_cast<size_t>(parsed.command)};
+    if (command >= gRequiredHeaders.size()) {
+        return StompError::kErrorUnknown;
+    }
+    const auto required {gRequiredHeaders[command]};
+    if ((parsed.headerMask & required) != required) {
+        return StompError::kErrorHeaderMissing;
+    }
+
+    return StompError::kOk;
+}
+
+// Frame delimiters
+static constexpr char null {'\0'};
+static constexpr char colon {':'};
+static constexpr char newLine {'\n'};
+
+static bool ParseContentLength(
+	const std::string_view value,
+	size_t& length
+)
+{
+	// https://stackoverflow.com/questions/56634507/safely-convert-stdstring-view-to-int-like-stoi-or-atoi
+	const auto* last {value.data() + value.size()};
+	const auto result {std::from_chars(value.data(), last, length)};
+	return result.ec == std::errc {} && result.ptr == last;
+}
+
+// Parse the command and the headers, up to the empty line that ends them.
+// `bodyStart` is the offset of the byte after that line.
+static StompError ParseHeaders(
+	const std::string_view frame,
+	ParsedFrame& parsed,
+	size_t& bodyStart
+)
 {
-	{StompError::kOk							, "StompError::kOk"},
-	{StompError::kErrorCommandInvalid			, "StompError::kErrorCommandInvalid"},
-	{StompError::kErrorHeaderMissing			, "StompError::kErrorHeaderMissing"},
-	{StompError::kErrorHeaderEmpty				, "StompError::kErrorHeaderEmpty"},
-	{StompError::kErrorHeaderMissingNewLine		, "StompError::kErrorHeaderMissingNewLine"},
-	{StompError::kErrorHeaderInvalidKey			, "StompError::kErrorHeaderInvalidKey"},
-	{StompError::kErrorHeaderEmptyValue			, "StompError::kErrorHeaderEmptyValue"},
-	{StompError::kErrorHeaderMissingSemicolon	, "StompError::kErrorHeaderMissingSemicolon"},
-	{StompError::kErrorHeaderContentLength		, "StompError::kErrorHeaderContentLength"},
-	{StompError::kErrorBodyNoNewLine			, "StompError::kErrorBodyNoNewLine"},
-	{StompError::kErrorBodyEmpty				, "StompError::kErrorBodyEmpty"},
-	{StompError::kErrorBodyLength				, "StompError::kErrorBodyLength"},
-	{StompError::kErrorBodyMissingNull			, "StompError::kErrorBodyMissingNull"},
-	{StompError::kErrorWrongSymbolAfterBody		, "StompError::kErrorSymbolAfterBody"},
-	{StompError::kErrorUnknown					, "StompError::kErrorUnknown"}
-});
-
-std::string NetworkMonitor::ToString(const StompError& error) {
-	auto errorIt {gStompErrors.left.find(error)};
-	if (errorIt == gStompErrors.left.end()) {
-		return ToString(StompError::kErrorUnknown);
+
+	// Command and header lines are split in a single pass over the frame.
+	DelimiterScanner<newLine, colon> lines {frame};
+
+	// Parse Command
+	size_t commandEnd {lines.Next()};
+	while (commandEnd < frame.size() && frame[commandEnd] != newLine) {
+		commandEnd = lines.Next();
 	}
+	if (commandEnd == frame.size()) {
+		return StompError::kErrorHeaderEmpty;
+	}
+	std::string_view command_v {frame.substr(0, commandEnd)};
+
+	parsed.command = gStompCommands.Find(command_v);
+	if (parsed.command == StompCommand::kUnknown) {
+		return StompError::kErrorCommandInvalid;
+	}
+
+	// Parse Headers
+	auto& headers {parsed.headers};
+	size_t headerStart {commandEnd + 1};
+	while (headerStart < frame.size() && frame[headerStart] != newLine) {
+
+		// The first colon of the line separates the key from the value.
+		size_t headerDelim {frame.size()};
+		size_t headerEnd {lines.Next()};
+		while (headerEnd < frame.size() && frame[headerEnd] == colon) {
+			if (headerDelim == frame.size()) {
+				headerDelim = headerEnd;
+			}
+			headerEnd = lines.Next();
+		}
+		if (headerEnd == frame.size()) {
+			return StompError::kErrorHeaderMissingNewLine;
+		}
+		if (headerDelim == frame.size()) {
+			return StompError::kErrorHeaderMissingSemicolon;
+		}
+		if (headerDelim + 1 == headerEnd) {
+			return StompError::kErrorHeaderEmptyValue;
+		}
 
-	return std::string(errorIt->second);
+		std::string_view headerKey_v {
+			frame.substr(headerStart, headerDelim - headerStart)
+		};
+		const auto header {gStompHeaders.Find(headerKey_v)};
+		if (header == StompHeader::kUnknown) {
+			return StompError::kErrorHeaderInvalidKey;
+		}
+
+		// Only the first occurrence of a repeated header counts.
+		const auto headerBit {GetHeaderBit(header)};
+		if ((parsed.headerMask & headerBit) == 0) {
+			headers[static_cast<size_t>(header)] =
+				frame.substr(headerDelim + 1, headerEnd - headerDelim - 1);
+			parsed.headerMask |= headerBit;
+		}
+		
+		headerStart = headerEnd + 1;	
+	}
+	if (headerStart >= frame.length() || frame[headerStart] != newLine) {
+		return StompError::kErrorBodyNoNewLine;
+	}
+	bodyStart = headerStart + 1;
+
+	return StompError::kOk;
 }
 
-std::ostream& NetworkMonitor::operator<<(std::ostream& out, const StompError& error) {
-    return out << ToString(error);
+static StompError ParseFrame(
+	const std::string_view frame,
+	ParsedFrame& parsed
+)
+{
+	size_t bodyStart {0};
+	const auto ec {ParseHeaders(frame, parsed, bodyStart)};
+	if (ec != StompError::kOk) {
+		return ec;
+	}
+
+	//Parse Body
+	size_t bodyLength {0};
+	size_t bodyEnd {0};
+
+	if (parsed.headerMask & GetHeaderBit(StompHeader::kContentLength)) {
+		const auto contentLength {
+			parsed.headers[static_cast<size_t>(StompHeader::kContentLength)]
+		};
+		if (!ParseContentLength(contentLength, bodyLength)) {
+			return StompError::kErrorHeaderContentLength;
+		}
+        if (bodyLength == (frame.size() - bodyStart)) {
+            return StompError::kErrorBodyMissingNull;
+        }
+        if (bodyLength > (frame.size() - bodyStart)) {
+            return StompError::kErrorBodyLength;
+        }
+        bodyEnd = bodyStart + bodyLength;
+        if (frame[bodyEnd] != null) {
+            return StompError::kErrorBodyMissingNull;
+        }	
+	}
+	else {
+		// The C library's memchr is already vectorized, with the best
+		// instruction set picked at run time.
+		bodyEnd = frame.find(null, bodyStart);
+        if (bodyEnd == std::string::npos) {
+            return StompError::kErrorBodyMissingNull;
+        }
+        bodyLength = bodyEnd - bodyStart;
+	}
+    if (frame.find_first_not_of(newLine, bodyEnd + 1) != std::string::npos) {
+        return StompError::kErrorWrongSymbolAfterBody;
+    }
+    parsed.body = frame.substr(bodyStart, bodyLength);
+
+	return ValidateFrame(parsed);
 }
 
 // StompFrame 
@@ -191,8 +482,18 @@ StompFrame::StompFrame(
     const std::string& body
 )
 {
+	HeaderValues values {};
+	uint32_t headerMask {0};
+	for (const auto& [header, value]: headers) {
+		if (static_cast<size_t>(header) >= kHeaderCount) {
+			ec = StompError::kErrorHeaderInvalidKey;
+			return;
+		}
+		values[static_cast<size_t>(header)] = value;
+		headerMask |= GetHeaderBit(header);
+	}
     ec = ParseAndValidateFrame(
-		ConstructFrame(command, headers, body)
+		ConstructFrame(command, values, headerMask, body)
 	);
 }
 
@@ -209,7 +510,12 @@ StompCommand StompFrame::GetCommand() const {
 }
 
 std::string_view StompFrame::GetHeaderValue(const StompHeader header) const {
-	return ::GetHeaderValue(m_headers, header);
+	if (static_cast<size_t>(header) >= kHeaderCount
+		|| (m_headerMask & GetHeaderBit(header)) == 0) {
+		return {};
+	}
+
+	return m_headers[static_cast<size_t>(header)];
 }
 
 std::string_view StompFrame::GetBody() const {
@@ -221,183 +527,160 @@ std::string StompFrame::ToString() const
 	return ConstructFrame(
 		m_command, 
 		m_headers, 
-		std::string {m_body}
+		m_headerMask,
+		m_body
 	);
 }
 
 StompError StompFrame::ParseAndValidateFrame(const std::string_view frame) {
-	// Frame delimiters
-    static const char null {'\0'};
-    static const char colon {':'};
-    static const char newLine {'\n'};
-
-	// Parse Command
-	size_t commandEnd {frame.find(newLine)};
-	if (commandEnd == std::string::npos) {
-		return StompError::kErrorHeaderEmpty;
+	ParsedFrame parsed {};
+	auto ec {ParseFrame(frame, parsed)};
+	if (ec != StompError::kOk) {
+		return ec;
 	}
-	std::string_view command_v {&frame[0], commandEnd};
 
-	auto commandIt {gStompCommands.right.find(command_v)};
-	if (commandIt == gStompCommands.right.end()) {
-		return StompError::kErrorCommandInvalid;
+	// Copy all data
+	m_command = parsed.command;
+	for (size_t idx {0}; idx < kHeaderCount; ++idx) {
+		m_headers[idx] = parsed.headers[idx];
 	}
-	auto command = commandIt->second;
+	m_headerMask = parsed.headerMask;
+	m_body = std::string {parsed.body};
 
-	// Parse Headers
-	Headers headers {};
-	size_t headerStart = command_v.length() + 1;
-	while (headerStart < frame.length() && frame.at(headerStart) != newLine) {
+	return StompError::kOk;
+}
 
-		size_t headerEnd {frame.find(newLine, headerStart)};
-		if (headerEnd == std::string::npos) {
-			return StompError::kErrorHeaderMissingNewLine;
-		}
-		std::string_view header_v {&frame[headerStart], headerEnd - headerStart};
-	
-		size_t header_vDelim = header_v.find(colon);
-		if (header_vDelim == std::string::npos) {
-			return StompError::kErrorHeaderMissingSemicolon;
-		}
-		if (header_vDelim + 1 == headerEnd - headerStart) {
-			return StompError::kErrorHeaderEmptyValue;
-		}
+// BufferedStompFrame
 
-		std::string_view headerKey_v {&header_v[0], header_vDelim};
-		auto headerIt {gStompHeaders.right.find(headerKey_v)};
-		if (headerIt == gStompHeaders.right.end()) {
-			return StompError::kErrorHeaderInvalidKey;
-		}
-		if (headers.find(headerIt->second) == headers.end()) {
-			headers.emplace(std::make_pair(
-				headerIt->second,
-				std::move(std::string{header_v.substr(header_vDelim + 1)}))
-			);
-		}
-		
-		headerStart = headerEnd + 1;	
-	}
-	if (headerStart >= frame.length() || frame.at(headerStart) != newLine) {
-		return StompError::kErrorBodyNoNewLine;
+BufferedStompFrame::BufferedStompFrame() = default;
+
+BufferedStompFrame::BufferedStompFrame(
+	StompError& ec,
+	std::string&& frame
+)
+{
+	// The spans hold 32-bit offsets.
+	if (frame.size() > std::numeric_limits<uint32_t>::max()) {
+		ec = StompError::kErrorBodyLength;
+		return;
 	}
 
-	//Parse Body
-	size_t bodyStart {headerStart + 1};
-	size_t bodyLength {0};
-	size_t bodyEnd {0};
+	ParsedFrame parsed {};
+	ec = ParseFrame(frame, parsed);
+	if (ec != StompError::kOk) {
+		return;
+	}
 
-	auto contentLengthIt {headers.find(StompHeader::kContentLength)};
-	if (contentLengthIt != headers.end()) {
+	Assign(
+		std::move(frame),
+		parsed.command,
+		parsed.headers,
+		parsed.headerMask,
+		parsed.body
+	);
+}
 
-		bodyLength = std::stoi(contentLengthIt->second);
-        if (bodyLength == (frame.size() - bodyStart)) {
-            return StompError::kErrorBodyMissingNull;
-        }
-        if (bodyLength > (frame.size() - bodyStart)) {
-            return StompError::kErrorBodyLength;
-        }
-        bodyEnd = bodyStart + bodyLength;
-        if (frame.at(bodyEnd) != null) {
-            return StompError::kErrorBodyMissingNull;
-        }	
+BufferedStompFrame::BufferedStompFrame(
+	StompError& ec,
+	std::string&& frame,
+	const size_t bodyStart,
+	const size_t bodyLength
+)
+{
+	if (frame.size() > std::numeric_limits<uint32_t>::max()) {
+		ec = StompError::kErrorBodyLength;
+		return;
 	}
-	else {
-		bodyEnd = frame.find(null, bodyStart);
-        if (bodyEnd == std::string::npos) {
-            return StompError::kErrorBodyMissingNull;
-        }
-        bodyLength = bodyEnd - bodyStart;
+
+	// The body and the NUL byte after it were already checked: only the
+	// command and the headers are left to parse.
+	ParsedFrame parsed {};
+	size_t headersEnd {0};
+	ec = ParseHeaders(
+		std::string_view {frame}.substr(0, bodyStart),
+		parsed,
+		headersEnd
+	);
+	if (ec != StompError::kOk) {
+		return;
 	}
-    for (size_t idx {bodyEnd + 1}; idx < frame.size(); ++idx) {
-        if (frame.at(idx) != newLine) {
-            return StompError::kErrorWrongSymbolAfterBody;
-        }
-    }
-    std::string body {frame.substr(bodyStart, bodyLength)};
 
-	auto ec {ValidateFrame(command, headers, body)};
+	// The parser framed the body at the first NUL; an unparsable
+	// content-length still makes the frame invalid.
+	size_t contentLength {0};
+	if ((parsed.headerMask & GetHeaderBit(StompHeader::kContentLength))
+		&& !ParseContentLength(
+			parsed.headers[static_cast<size_t>(StompHeader::kContentLength)],
+			contentLength
+		)) {
+		ec = StompError::kErrorHeaderContentLength;
+		return;
+	}
+	parsed.body = std::string_view {frame}.substr(bodyStart, bodyLength);
+	ec = ValidateFrame(parsed);
 	if (ec != StompError::kOk) {
-		return ec;
+		return;
 	}
 
-	// Move all data
-	m_command = std::move(command);
-	m_headers = std::move(headers);
-	m_body = std::move(body);
+	Assign(
+		std::move(frame),
+		parsed.command,
+		parsed.headers,
+		parsed.headerMask,
+		parsed.body
+	);
+}
 
-	return StompError::kOk;
+StompCommand BufferedStompFrame::GetCommand() const
+{
+	return m_command;
 }
 
-StompError StompFrame::ValidateFrame(	
-	const StompCommand& command,
-    const Headers& 		headers, 
-    const std::string& 	body
+std::string_view BufferedStompFrame::GetHeaderValue(
+	const StompHeader header
 ) const
 {
-    bool hasAllHeaders {true};
-    switch (command) {
-        case StompCommand::kConnect:
-        case StompCommand::kStomp:
-            hasAllHeaders &= HasHeader(headers, StompHeader::kAcceptVersion);
-            hasAllHeaders &= HasHeader(headers, StompHeader::kHost);
-            break;
-        case StompCommand::kConnected:
-            hasAllHeaders &= HasHeader(headers, StompHeader::kVersion);
-            break;
-        case StompCommand::kSend:
-            hasAllHeaders &= HasHeader(headers, StompHeader::kDestination);
-            break;
-        case StompCommand::kSubscribe:
-            hasAllHeaders &= HasHeader(headers, StompHeader::kDestination);
-            hasAllHeaders &= HasHeader(headers, StompHeader::kId);
-            break;
-        case StompCommand::kUnsubscribe:
-            hasAllHeaders &= HasHeader(headers, StompHeader::kId);
-            break;
-        case StompCommand::kAck:
-        case StompCommand::kNack:
-            hasAllHeaders &= HasHeader(headers, StompHeader::kId);
-            break;
-        case StompCommand::kBegin:
-        case StompCommand::kCommit:
-        case StompCommand::kAbort:
-            hasAllHeaders &= HasHeader(headers, StompHeader::kTransaction);
-            break;
-        case StompCommand::kDisconnect:
-            break;
-        case StompCommand::kMessage:
-            hasAllHeaders &= HasHeader(headers, StompHeader::kDestination);
-            hasAllHeaders &= HasHeader(headers, StompHeader::kMessageId);
-            hasAllHeaders &= HasHeader(headers, StompHeader::kSubscription);
-            break;
-        case StompCommand::kReceipt:
-            hasAllHeaders &= HasHeader(headers, StompHeader::kReceiptId);
-            break;
-        case StompCommand::kError:
-            break;
-        default:
-            return StompError::kErrorUnknown;
-    }
-    if (!hasAllHeaders) {
-        return StompError::kErrorHeaderMissing;
-    }
+	if (static_cast<size_t>(header) >= kHeaderCount
+		|| (m_headerMask & GetHeaderBit(header)) == 0) {
+		return {};
+	}
 
-    if (HasHeader(headers, StompHeader::kContentLength)) {
-		// https://stackoverflow.com/questions/56634507/safely-convert-stdstring-view-to-int-like-stoi-or-atoi
-		auto contentLength {::GetHeaderValue(headers, StompHeader::kContentLength)};
-		size_t bodyLength {0};
-		auto result = std::from_chars(
-			contentLength.data(), 
-			contentLength.data() + contentLength.size(), 
-			bodyLength
-		);
-    	if (result.ec == std::errc::invalid_argument) {
-        	return StompError::kErrorHeaderContentLength;
-    	}
-        if (bodyLength != body.length()) {
-            return StompError::kErrorBodyLength;
-        }
+	return GetView(m_headers[static_cast<size_t>(header)]);
+}
+
+std::string_view BufferedStompFrame::GetBody() const
+{
+	return GetView(m_body);
+}
+
+void BufferedStompFrame::Assign(
+	std::string&& frame,
+	const StompCommand command,
+	const HeaderViews& headers,
+	const uint32_t headerMask,
+	const std::string_view body
+)
+{
+	auto getSpan {[&frame](const std::string_view view) {
+		return Span {
+			static_cast<uint32_t>(view.data() - frame.data()),
+			static_cast<uint32_t>(view.size())
+		};
+	}};
+	m_command = command;
+	for (size_t idx {0}; idx < kHeaderCount; ++idx) {
+		if (headerMask & (uint32_t {1} << idx)) {
+			m_headers[idx] = getSpan(headers[idx]);
+		}
 	}
+	m_headerMask = headerMask;
+	m_body = getSpan(body);
+	m_frame = std::move(frame);
+}
 
-    return StompError::kOk;
-}
\ No newline at end of file
+std::string_view BufferedStompFrame::GetView(
+	const Span span
+) const
+{
+	return std::string_view {m_frame}.substr(span.offset, span.length);
+}
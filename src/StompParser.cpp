@@ -0,0 +1,200 @@
+#include "network-monitor/StompParser.h"
+
+#include <charconv>
+#include <utility>
+
+using NetworkMonitor::BufferedStompFrame;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompParser;
+
+StompParser::StompParser(
+	FrameHandler onFrame,
+	const size_t maxFrameSize
+) : m_onFrame {std::move(onFrame)},
+	m_maxFrameSize {maxFrameSize}
+{
+}
+
+void StompParser::Push(
+	const std::string_view chunk
+)
+{
+	// Only the incomplete frame at the end of the chunk is buffered.
+	size_t incompleteSize {0};
+	if (m_buffer.empty()) {
+		const auto rest {Parse(chunk)};
+		incompleteSize = chunk.size() - rest;
+		if (incompleteSize <= m_maxFrameSize) {
+			m_buffer.assign(chunk.substr(rest));
+		}
+	} else {
+		m_buffer.append(chunk);
+		const auto rest {Parse(m_buffer)};
+		m_buffer.erase(0, rest);
+		incompleteSize = m_buffer.size();
+	}
+
+	// The rest of a frame that is too large is dropped as it arrives.
+	if (incompleteSize > m_maxFrameSize) {
+		m_buffer.clear();
+		m_state = State::kSkipping;
+		m_scanned = 0;
+		OnError(StompError::kErrorBodyLength);
+	}
+}
+
+void StompParser::Reset()
+{
+	m_buffer.clear();
+	m_state = State::kBetweenFrames;
+	m_scanned = 0;
+	m_lineStart = 0;
+	m_bodyStart = 0;
+	m_hasContentLength = false;
+	m_isValidContentLength = false;
+	m_contentLength = 0;
+}
+
+size_t StompParser::GetBufferedSize() const
+{
+	return m_buffer.size();
+}
+
+// Private functions
+
+size_t StompParser::Parse(
+	const std::string_view data
+)
+{
+	static constexpr std::string_view contentLengthKey {"content-length:"};
+
+	// Offsets are relative to the start of `data` while parsing, and to the
+	// start of the incomplete frame between calls.
+	size_t frameStart {0};
+	auto keepFrame {[this, &frameStart, &data]() {
+		m_scanned = data.size() - frameStart;
+		m_lineStart -= frameStart;
+		m_bodyStart -= frameStart;
+		return frameStart;
+	}};
+	for (;;) {
+		if (m_state == State::kSkipping) {
+			const auto null {data.find('\0', m_scanned)};
+			if (null == std::string_view::npos) {
+				m_scanned = 0;
+				return data.size();
+			}
+			m_state = State::kBetweenFrames;
+			m_scanned = null + 1;
+		}
+
+		if (m_state == State::kBetweenFrames) {
+			// Skip the heart-beats.
+			frameStart = data.find_first_not_of("\r\n", m_scanned);
+			if (frameStart == std::string_view::npos) {
+				m_scanned = 0;
+				return data.size();
+			}
+			m_state = State::kHeaders;
+			m_scanned = frameStart;
+			m_lineStart = frameStart;
+			m_hasContentLength = false;
+			m_isValidContentLength = false;
+		}
+
+		// The command line is never empty, so the first empty line ends the
+		// headers. A line with only a carriage return ends them too: frames
+		// with CRLF line endings are not supported, but they are reported as
+		// soon as their body ends instead of being buffered indefinitely.
+		while (m_state == State::kHeaders) {
+			const auto lineEnd {data.find('\n', m_scanned)};
+			if (lineEnd == std::string_view::npos) {
+				return keepFrame();
+			}
+			const auto line {data.substr(m_lineStart, lineEnd - m_lineStart)};
+			m_scanned = lineEnd + 1;
+			m_lineStart = lineEnd + 1;
+			if (line.empty() || line == "\r") {
+				m_state = State::kBody;
+				m_bodyStart = lineEnd + 1;
+				break;
+			}
+			if (!m_hasContentLength
+				&& line.substr(0, contentLengthKey.size()) == contentLengthKey) {
+				const auto value {line.substr(contentLengthKey.size())};
+				const auto* last {value.data() + value.size()};
+				const auto result {
+					std::from_chars(value.data(), last, m_contentLength)
+				};
+				m_hasContentLength = true;
+				m_isValidContentLength = result.ec == std::errc {}
+					&& result.ptr == last;
+			}
+		}
+
+		// The frame ends with the NUL byte after the body.
+		size_t frameEnd {0};
+		if (m_isValidContentLength) {
+			if (data.size() - m_bodyStart <= m_contentLength) {
+				return keepFrame();
+			}
+			frameEnd = m_bodyStart + m_contentLength + 1;
+
+			// The content-length is wrong: the end of the frame is not known,
+			// so the parser resynchronizes at the next NUL byte.
+			if (data[frameEnd - 1] != '\0') {
+				OnError(StompError::kErrorBodyMissingNull);
+				m_state = State::kSkipping;
+				m_scanned = frameEnd - 1;
+				continue;
+			}
+		} else {
+			const auto null {data.find('\0', m_scanned)};
+			if (null == std::string_view::npos) {
+				return keepFrame();
+			}
+			frameEnd = null + 1;
+		}
+
+		// A frame that fills the whole buffer takes it over instead of copying
+		// it. The bytes stay valid until the frame is destroyed, and nothing is
+		// read past frameEnd anyway.
+		const auto frame {data.substr(frameStart, frameEnd - frameStart)};
+		const auto bodyStart {m_bodyStart - frameStart};
+		if (frame.size() > m_maxFrameSize) {
+			OnError(StompError::kErrorBodyLength);
+		} else if (data.data() == m_buffer.data()
+			&& frame.size() == m_buffer.size()) {
+			OnFrame(std::move(m_buffer), bodyStart);
+			m_buffer.clear();
+		} else {
+			OnFrame(std::string {frame}, bodyStart);
+		}
+		m_state = State::kBetweenFrames;
+		m_scanned = frameEnd;
+	}
+}
+
+void StompParser::OnFrame(
+	std::string&& frame,
+	const size_t bodyStart
+)
+{
+	// The frame was split while scanning it: only its headers are left to
+	// parse.
+	const auto bodyLength {frame.size() - bodyStart - 1};
+	StompError error {};
+	BufferedStompFrame parsed {error, std::move(frame), bodyStart, bodyLength};
+	if (m_onFrame) {
+		m_onFrame(error, std::move(parsed));
+	}
+}
+
+void StompParser::OnError(
+	const StompError error
+)
+{
+	if (m_onFrame) {
+		m_onFrame(error, BufferedStompFrame {});
+	}
+}
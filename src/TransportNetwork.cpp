@@ -1,11 +1,827 @@
 #include "network-monitor/TransportNetwork.h"
 
+#include "SnapshotFormat.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+using NetworkMonitor::ContractionHierarchy;
 using NetworkMonitor::Id;
+using NetworkMonitor::Itinerary;
+using NetworkMonitor::ItineraryHandles;
 using NetworkMonitor::Line;
+using NetworkMonitor::NetworkLayout;
+using NetworkMonitor::LineHandle;
 using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::PassengerFlow;
+using NetworkMonitor::PassengerFlowRate;
 using NetworkMonitor::Route;
+using NetworkMonitor::RouteHandle;
 using NetworkMonitor::Station;
+using NetworkMonitor::StationHandle;
 using NetworkMonitor::TransportNetwork;
+using NetworkMonitor::TravelTime;
+
+namespace SnapshotFormat = NetworkMonitor::SnapshotFormat;
+
+namespace {
+
+// Scratch buffers for the shortest-path searches, reused across queries on the
+// same thread.
+//
+// The searches run on the edges of the network graph rather than on its
+// stations: reaching a station through a different line can change the cost of
+// the rest of the journey, due to the line change penalty. The search state
+// for edge `idx` is only valid if `stamps[idx]` is equal to `stamp`, so that
+// the buffers do not need to be cleared between queries.
+//
+// The travel suggestion search keeps the itineraries it found in `paths`, and
+// those it may return next in `candidates`. Only the first `nPaths` and
+// `nCandidates` items are in use, so that their edge vectors keep their
+// capacity across queries.
+struct SuggestionPath {
+	uint32_t				totalTime {0};
+	uint32_t				crowdingCost {0};
+	std::vector<uint32_t>	edges {};
+};
+
+struct PathSearchScratch {
+	std::vector<uint32_t>	costs {};
+	std::vector<uint32_t>	previous {};
+	std::vector<uint32_t>	stamps {};
+	uint32_t				stamp {0};
+	std::vector<std::pair<uint32_t, uint32_t>>	heap {};
+	std::vector<uint32_t>	pathEdges {};
+	std::vector<SuggestionPath>	paths {};
+	std::vector<SuggestionPath>	candidates {};
+	std::vector<uint32_t>	bannedEdges {};
+	std::vector<bool>		bannedStations {};
+
+	void Prepare(
+		const size_t nEdges
+	)
+	{
+		if (stamps.size() < nEdges) {
+			costs.resize(nEdges);
+			previous.resize(nEdges);
+			stamps.resize(nEdges, 0);
+		}
+		if (++stamp == 0) {
+			std::fill(stamps.begin(), stamps.end(), 0);
+			stamp = 1;
+		}
+		heap.clear();
+	}
+};
+
+thread_local PathSearchScratch gPathSearchScratch {};
+
+// Scratch buffers for RecordPassengerEvents, reused across batches on the same
+// thread. `deltas[idx]` is only valid if `stamps[idx]` is equal to `stamp`.
+struct PassengerEventScratch {
+	std::vector<int64_t>	deltas {};
+	std::vector<uint32_t>	stamps {};
+	uint32_t				stamp {0};
+	std::vector<uint32_t>	stations {};
+
+	void Prepare(
+		const size_t nStations
+	)
+	{
+		if (stamps.size() < nStations) {
+			deltas.resize(nStations);
+			stamps.resize(nStations, 0);
+		}
+		if (++stamp == 0) {
+			std::fill(stamps.begin(), stamps.end(), 0);
+			stamp = 1;
+		}
+		stations.clear();
+	}
+};
+
+thread_local PassengerEventScratch gPassengerEventScratch {};
+
+// Binary snapshots, see SnapshotFormat.h.
+class SnapshotWriter {
+public:
+	template <typename T>
+	void Write(
+		const T* items,
+		const size_t count
+	)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		const uint64_t nBytes {count * sizeof(T)};
+		m_payload.append(reinterpret_cast<const char*>(&nBytes), sizeof(nBytes));
+		if (nBytes > 0) {
+			m_payload.append(reinterpret_cast<const char*>(items), nBytes);
+		}
+		m_payload.resize((m_payload.size() + 7) & ~size_t {7}, '\0');
+	}
+
+	template <typename T>
+	void Write(
+		const std::vector<T>& items
+	)
+	{
+		Write(items.data(), items.size());
+	}
+
+	void Write(
+		const std::string& chars
+	)
+	{
+		Write(chars.data(), chars.size());
+	}
+
+	// Nested arrays are saved as their concatenated items and the offsets of
+	// each array in the concatenation.
+	template <typename T, typename GetArray>
+	void WriteArrays(
+		const std::vector<T>& items,
+		GetArray&& getArray
+	)
+	{
+		using Item = typename std::decay_t<
+			decltype(getArray(items.front()))
+		>::value_type;
+		std::vector<Item> values {};
+		std::vector<uint32_t> offsets {0};
+		for (const auto& item: items) {
+			const auto& array {getArray(item)};
+			values.insert(values.end(), array.begin(), array.end());
+			offsets.push_back(values.size());
+		}
+		Write(values);
+		Write(offsets);
+	}
+
+	// Names are saved as their concatenated characters and the offsets of
+	// each name in the concatenation.
+	template <typename Names>
+	void WriteNames(
+		const Names& names
+	)
+	{
+		std::string chars {};
+		std::vector<uint32_t> offsets {0};
+		offsets.reserve(names.Size() + 1);
+		for (uint32_t idx {0}; idx < names.Size(); ++idx) {
+			chars.append(names.Get(idx));
+			offsets.push_back(chars.size());
+		}
+		Write(chars);
+		Write(offsets);
+	}
+
+	// Flags are saved as one byte each.
+	void WriteFlags(
+		const std::vector<bool>& flags
+	)
+	{
+		Write(std::vector<uint8_t>(flags.begin(), flags.end()));
+	}
+
+	bool Save(
+		const std::filesystem::path& destination
+	) const
+	{
+		SnapshotFormat::Header header {};
+		std::memcpy(header.magic, SnapshotFormat::kMagic, sizeof(header.magic));
+		header.version = SnapshotFormat::kVersion;
+		header.byteOrder = SnapshotFormat::kByteOrder;
+		header.payloadSize = m_payload.size();
+		header.checksum = SnapshotFormat::GetChecksum(
+			m_payload.data(),
+			m_payload.size()
+		);
+
+		std::ofstream file {destination, std::ios::binary | std::ios::trunc};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(m_payload.data(), m_payload.size());
+		file.close();
+		return !file.fail();
+	}
+
+private:
+	std::string	m_payload {};
+};
+
+// Reads a whole snapshot file in memory, then copies its sections out.
+class SnapshotReader {
+public:
+	bool Open(
+		const std::filesystem::path& source
+	)
+	{
+		std::error_code error {};
+		const auto fileSize {std::filesystem::file_size(source, error)};
+		std::ifstream file {source, std::ios::binary};
+		SnapshotFormat::Header header {};
+		if (error
+			|| !file.read(reinterpret_cast<char*>(&header), sizeof(header))
+			|| !SnapshotFormat::IsValidHeader(header, fileSize)) {
+			return false;
+		}
+
+		m_payload.resize(header.payloadSize);
+		if (!file.read(m_payload.data(), m_payload.size())
+			|| header.checksum != SnapshotFormat::GetChecksum(
+				m_payload.data(),
+				m_payload.size()
+			)) {
+			return false;
+		}
+		m_sections = {m_payload.data(), m_payload.size()};
+		return true;
+	}
+
+	template <typename Container>
+	bool Read(
+		Container& items
+	)
+	{
+		const typename Container::value_type* first {nullptr};
+		size_t count {0};
+		if (!m_sections.Next(first, count)) {
+			return false;
+		}
+		items.assign(first, first + count);
+		return true;
+	}
+
+	// Names are saved as their concatenated characters and the offsets of
+	// each name in the concatenation. There is one item per name.
+	template <typename T, typename Names>
+	bool ReadNames(
+		std::vector<T>& items,
+		Names& names
+	)
+	{
+		std::vector<uint32_t> offsets {};
+		if (!Read(names.chars)
+			|| !Read(offsets)
+			|| !IsValidOffsets(offsets, names.chars.size())) {
+			return false;
+		}
+		names.ranges.clear();
+		names.ranges.reserve(offsets.size() - 1);
+		for (size_t idx {0}; idx + 1 < offsets.size(); ++idx) {
+			names.ranges.emplace_back(offsets[idx], offsets[idx + 1]);
+		}
+		items.resize(names.ranges.size());
+		return true;
+	}
+
+	bool ReadFlags(
+		std::vector<bool>& flags,
+		const size_t count
+	)
+	{
+		std::vector<uint8_t> bytes {};
+		if (!Read(bytes) || bytes.size() != count) {
+			return false;
+		}
+		flags.assign(bytes.begin(), bytes.end());
+		return true;
+	}
+
+	template <typename T, typename Item, typename SetArray>
+	bool ReadArrays(
+		std::vector<T>& items,
+		std::vector<Item>& values,
+		SetArray&& setArray
+	)
+	{
+		std::vector<uint32_t> offsets {};
+		if (!Read(values)
+			|| !Read(offsets)
+			|| !IsValidOffsets(offsets, values.size())
+			|| offsets.size() != items.size() + 1) {
+			return false;
+		}
+		for (size_t idx {0}; idx < items.size(); ++idx) {
+			setArray(
+				items[idx],
+				values.begin() + offsets[idx],
+				values.begin() + offsets[idx + 1]
+			);
+		}
+		return true;
+	}
+
+	bool AtEnd() const
+	{
+		return m_sections.AtEnd();
+	}
+
+	static bool IsValidOffsets(
+		const std::vector<uint32_t>& offsets,
+		const size_t size
+	)
+	{
+		return SnapshotFormat::IsValidOffsets(
+			offsets.data(),
+			offsets.size(),
+			size
+		);
+	}
+
+private:
+	std::string						m_payload {};
+	SnapshotFormat::SectionCursor	m_sections {};
+};
+
+// Builds a TransportNetwork from the events of a SAX JSON parser.
+//
+// The handler keeps track of the path to the current value with the key of
+// each open object, indexed by nesting depth. Values nested deeper than a
+// route stop are never read, so only their depth is counted. Items are added to the network
+// as soon as their object closes, unless they refer to sections that were not
+// parsed yet.
+class NetworkJsonHandler: public nlohmann::json_sax<nlohmann::json> {
+public:
+	explicit NetworkJsonHandler(
+		TransportNetwork& network
+	) : m_network {network}
+	{
+	}
+
+	// Add the items that were kept for later, once the whole document is
+	// parsed.
+	bool Finish()
+	{
+		if (!m_done[kStations] || !m_done[kLines] || !m_done[kTravelTimes]) {
+			throw std::runtime_error("Missing network layout section");
+		}
+		for (const auto& line: m_pendingLines) {
+			AddLine(line);
+		}
+		for (const auto& travelTime: m_pendingTravelTimes) {
+			SetTravelTime(travelTime);
+		}
+		return m_ok;
+	}
+
+	bool null() override
+	{
+		return true;
+	}
+
+	bool boolean(bool) override
+	{
+		return true;
+	}
+
+	bool number_integer(number_integer_t value) override
+	{
+		if (value < 0 && IsItemField(kTravelTimes, Key::TravelTime)) {
+			throw std::runtime_error("Negative travel time");
+		}
+		return true;
+	}
+
+	bool number_unsigned(number_unsigned_t value) override
+	{
+		if (IsItemField(kTravelTimes, Key::TravelTime)) {
+			m_travelTime.travelTime = static_cast<uint32_t>(value);
+			m_fields |= FieldBit(Key::TravelTime);
+		}
+		return true;
+	}
+
+	bool number_float(number_float_t, const string_t&) override
+	{
+		return true;
+	}
+
+	bool string(string_t& value) override
+	{
+		if (m_depth == kItemDepth) {
+			SetItemField(GetKey(kItemDepth), std::move(value));
+		} else if (m_depth == kRouteDepth && IsInRoutes()) {
+			SetRouteField(GetKey(kRouteDepth), std::move(value));
+		} else if (m_depth == kRouteDepth + 1 && IsInRoutes()
+			&& GetKey(kRouteDepth) == Key::RouteStops) {
+			m_route.stops.emplace_back(std::move(value));
+		}
+		return true;
+	}
+
+	bool binary(binary_t&) override
+	{
+		return true;
+	}
+
+	bool start_object(std::size_t) override
+	{
+		if (!Push()) {
+			return true;
+		}
+		if (m_depth == kItemDepth) {
+			m_fields = 0;
+			m_station = {};
+			m_line = {};
+			m_travelTime = {};
+		} else if (m_depth == kRouteDepth && IsInRoutes()) {
+			m_routeFields = 0;
+			m_route = {};
+		}
+		return true;
+	}
+
+	bool key(string_t& value) override
+	{
+		if (m_ignoredDepth == 0) {
+			m_keys[m_depth] = GetKey(value);
+		}
+		return true;
+	}
+
+	bool end_object() override
+	{
+		if (m_ignoredDepth > 0) {
+			--m_ignoredDepth;
+			return true;
+		}
+		if (m_depth == kItemDepth) {
+			FinishItem();
+		} else if (m_depth == kRouteDepth && IsInRoutes()) {
+			RequireFields(m_routeFields, {
+				Key::RouteId,
+				Key::Direction,
+				Key::LineId,
+				Key::StartStationId,
+				Key::EndStationId,
+				Key::RouteStops,
+			}, "route");
+			m_line.routes.emplace_back(std::move(m_route));
+		}
+		--m_depth;
+		return true;
+	}
+
+	bool start_array(std::size_t) override
+	{
+		if (!Push()) {
+			return true;
+		}
+		if (m_depth == kItemDepth + 1 && IsInRoutes()) {
+			m_fields |= FieldBit(Key::Routes);
+		} else if (m_depth == kRouteDepth + 1 && IsInRoutes()
+			&& GetKey(kRouteDepth) == Key::RouteStops) {
+			m_routeFields |= FieldBit(Key::RouteStops);
+		}
+		return true;
+	}
+
+	bool end_array() override
+	{
+		if (m_ignoredDepth > 0) {
+			--m_ignoredDepth;
+			return true;
+		}
+		if (m_depth == kSectionDepth) {
+			const auto section {GetSection()};
+			if (section != kOther) {
+				m_done[section] = true;
+			}
+			// Lines can only be added once all stations are known, and travel
+			// times once all lines are known.
+			if (section == kStations || section == kLines) {
+				FlushPendingItems();
+			}
+		}
+		--m_depth;
+		return true;
+	}
+
+	bool parse_error(
+		std::size_t,
+		const std::string&,
+		const nlohmann::detail::exception& ex
+	) override
+	{
+		throw std::runtime_error(std::string {"Can't parse JSON: "} + ex.what());
+	}
+
+private:
+	enum class Key {
+		Other,
+		Lines,
+		Stations,
+		TravelTimes,
+		StationId,
+		Name,
+		LineId,
+		Routes,
+		RouteId,
+		Direction,
+		StartStationId,
+		EndStationId,
+		RouteStops,
+		TravelTime,
+	};
+
+	// Sections of the document.
+	enum Section {
+		kStations,
+		kLines,
+		kTravelTimes,
+		kOther,
+	};
+
+	// Depth of the section arrays, of the items in them and of the routes of a
+	// line. The stops of a route are the deepest values that are read.
+	static constexpr size_t kSectionDepth {2};
+	static constexpr size_t kItemDepth {3};
+	static constexpr size_t kRouteDepth {5};
+	static constexpr size_t kMaxDepth {kRouteDepth + 1};
+
+	TransportNetwork&	m_network;
+	bool				m_ok {true};
+
+	size_t	m_depth {0};
+	size_t	m_ignoredDepth {0};
+	Key		m_keys[kMaxDepth + 1] {};
+	bool	m_done[kOther] {};
+
+	uint32_t	m_fields {0};
+	uint32_t	m_routeFields {0};
+	Station		m_station {};
+	Line		m_line {};
+	Route		m_route {};
+	TravelTime	m_travelTime {};
+
+	std::vector<Line>		m_pendingLines {};
+	std::vector<TravelTime>	m_pendingTravelTimes {};
+
+	static Key GetKey(
+		std::string_view key
+	)
+	{
+		static const std::pair<std::string_view, Key> keys[] {
+			{"lines", Key::Lines},
+			{"stations", Key::Stations},
+			{"travel_times", Key::TravelTimes},
+			{"station_id", Key::StationId},
+			{"name", Key::Name},
+			{"line_id", Key::LineId},
+			{"routes", Key::Routes},
+			{"route_id", Key::RouteId},
+			{"direction", Key::Direction},
+			{"start_station_id", Key::StartStationId},
+			{"end_station_id", Key::EndStationId},
+			{"route_stops", Key::RouteStops},
+			{"travel_time", Key::TravelTime},
+		};
+		for (const auto& [name, value]: keys) {
+			if (name == key) {
+				return value;
+			}
+		}
+		return Key::Other;
+	}
+
+	static uint32_t FieldBit(
+		const Key key
+	)
+	{
+		return 1u << static_cast<uint32_t>(key);
+	}
+
+	static void RequireFields(
+		const uint32_t fields,
+		std::initializer_list<Key> required,
+		const char* item
+	)
+	{
+		for (const auto key: required) {
+			if ((fields & FieldBit(key)) == 0) {
+				throw std::runtime_error(
+					std::string {"Missing field in "} + item
+				);
+			}
+		}
+	}
+
+	Key GetKey(
+		const size_t depth
+	) const
+	{
+		return m_depth >= depth ? m_keys[depth] : Key::Other;
+	}
+
+	Section GetSection() const
+	{
+		switch (GetKey(1)) {
+			case Key::Stations:
+				return kStations;
+			case Key::Lines:
+				return kLines;
+			case Key::TravelTimes:
+				return kTravelTimes;
+			default:
+				return kOther;
+		}
+	}
+
+	// Return false if the new value is nested too deeply to be read.
+	bool Push()
+	{
+		if (m_depth == kMaxDepth) {
+			++m_ignoredDepth;
+			return false;
+		}
+		m_keys[++m_depth] = Key::Other;
+		return true;
+	}
+
+	bool IsItemField(
+		const Section section,
+		const Key key
+	) const
+	{
+		return m_depth == kItemDepth
+			&& GetSection() == section
+			&& GetKey(kItemDepth) == key;
+	}
+
+	bool IsInRoutes() const
+	{
+		return GetSection() == kLines && GetKey(kItemDepth) == Key::Routes;
+	}
+
+	void SetItemField(
+		const Key key,
+		std::string&& value
+	)
+	{
+		switch (GetSection()) {
+			case kStations:
+				if (key == Key::StationId) {
+					m_station.id = std::move(value);
+				} else if (key == Key::Name) {
+					m_station.name = std::move(value);
+				}
+				break;
+			case kLines:
+				if (key == Key::LineId) {
+					m_line.id = std::move(value);
+				} else if (key == Key::Name) {
+					m_line.name = std::move(value);
+				}
+				break;
+			case kTravelTimes:
+				if (key == Key::StartStationId) {
+					m_travelTime.startStationId = std::move(value);
+				} else if (key == Key::EndStationId) {
+					m_travelTime.endStationId = std::move(value);
+				}
+				break;
+			default:
+				return;
+		}
+		m_fields |= FieldBit(key);
+	}
+
+	void SetRouteField(
+		const Key key,
+		std::string&& value
+	)
+	{
+		switch (key) {
+			case Key::RouteId:
+				m_route.id = std::move(value);
+				break;
+			case Key::Direction:
+				m_route.name = std::move(value);
+				break;
+			case Key::LineId:
+				m_route.lineId = std::move(value);
+				break;
+			case Key::StartStationId:
+				m_route.startStationId = std::move(value);
+				break;
+			case Key::EndStationId:
+				m_route.endStationId = std::move(value);
+				break;
+			default:
+				return;
+		}
+		m_routeFields |= FieldBit(key);
+	}
+
+	void FinishItem()
+	{
+		switch (GetSection()) {
+			case kStations:
+				RequireFields(m_fields, {Key::StationId, Key::Name}, "station");
+				if (!m_network.AddStation(m_station)) {
+					throw std::runtime_error("Can't add station : " + m_station.id);
+				}
+				break;
+			case kLines:
+				RequireFields(m_fields, {Key::LineId, Key::Name, Key::Routes}, "line");
+				if (m_done[kStations]) {
+					AddLine(m_line);
+				} else {
+					m_pendingLines.emplace_back(std::move(m_line));
+				}
+				break;
+			case kTravelTimes:
+				RequireFields(m_fields, {
+					Key::StartStationId,
+					Key::EndStationId,
+					Key::TravelTime,
+				}, "travel time");
+				if (m_done[kStations] && m_done[kLines]) {
+					SetTravelTime(m_travelTime);
+				} else {
+					m_pendingTravelTimes.emplace_back(std::move(m_travelTime));
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	void FlushPendingItems()
+	{
+		if (m_done[kStations]) {
+			for (const auto& line: m_pendingLines) {
+				AddLine(line);
+			}
+			m_pendingLines.clear();
+		}
+		if (m_done[kStations] && m_done[kLines]) {
+			for (const auto& travelTime: m_pendingTravelTimes) {
+				SetTravelTime(travelTime);
+			}
+			m_pendingTravelTimes.clear();
+		}
+	}
+
+	void AddLine(
+		const Line& line
+	)
+	{
+		if (!m_network.AddLine(line)) {
+			throw std::runtime_error("Can't add line : " + line.id);
+		}
+	}
+
+	// Like FromJson, stop at the first travel time that cannot be set.
+	void SetTravelTime(
+		const TravelTime& travelTime
+	)
+	{
+		m_ok = m_ok && m_network.SetTravelTime(
+			travelTime.startStationId,
+			travelTime.endStationId,
+			travelTime.travelTime
+		);
+	}
+};
+
+// Call `fn(first, last)` on consecutive chunks of [0, count), in parallel on
+// all available cores. Small workloads run on the calling thread.
+template <typename Fn>
+void ParallelFor(
+	const size_t count,
+	Fn&& fn
+)
+{
+	static constexpr size_t kMinChunk {16};
+	const size_t nThreads {std::min<size_t>(
+		std::max(1u, std::thread::hardware_concurrency()),
+		(count + kMinChunk - 1) / kMinChunk
+	)};
+	if (nThreads <= 1) {
+		fn(0, count);
+		return;
+	}
+
+	const size_t chunk {(count + nThreads - 1) / nThreads};
+	std::vector<std::thread> threads {};
+	threads.reserve(nThreads);
+	for (size_t first {0}; first < count; first += chunk) {
+		threads.emplace_back(fn, first, std::min(first + chunk, count));
+	}
+	for (auto& thread: threads) {
+		thread.join();
+	}
+}
+
+} // namespace
 
 bool Station::operator==(const Station& other) const
 {
@@ -50,10 +866,32 @@ TransportNetwork& TransportNetwork::operator=(
 	TransportNetwork&& moved
 ) = default;
 
+TransportNetwork TransportNetwork::Clone() const
+{
+	return *this;
+}
+
 bool TransportNetwork::FromJson(
 	nlohmann::json&& src
 )
 {
+	// Size the containers up front from the JSON arrays, so that they do not
+	// grow item by item.
+	size_t nRoutes {0};
+	size_t nStops {0};
+	for (const auto& lineJson : src.at("lines")) {
+		for (const auto& routeJson : lineJson.at("routes")) {
+			++nRoutes;
+			nStops += routeJson.at("route_stops").size();
+		}
+	}
+	Reserve(
+		m_stations.size() + src.at("stations").size(),
+		m_lines.size() + src.at("lines").size(),
+		m_routes.size() + nRoutes,
+		m_routeStops.size() + nStops
+	);
+
 	for (auto&& stationJson : src.at("stations")) {
 		Station station {	
 			std::move(stationJson.at("station_id").get<std::string>()), 
@@ -109,301 +947,2911 @@ bool TransportNetwork::FromJson(
 	return true;
 }
 
-bool TransportNetwork::AddStation(const Station& station)
+bool TransportNetwork::FromJsonStream(
+	std::istream& src
+)
 {
-	if (GetStation(station.id)) {
-		return false;
-	}
-
-	auto node { 
-		std::make_shared<GraphNode>(
-			GraphNode{station.id, station.name, 0, {}}
-		)};
-	m_stations.emplace(station.id, std::move(node));
-
-	return true;
+	NetworkJsonHandler handler {*this};
+	nlohmann::json::sax_parse(src, &handler);
+	return handler.Finish();
 }
 
-bool TransportNetwork::AddLine(const Line& line)
+bool TransportNetwork::FromJsonFile(
+	const std::filesystem::path& source
+)
 {
-	if (GetLine(line.id)) {
-		return false;
-	}
-
-	auto lineInternal { 
-		std::make_shared<LineInternal>(
-			LineInternal{line.id, line.name, {}}
-	)};
-
-	for (auto& route: line.routes) {
-		if (AddRouteToLine(lineInternal, route) == false)
-			return false;
+	std::ifstream file {source};
+	if (!file) {
+		throw std::runtime_error("Can't open file : " + source.string());
 	}
-
-	m_lines.emplace(line.id, std::move(lineInternal));
-
-	return true;
+	return FromJsonStream(file);
 }
 
-bool TransportNetwork::RecordPassengerEvent(
-    const PassengerEvent& event
+bool TransportNetwork::FromLayout(
+	const NetworkLayout& layout,
+	std::vector<std::string>& errors
 )
 {
-	auto station {GetStation(event.stationId)};
-	if (station == nullptr) {
+	errors.clear();
+	if (!m_stations.empty()) {
+		errors.emplace_back("The network is not empty");
 		return false;
 	}
 
-	switch (event.type) {
-		case PassengerEvent::Type::In:
-			++station->passengerCount;
-			break;	
-		case PassengerEvent::Type::Out:
-			--station->passengerCount;
-			break;
-		default:
-			return false;
-	}
+	// The network is built aside and only replaces this one if it is valid.
+	TransportNetwork nw {};
 
-	return true;
-}
+	size_t nRoutes {0};
+	size_t nStops {0};
+	for (const auto& line: layout.lines) {
+		nRoutes += line.routes.size();
+		for (const auto& route: line.routes) {
+			nStops += route.stops.size();
+		}
+	}
+	nw.Reserve(layout.stations.size(), layout.lines.size(), nRoutes, nStops);
 
-int64_t TransportNetwork::GetPassengerCount(
-	const Id& stationId
-) const
-{
-	const auto station {GetStation(stationId)};
-	if (station == nullptr) {
-		throw std::runtime_error("Can't find needed station");
+	// Intern the IDs. The ID tables are not thread-safe, so this is serial.
+	for (const auto& station: layout.stations) {
+		if (nw.m_stationIds.Find(station.id) != kInvalidIndex) {
+			errors.push_back("Station " + station.id + ": duplicate ID");
+			continue;
+		}
+		nw.m_stationIds.Insert(station.id);
+		nw.m_stationNames.Append(station.name);
+		nw.m_stations.emplace_back();
 	}
 
-	return station->passengerCount;
-}
+	std::vector<const Route*> routes {};
+	routes.reserve(nRoutes);
+	for (const auto& line: layout.lines) {
+		if (nw.m_lineIds.Find(line.id) != kInvalidIndex) {
+			errors.push_back("Line " + line.id + ": duplicate ID");
+			continue;
+		}
+		const auto lineIndex {nw.m_lineIds.Insert(line.id)};
+		nw.m_lineNames.Append(line.name);
+		nw.m_lines.emplace_back();
+		for (const auto& route: line.routes) {
+			if (nw.m_routeIds.Find(route.id) != kInvalidIndex) {
+				errors.push_back("Route " + route.id + ": duplicate ID");
+				continue;
+			}
+			nw.m_lines[lineIndex].routes.push_back(
+				nw.m_routeIds.Insert(route.id)
+			);
+			nw.m_routeNames.Append(route.name);
+			nw.m_routes.push_back(RouteInternal{
+				lineIndex,
+				static_cast<uint32_t>(nw.m_routeStops.size()),
+				static_cast<uint32_t>(route.stops.size())
+			});
+			nw.m_routeStops.resize(nw.m_routeStops.size() + route.stops.size());
+			routes.push_back(&route);
+		}
+	}
 
-std::vector<Id> TransportNetwork::GetRoutesServingStation(
-	const Id& stationId
-) const
-{
-	std::vector<Id> servingRoutes {};
+	// Resolve the route stops and the travel time stations in parallel.
+	nRoutes = routes.size();
+	const auto nTravelTimes {layout.travelTimes.size()};
+	std::vector<std::vector<std::string>> itemErrors(nRoutes + nTravelTimes);
+	std::vector<std::pair<uint32_t, uint32_t>> travelTimeStations(nTravelTimes);
+	ParallelFor(nRoutes + nTravelTimes, [&](const size_t first, const size_t last) {
+		for (auto idx {first}; idx < last; ++idx) {
+			auto& itemError {itemErrors[idx]};
+			if (idx >= nRoutes) {
+				const auto& travelTime {layout.travelTimes[idx - nRoutes]};
+				auto& [stationA, stationB] {travelTimeStations[idx - nRoutes]};
+				stationA = nw.m_stationIds.Find(travelTime.startStationId);
+				stationB = nw.m_stationIds.Find(travelTime.endStationId);
+				for (const auto* id: {
+					&travelTime.startStationId,
+					&travelTime.endStationId
+				}) {
+					if (nw.m_stationIds.Find(*id) == kInvalidIndex) {
+						itemError.push_back("Travel time " + travelTime.startStationId
+							+ " - " + travelTime.endStationId
+							+ ": unknown station " + *id);
+					}
+				}
+				continue;
+			}
 
-	const auto station {GetStation(stationId)};
-	if (station == nullptr) {
-		return servingRoutes;
+			const auto& route {*routes[idx]};
+			auto* stops {nw.m_routeStops.data() + nw.m_routes[idx].firstStop};
+			if (route.stops.size() < 2) {
+				itemError.push_back("Route " + route.id + ": less than 2 stops");
+			}
+			for (const auto& stationId: route.stops) {
+				const auto station {nw.m_stationIds.Find(stationId)};
+				if (station == kInvalidIndex) {
+					itemError.push_back("Route " + route.id
+						+ ": unknown station " + stationId);
+				}
+				*stops++ = station;
+			}
+		}
+	});
+	for (auto& itemError: itemErrors) {
+		std::move(itemError.begin(), itemError.end(), std::back_inserter(errors));
 	}
-
-	const auto& edges {station->edges};
-	for (const auto& edge: edges) {
-		servingRoutes.push_back(edge.route->id);
+	if (!errors.empty()) {
+		return false;
 	}
 
-	// The previous loop misses a corner case: The end station of a route does
-	// not have any edge containing that route, because we only track the routes
-	// that *leave from*, not *arrive to* a certain station.
-	// We need to loop over all line routes to check if our station is the end
-	// stop of any route.
-	// FIXME: In the worst case, we are iterating over all routes for all
-	//        lines in the network. Need to optimize this.
-	for (const auto& [_, line]: m_lines) {
-		for (const auto& [_, route]: line->routes) {
-			const auto& endStop {route->stops[route->stops.size() - 1]};
-			if (station == endStop) {
-				servingRoutes.push_back(route->id);
+	// Link the graph in a single pass, in route order: this is the order in
+	// which AddLine would have added the edges and serving routes.
+	std::vector<uint32_t> nServingRoutes(nw.m_stations.size(), 0);
+	nw.m_edgeOffsets.assign(nw.m_stations.size() + 1, 0);
+	for (const auto& route: nw.m_routes) {
+		const auto* stops {nw.m_routeStops.data() + route.firstStop};
+		for (uint32_t idx {0}; idx < route.nStops; ++idx) {
+			++nServingRoutes[stops[idx]];
+			if (idx + 1 < route.nStops) {
+				++nw.m_edgeOffsets[stops[idx] + 1];
+			}
+		}
+	}
+	std::partial_sum(
+		nw.m_edgeOffsets.begin(),
+		nw.m_edgeOffsets.end(),
+		nw.m_edgeOffsets.begin()
+	);
+	for (size_t idx {0}; idx < nw.m_stations.size(); ++idx) {
+		nw.m_stations[idx].servingRoutes.reserve(nServingRoutes[idx]);
+	}
+	nw.m_edges.resize(nw.m_edgeOffsets.back());
+	std::vector<uint32_t> cursor(
+		nw.m_edgeOffsets.begin(),
+		nw.m_edgeOffsets.end() - 1
+	);
+	for (uint32_t routeIndex {0}; routeIndex < nRoutes; ++routeIndex) {
+		const auto& route {nw.m_routes[routeIndex]};
+		const auto* stops {nw.m_routeStops.data() + route.firstStop};
+		for (uint32_t idx {0}; idx < route.nStops; ++idx) {
+			const auto station {stops[idx]};
+			nw.m_stations[station].servingRoutes.push_back({routeIndex});
+			if (idx + 1 < route.nStops) {
+				nw.m_edges[cursor[station]++] = {
+					routeIndex,
+					route.line,
+					stops[idx + 1],
+					0
+				};
 			}
 		}
 	}
 
-	return servingRoutes;
-}
-
-bool TransportNetwork::SetTravelTime(
-	const Id& stationIdA,
-	const Id& stationIdB,
-	const uint32_t travelTime
-)
-{
-	const auto stationA {GetStation(stationIdA)};
-	const auto stationB {GetStation(stationIdB)};
-	if (stationA == nullptr || stationB == nullptr) {
+	// Set the travel times on the edges, in both directions like
+	// SetTravelTime.
+	for (size_t idx {0}; idx < nTravelTimes; ++idx) {
+		const auto [stationA, stationB] {travelTimeStations[idx]};
+		bool found {false};
+		for (const auto& [from, to]: {
+			std::pair {stationA, stationB},
+			std::pair {stationB, stationA}
+		}) {
+			for (auto edge {nw.m_edgeOffsets[from]};
+				edge < nw.m_edgeOffsets[from + 1]; ++edge) {
+				if (nw.m_edges[edge].next == to) {
+					nw.m_edges[edge].travelTime = layout.travelTimes[idx].travelTime;
+					found = true;
+				}
+			}
+		}
+		if (!found) {
+			const auto& travelTime {layout.travelTimes[idx]};
+			errors.push_back("Travel time " + travelTime.startStationId
+				+ " - " + travelTime.endStationId + ": stations not adjacent");
+		}
+	}
+	if (!errors.empty()) {
 		return false;
 	}
 
-	bool foundEdge {false};
-	auto setTravelTime {[&travelTime, &foundEdge](auto stationFrom, auto stationTo) {
-		for (auto& edge : stationFrom->edges) {
-			if (edge.next == stationTo) {
-				edge.travelTime = travelTime;
-				foundEdge = true;
+	// Derive the per-route state from the edges, in parallel.
+	nw.m_cumulativeTravelTimes.assign(nw.m_routeStops.size(), 0);
+	nw.m_stopPositions.resize(nw.m_routeStops.size());
+	ParallelFor(nRoutes, [&nw](const size_t first, const size_t last) {
+		for (auto routeIndex {first}; routeIndex < last; ++routeIndex) {
+			const auto& route {nw.m_routes[routeIndex]};
+			const auto* stops {nw.m_routeStops.data() + route.firstStop};
+			auto* cumulativeTravelTimes {
+				nw.m_cumulativeTravelTimes.data() + route.firstStop
+			};
+			for (uint32_t idx {1}; idx < route.nStops; ++idx) {
+				uint32_t travelTime {0};
+				for (const auto& edge: nw.GetEdges(stops[idx - 1])) {
+					if (edge.route == routeIndex && edge.next == stops[idx]) {
+						travelTime = edge.travelTime;
+						break;
+					}
+				}
+				cumulativeTravelTimes[idx] =
+					cumulativeTravelTimes[idx - 1] + travelTime;
 			}
+			nw.IndexRouteStops(routeIndex);
 		}
-	}};
-	setTravelTime(stationA, stationB);
-	setTravelTime(stationB, stationA);
+	});
+
+	// Keep the settings of this network.
+	nw.m_lineChangePenalty = m_lineChangePenalty;
+	nw.m_crowdingCost = m_crowdingCost;
+	nw.m_passengerCounts.resize(nw.m_stations.size());
+	nw.m_flowBucketWidth = m_flowBucketWidth;
+	nw.m_flowBucketCount = m_flowBucketCount;
+	nw.m_flowBuckets.resize(nw.m_stations.size() * nw.m_flowBucketCount);
+	nw.ResetItemStates();
+	*this = std::move(nw);
 
-	return foundEdge;
+	return true;
 }
 
-uint32_t TransportNetwork::GetTravelTime(
-	const Id& stationIdA,
-	const Id& stationIdB
-) const
+bool TransportNetwork::ApplyPatch(
+	const nlohmann::json& patch,
+	std::vector<std::string>& errors
+)
 {
-	const auto stationA {GetStation(stationIdA)};
-	const auto stationB {GetStation(stationIdB)};
-	if (stationA == nullptr || stationB == nullptr) {
-		return false;
-	}
+	errors.clear();
+
+	// Parse the whole patch first: malformed items throw before any change.
+	static const nlohmann::json noItems = nlohmann::json::array();
+	auto getItems {[](
+		const nlohmann::json& object,
+		const char* key
+	) -> const nlohmann::json& {
+		const auto it {object.find(key)};
+		return it == object.end() ? noItems : *it;
+	}};
+	auto parseRoute {[](const nlohmann::json& routeJson) {
+		return Route {
+			routeJson.at("route_id").get<std::string>(),
+			routeJson.at("direction").get<std::string>(),
+			routeJson.at("line_id").get<std::string>(),
+			routeJson.at("start_station_id").get<std::string>(),
+			routeJson.at("end_station_id").get<std::string>(),
+			routeJson.at("route_stops").get<std::vector<Id>>()
+		};
+	}};
+	const auto& removeJson {getItems(patch, "remove")};
+	const auto& addJson {getItems(patch, "add")};
 
-	for (const auto& edge: stationA->edges) {
-		if (edge.next == stationB) {
-			return edge.travelTime;
+	const auto removedStationIds {
+		getItems(removeJson, "stations").get<std::vector<Id>>()
+	};
+	const auto removedLineIds {
+		getItems(removeJson, "lines").get<std::vector<Id>>()
+	};
+	const auto removedRouteIds {
+		getItems(removeJson, "routes").get<std::vector<Id>>()
+	};
+	std::vector<Station> addedStations {};
+	for (const auto& stationJson: getItems(addJson, "stations")) {
+		addedStations.push_back(Station {
+			stationJson.at("station_id").get<std::string>(),
+			stationJson.at("name").get<std::string>()
+		});
+	}
+	std::vector<Line> addedLines {};
+	for (const auto& lineJson: getItems(addJson, "lines")) {
+		std::vector<Route> routes {};
+		for (const auto& routeJson: lineJson.at("routes")) {
+			routes.push_back(parseRoute(routeJson));
 		}
+		addedLines.push_back(Line {
+			lineJson.at("line_id").get<std::string>(),
+			lineJson.at("name").get<std::string>(),
+			std::move(routes)
+		});
+	}
+	std::vector<Route> addedRoutes {};
+	for (const auto& routeJson: getItems(addJson, "routes")) {
+		addedRoutes.push_back(parseRoute(routeJson));
+	}
+	std::vector<TravelTime> travelTimes {};
+	for (const auto& travelTimeJson: getItems(patch, "travel_times")) {
+		travelTimes.push_back(TravelTime {
+			travelTimeJson.at("start_station_id").get<std::string>(),
+			travelTimeJson.at("end_station_id").get<std::string>(),
+			travelTimeJson.at("travel_time").get<uint32_t>()
+		});
 	}
 
-	for (const auto& edge: stationB->edges) {
-		if (edge.next == stationA) {
-			return edge.travelTime;
+	// Validate the removals. Removing a line removes its routes.
+	std::vector<bool> isStationRemoved(m_stations.size(), false);
+	std::vector<bool> isLineRemoved(m_lines.size(), false);
+	std::vector<bool> isRouteRemoved(m_routes.size(), false);
+	for (const auto& lineId: removedLineIds) {
+		const auto line {GetLineIndex(lineId)};
+		if (line == kInvalidIndex) {
+			errors.push_back("Line " + lineId + ": unknown ID");
+			continue;
+		}
+		isLineRemoved[line] = true;
+		for (const auto route: m_lines[line].routes) {
+			isRouteRemoved[route] = true;
 		}
 	}
-
-	return 0;
+	for (const auto& routeId: removedRouteIds) {
+		const auto route {GetRouteIndex(routeId)};
+		if (route == kInvalidIndex) {
+			errors.push_back("Route " + routeId + ": unknown ID");
+			continue;
+		}
+		isRouteRemoved[route] = true;
+	}
+	for (const auto& stationId: removedStationIds) {
+		const auto station {GetStationIndex(stationId)};
+		if (station == kInvalidIndex) {
+			errors.push_back("Station " + stationId + ": unknown ID");
+			continue;
+		}
+		isStationRemoved[station] = true;
+		for (const auto route: m_stations[station].servingRoutes) {
+			if (!isRouteRemoved[route.index]) {
+				errors.push_back("Station " + stationId + ": served by route "
+					+ Id {m_routeIds.Get(route.index)});
+			}
+		}
+	}
+
+	// Validate the additions against the network as it is once the removals
+	// are applied, and against the items added before them in the patch.
+	std::set<std::string_view> addedStationIds {};
+	std::set<std::string_view> addedLineIds {};
+	std::set<std::string_view> addedRouteIds {};
+	auto isLiveStation {[&](const Id& stationId) {
+		const auto station {GetStationIndex(stationId)};
+		return (station != kInvalidIndex && !isStationRemoved[station])
+			|| addedStationIds.count(stationId) > 0;
+	}};
+	auto isLiveLine {[&](const Id& lineId) {
+		const auto line {GetLineIndex(lineId)};
+		return (line != kInvalidIndex && !isLineRemoved[line])
+			|| addedLineIds.count(lineId) > 0;
+	}};
+	auto isLiveRoute {[&](const Id& routeId) {
+		const auto route {GetRouteIndex(routeId)};
+		return (route != kInvalidIndex && !isRouteRemoved[route])
+			|| addedRouteIds.count(routeId) > 0;
+	}};
+
+	// Adjacent stations of the added routes, for the travel times.
+	std::set<std::pair<std::string_view, std::string_view>> addedPairs {};
+	auto validateRoute {[&](const Route& route) {
+		if (isLiveRoute(route.id)) {
+			errors.push_back("Route " + route.id + ": duplicate ID");
+		}
+		addedRouteIds.insert(route.id);
+		if (route.stops.size() < 2) {
+			errors.push_back("Route " + route.id + ": less than 2 stops");
+		}
+		for (size_t idx {0}; idx < route.stops.size(); ++idx) {
+			if (!isLiveStation(route.stops[idx])) {
+				errors.push_back("Route " + route.id
+					+ ": unknown station " + route.stops[idx]);
+			}
+			if (idx + 1 < route.stops.size()) {
+				addedPairs.emplace(route.stops[idx], route.stops[idx + 1]);
+				addedPairs.emplace(route.stops[idx + 1], route.stops[idx]);
+			}
+		}
+	}};
+	for (const auto& station: addedStations) {
+		if (isLiveStation(station.id)) {
+			errors.push_back("Station " + station.id + ": duplicate ID");
+		}
+		addedStationIds.insert(station.id);
+	}
+	for (const auto& line: addedLines) {
+		if (isLiveLine(line.id)) {
+			errors.push_back("Line " + line.id + ": duplicate ID");
+		}
+		addedLineIds.insert(line.id);
+		for (const auto& route: line.routes) {
+			validateRoute(route);
+		}
+	}
+	for (const auto& route: addedRoutes) {
+		if (!isLiveLine(route.lineId)) {
+			errors.push_back("Route " + route.id + ": unknown line "
+				+ route.lineId);
+		}
+		validateRoute(route);
+	}
+
+	// Travel times can only be set on the edges of the routes left by the
+	// patch.
+	for (const auto& travelTime: travelTimes) {
+		bool known {true};
+		for (const auto* id: {
+			&travelTime.startStationId,
+			&travelTime.endStationId
+		}) {
+			if (!isLiveStation(*id)) {
+				errors.push_back("Travel time " + travelTime.startStationId
+					+ " - " + travelTime.endStationId
+					+ ": unknown station " + *id);
+				known = false;
+			}
+		}
+		if (!known) {
+			continue;
+		}
+		bool adjacent {addedPairs.count({
+			travelTime.startStationId,
+			travelTime.endStationId
+		}) > 0};
+		const auto stationA {GetStationIndex(travelTime.startStationId)};
+		const auto stationB {GetStationIndex(travelTime.endStationId)};
+		if (!adjacent && stationA != kInvalidIndex && stationB != kInvalidIndex) {
+			for (const auto& [from, to]: {
+				std::pair {stationA, stationB},
+				std::pair {stationB, stationA}
+			}) {
+				for (const auto& edge: GetEdges(from)) {
+					adjacent = adjacent || (edge.next == to
+						&& !isRouteRemoved[edge.route]);
+				}
+			}
+		}
+		if (!adjacent) {
+			errors.push_back("Travel time " + travelTime.startStationId
+				+ " - " + travelTime.endStationId + ": stations not adjacent");
+		}
+	}
+
+	// All the routes between 2 stations share one travel time: the edges of
+	// the added routes take it from the edges already between the stations,
+	// even those of the routes the patch removes, unless the patch sets it.
+	std::set<std::pair<std::string_view, std::string_view>> setPairs {};
+	for (const auto& travelTime: travelTimes) {
+		setPairs.emplace(travelTime.startStationId, travelTime.endStationId);
+		setPairs.emplace(travelTime.endStationId, travelTime.startStationId);
+	}
+	std::vector<TravelTime> knownTravelTimes {};
+	for (const auto& [idA, idB]: addedPairs) {
+		if (idA > idB || setPairs.count({idA, idB}) > 0) {
+			continue;
+		}
+		const auto stationA {m_stationIds.Find(idA)};
+		const auto stationB {m_stationIds.Find(idB)};
+		bool known {false};
+		if (stationA != kInvalidIndex && stationB != kInvalidIndex) {
+			for (const auto& [from, to]: {
+				std::pair {stationA, stationB},
+				std::pair {stationB, stationA}
+			}) {
+				for (const auto& edge: GetEdges(from)) {
+					if (!known && edge.next == to && edge.route != kInvalidIndex) {
+						knownTravelTimes.push_back({
+							Id {idA},
+							Id {idB},
+							edge.travelTime
+						});
+						known = true;
+					}
+				}
+			}
+		}
+		if (!known) {
+			errors.push_back("Travel time " + Id {idA} + " - " + Id {idB}
+				+ ": missing");
+		}
+	}
+	if (!errors.empty()) {
+		return false;
+	}
+
+	// The caches are updated in place only if the patch keeps the same
+	// stations: every station it adds must have been removed before. The
+	// changes are recorded per pair of adjacent stations, with the travel
+	// times the caches were built with.
+	bool updateCaches {HasContractionHierarchy() || HasTravelTimeMatrix()};
+	for (const auto& station: addedStations) {
+		updateCaches = updateCaches
+			&& m_stationIds.Find(station.id) != kInvalidIndex;
+	}
+	std::vector<EdgeChange> changes {};
+	if (updateCaches) {
+		auto recordChange {[this, &changes](
+			const uint32_t from,
+			const uint32_t next
+		) {
+			changes.push_back({from, next, GetArcWeight(from, next)});
+		}};
+		auto recordStops {[this, &recordChange](const std::vector<Id>& stops) {
+			for (size_t idx {0}; idx + 1 < stops.size(); ++idx) {
+				recordChange(
+					m_stationIds.Find(stops[idx]),
+					m_stationIds.Find(stops[idx + 1])
+				);
+			}
+		}};
+		for (uint32_t route {0}; route < m_routes.size(); ++route) {
+			if (!isRouteRemoved[route]) {
+				continue;
+			}
+			const auto& routeInternal {m_routes[route]};
+			const auto* stops {m_routeStops.data() + routeInternal.firstStop};
+			for (uint32_t idx {0}; idx + 1 < routeInternal.nStops; ++idx) {
+				recordChange(stops[idx], stops[idx + 1]);
+			}
+		}
+		for (const auto& line: addedLines) {
+			for (const auto& route: line.routes) {
+				recordStops(route.stops);
+			}
+		}
+		for (const auto& route: addedRoutes) {
+			recordStops(route.stops);
+		}
+		for (const auto& travelTime: travelTimes) {
+			const auto stationA {m_stationIds.Find(travelTime.startStationId)};
+			const auto stationB {m_stationIds.Find(travelTime.endStationId)};
+			recordChange(stationA, stationB);
+			recordChange(stationB, stationA);
+		}
+	}
+
+	// Set the caches aside, so that the changes below do not update them one
+	// by one.
+	auto hierarchy {std::move(m_hierarchy)};
+	auto travelTimeMatrix {std::move(m_travelTimeMatrix)};
+	InvalidateLayoutCaches();
+
+	for (uint32_t route {0}; route < m_routes.size(); ++route) {
+		if (isRouteRemoved[route]) {
+			RemoveRoute(route);
+		}
+	}
+	for (uint32_t line {0}; line < m_lines.size(); ++line) {
+		if (isLineRemoved[line]) {
+			m_removedLines[line] = true;
+		}
+	}
+	for (uint32_t station {0}; station < m_stations.size(); ++station) {
+		if (!isStationRemoved[station]) {
+			continue;
+		}
+		m_removedStations[station] = true;
+		m_disabledStations[station] = false;
+		m_passengerCounts[station].count.store(0, std::memory_order_relaxed);
+		for (size_t idx {0}; idx < m_flowBucketCount; ++idx) {
+			m_flowBuckets[station * m_flowBucketCount + idx] = FlowBucket {};
+		}
+	}
+
+	std::vector<std::pair<uint32_t, GraphEdge>> newEdges {};
+	for (const auto& station: addedStations) {
+		InsertStation(station);
+	}
+	for (const auto& line: addedLines) {
+		InsertLine(line, newEdges);
+	}
+	for (const auto& route: addedRoutes) {
+		AddRouteToLine(GetLineIndex(route.lineId), route, newEdges);
+	}
+	InsertEdges(newEdges);
+	for (const auto* times: {&knownTravelTimes, &travelTimes}) {
+		for (const auto& travelTime: *times) {
+			SetTravelTime(
+				GetStationIndex(travelTime.startStationId),
+				GetStationIndex(travelTime.endStationId),
+				travelTime.travelTime
+			);
+		}
+	}
+
+	if (updateCaches) {
+		for (auto& change: changes) {
+			change.newTravelTime = GetArcWeight(change.from, change.next);
+		}
+		m_hierarchy = std::move(hierarchy);
+		m_travelTimeMatrix = std::move(travelTimeMatrix);
+		UpdateCaches(changes);
+	}
+
+	return true;
+}
+
+bool TransportNetwork::SaveSnapshot(
+	const std::filesystem::path& destination
+) const
+{
+	static_assert(sizeof(GraphEdge) == sizeof(SnapshotFormat::Edge));
+
+	SnapshotWriter writer {};
+	for (const auto* ids: {&m_stationIds, &m_lineIds, &m_routeIds}) {
+		writer.Write(ids->m_chars);
+		writer.Write(ids->m_offsets);
+		writer.Write(ids->m_slots);
+	}
+
+	writer.WriteNames(m_stationNames);
+	writer.WriteArrays(m_stations, [](const auto& station) -> const auto& {
+		return station.servingRoutes;
+	});
+
+	// Free edge slots are not saved.
+	std::vector<uint32_t> edgeOffsets {0};
+	std::vector<GraphEdge> edges {};
+	edgeOffsets.reserve(m_edgeOffsets.size());
+	edges.reserve(m_edges.size());
+	for (uint32_t station {0}; station < m_stations.size(); ++station) {
+		for (const auto& edge: GetEdges(station)) {
+			if (edge.route != kInvalidIndex) {
+				edges.push_back(edge);
+			}
+		}
+		edgeOffsets.push_back(edges.size());
+	}
+	writer.Write(edgeOffsets);
+	writer.Write(edges);
+
+	writer.WriteNames(m_lineNames);
+	writer.WriteArrays(m_lines, [](const auto& line) -> const auto& {
+		return line.routes;
+	});
+
+	writer.WriteNames(m_routeNames);
+	std::vector<uint32_t> routeLines {};
+	routeLines.reserve(m_routes.size());
+	for (const auto& route: m_routes) {
+		routeLines.push_back(route.line);
+	}
+	writer.Write(routeLines);
+
+	// The route arenas are saved in route order, without the slices left
+	// unused by removed routes.
+	std::vector<uint32_t> routeStops {};
+	std::vector<uint32_t> cumulativeTravelTimes {};
+	std::vector<uint32_t> stopOffsets {0};
+	routeStops.reserve(m_routeStops.size());
+	cumulativeTravelTimes.reserve(m_routeStops.size());
+	stopOffsets.reserve(m_routes.size() + 1);
+	for (const auto& route: m_routes) {
+		const auto first {route.firstStop};
+		const auto last {route.firstStop + route.nStops};
+		routeStops.insert(
+			routeStops.end(),
+			m_routeStops.begin() + first,
+			m_routeStops.begin() + last
+		);
+		cumulativeTravelTimes.insert(
+			cumulativeTravelTimes.end(),
+			m_cumulativeTravelTimes.begin() + first,
+			m_cumulativeTravelTimes.begin() + last
+		);
+		stopOffsets.push_back(routeStops.size());
+	}
+	writer.Write(routeStops);
+	writer.Write(stopOffsets);
+	writer.Write(cumulativeTravelTimes);
+	writer.Write(stopOffsets);
+
+	writer.WriteFlags(m_removedStations);
+	writer.WriteFlags(m_removedLines);
+	writer.WriteFlags(m_removedRoutes);
+
+	return writer.Save(destination);
+}
+
+bool TransportNetwork::LoadSnapshot(
+	const std::filesystem::path& source
+)
+{
+	SnapshotReader reader {};
+	if (!reader.Open(source)) {
+		return false;
+	}
+
+	TransportNetwork nw {};
+	bool ok {true};
+	for (auto* ids: {&nw.m_stationIds, &nw.m_lineIds, &nw.m_routeIds}) {
+		ok = ok
+			&& reader.Read(ids->m_chars)
+			&& reader.Read(ids->m_offsets)
+			&& reader.Read(ids->m_slots);
+	}
+
+	std::vector<RouteHandle> servingRoutes {};
+	ok = ok
+		&& reader.ReadNames(nw.m_stations, nw.m_stationNames)
+		&& reader.ReadArrays(nw.m_stations, servingRoutes, [](
+			auto& station,
+			auto first,
+			auto last
+		) {
+			station.servingRoutes.assign(first, last);
+		})
+		&& reader.Read(nw.m_edgeOffsets)
+		&& reader.Read(nw.m_edges);
+
+	std::vector<uint32_t> values {};
+	ok = ok
+		&& reader.ReadNames(nw.m_lines, nw.m_lineNames)
+		&& reader.ReadArrays(nw.m_lines, values, [](
+			auto& line,
+			auto first,
+			auto last
+		) {
+			line.routes.assign(first, last);
+		});
+
+	std::vector<uint32_t> routeLines {};
+	std::vector<uint32_t> stopOffsets {};
+	std::vector<uint32_t> travelTimeOffsets {};
+	ok = ok
+		&& reader.ReadNames(nw.m_routes, nw.m_routeNames)
+		&& reader.Read(routeLines)
+		&& routeLines.size() == nw.m_routes.size()
+		&& reader.Read(nw.m_routeStops)
+		&& reader.Read(stopOffsets)
+		&& reader.Read(nw.m_cumulativeTravelTimes)
+		&& reader.Read(travelTimeOffsets);
+
+	std::vector<bool> removedStations {};
+	std::vector<bool> removedLines {};
+	std::vector<bool> removedRoutes {};
+	ok = ok
+		&& reader.ReadFlags(removedStations, nw.m_stations.size())
+		&& reader.ReadFlags(removedLines, nw.m_lines.size())
+		&& reader.ReadFlags(removedRoutes, nw.m_routes.size())
+		&& reader.AtEnd()
+		&& stopOffsets.size() == nw.m_routes.size() + 1
+		&& stopOffsets == travelTimeOffsets
+		&& SnapshotReader::IsValidOffsets(stopOffsets, nw.m_routeStops.size());
+	if (!ok) {
+		return false;
+	}
+	for (size_t idx {0}; idx < nw.m_routes.size(); ++idx) {
+		auto& route {nw.m_routes[idx]};
+		route.line = routeLines[idx];
+		route.firstStop = stopOffsets[idx];
+		route.nStops = stopOffsets[idx + 1] - stopOffsets[idx];
+	}
+	if (!nw.IsLayoutValid()) {
+		return false;
+	}
+
+	// Derived state.
+	nw.m_stopPositions.resize(nw.m_routeStops.size());
+	for (uint32_t route {0}; route < nw.m_routes.size(); ++route) {
+		nw.IndexRouteStops(route);
+	}
+	nw.m_passengerCounts.resize(nw.m_stations.size());
+	nw.ResetItemStates();
+	nw.m_removedStations = std::move(removedStations);
+	nw.m_removedLines = std::move(removedLines);
+	nw.m_removedRoutes = std::move(removedRoutes);
+
+	// Keep the settings of this network, as FromLayout does.
+	nw.m_lineChangePenalty = m_lineChangePenalty;
+	nw.m_crowdingCost = m_crowdingCost;
+	nw.m_flowBucketWidth = m_flowBucketWidth;
+	nw.m_flowBucketCount = m_flowBucketCount;
+	nw.m_flowBuckets.resize(nw.m_stations.size() * nw.m_flowBucketCount);
+
+	*this = std::move(nw);
+	return true;
+}
+
+bool TransportNetwork::AddStation(const Station& station)
+{
+	if (GetStationIndex(station.id) != kInvalidIndex) {
+		return false;
+	}
+
+	InsertStation(station);
+	InvalidateLayoutCaches();
+
+	return true;
+}
+
+bool TransportNetwork::AddLine(const Line& line)
+{
+	if (GetLineIndex(line.id) != kInvalidIndex) {
+		return false;
+	}
+
+	// Validate all routes before touching the network, so that a bad route
+	// does not leave a half-added line behind.
+	for (auto routeIt {line.routes.begin()}; routeIt != line.routes.end(); ++routeIt) {
+		if (routeIt->stops.size() < 2
+			|| GetRouteIndex(routeIt->id) != kInvalidIndex) {
+			return false;
+		}
+		for (const auto& stationId: routeIt->stops) {
+			if (GetStationIndex(stationId) == kInvalidIndex) {
+				return false;
+			}
+		}
+		auto sameId {[&routeIt](const Route& other) {
+			return other.id == routeIt->id;
+		}};
+		if (std::find_if(line.routes.begin(), routeIt, sameId) != routeIt) {
+			return false;
+		}
+	}
+
+	std::vector<std::pair<uint32_t, GraphEdge>> newEdges {};
+	InsertLine(line, newEdges);
+	InsertEdges(newEdges);
+	InvalidateLayoutCaches();
+
+	return true;
+}
+
+bool TransportNetwork::RecordPassengerEvent(
+    const PassengerEvent& event
+)
+{
+	return RecordPassengerEvent(
+		GetStationHandle(event.stationId),
+		event.type,
+		event.timestamp
+	);
+}
+
+std::vector<size_t> TransportNetwork::RecordPassengerEvents(
+	const std::vector<PassengerEvent>& events
+)
+{
+	std::vector<size_t> failed {};
+
+	auto& scratch {gPassengerEventScratch};
+	scratch.Prepare(m_stations.size());
+
+	// Feeds tend to send several events in a row for the same station, so we
+	// only hash the ID when it changes.
+	const Id* previousId {nullptr};
+	uint32_t station {kInvalidIndex};
+	for (size_t idx {0}; idx < events.size(); ++idx) {
+		const auto& event {events[idx]};
+		if (previousId == nullptr || event.stationId != *previousId) {
+			station = GetStationIndex(event.stationId);
+			previousId = &event.stationId;
+		}
+
+		int64_t delta {0};
+		switch (event.type) {
+			case PassengerEvent::Type::In:
+				delta = 1;
+				break;
+			case PassengerEvent::Type::Out:
+				delta = -1;
+				break;
+			default:
+				break;
+		}
+		if (station == kInvalidIndex || delta == 0) {
+			failed.push_back(idx);
+			continue;
+		}
+
+		if (scratch.stamps[station] != scratch.stamp) {
+			scratch.stamps[station] = scratch.stamp;
+			scratch.deltas[station] = 0;
+			scratch.stations.push_back(station);
+		}
+		scratch.deltas[station] += delta;
+
+		if (m_flowBucketCount != 0) {
+			RecordPassengerFlow(station, event.type, event.timestamp);
+		}
+	}
+
+	for (const auto station: scratch.stations) {
+		if (scratch.deltas[station] != 0) {
+			m_passengerCounts[station].count.fetch_add(
+				scratch.deltas[station],
+				std::memory_order_relaxed
+			);
+		}
+	}
+
+	return failed;
+}
+
+int64_t TransportNetwork::GetPassengerCount(
+	const Id& stationId
+) const
+{
+	return GetPassengerCount(GetStationHandle(stationId));
+}
+
+std::vector<Id> TransportNetwork::GetRoutesServingStation(
+	const Id& stationId
+) const
+{
+	std::vector<Id> servingRoutes {};
+
+	const auto& routes {GetRoutesServingStation(GetStationHandle(stationId))};
+	servingRoutes.reserve(routes.size());
+	for (const auto route: routes) {
+		servingRoutes.emplace_back(m_routeIds.Get(route.index));
+	}
+
+	return servingRoutes;
+}
+
+bool TransportNetwork::SetTravelTime(
+	const Id& stationIdA,
+	const Id& stationIdB,
+	const uint32_t travelTime
+)
+{
+	const auto stationA {GetStationIndex(stationIdA)};
+	const auto stationB {GetStationIndex(stationIdB)};
+	if (stationA == kInvalidIndex || stationB == kInvalidIndex) {
+		return false;
+	}
+
+	return SetTravelTime(stationA, stationB, travelTime);
+}
+
+uint32_t TransportNetwork::GetTravelTime(
+	const Id& stationIdA,
+	const Id& stationIdB
+) const
+{
+	const auto stationA {GetStationIndex(stationIdA)};
+	const auto stationB {GetStationIndex(stationIdB)};
+	if (stationA == kInvalidIndex || stationB == kInvalidIndex) {
+		return 0;
+	}
+
+	return GetTravelTime(stationA, stationB);
+}
+
+uint32_t  TransportNetwork::GetTravelTime(
+	const Id& lineId,
+	const Id& routeId,
+	const Id& stationIdA,
+	const Id& stationIdB
+) const
+{
+	const auto stationA {GetStationIndex(stationIdA)};
+	const auto stationB {GetStationIndex(stationIdB)};
+	if (stationA == kInvalidIndex || stationB == kInvalidIndex) {
+		return 0;
+	}
+
+	const auto line {GetLineIndex(lineId)};
+	if (line == kInvalidIndex) {
+		return 0;
+	}
+
+	const auto route {GetRouteIndex(line, routeId)};
+	if (route == kInvalidIndex) {
+		return 0;
+	}
+
+	return GetTravelTime(route, stationA, stationB);
+}
+
+StationHandle TransportNetwork::GetStationHandle(
+	const Id& stationId
+) const
+{
+	return {GetStationIndex(stationId)};
+}
+
+LineHandle TransportNetwork::GetLineHandle(
+	const Id& lineId
+) const
+{
+	return {GetLineIndex(lineId)};
+}
+
+RouteHandle TransportNetwork::GetRouteHandle(
+	const Id& lineId,
+	const Id& routeId
+) const
+{
+	const auto line {GetLineIndex(lineId)};
+	if (line == kInvalidIndex) {
+		return {};
+	}
+
+	return {GetRouteIndex(line, routeId)};
+}
+
+std::string_view TransportNetwork::GetStationId(
+	const StationHandle station
+) const
+{
+	if (station.index >= m_stationIds.Size() || m_removedStations[station.index]) {
+		return {};
+	}
+
+	return m_stationIds.Get(station.index);
+}
+
+std::string_view TransportNetwork::GetLineId(
+	const LineHandle line
+) const
+{
+	if (line.index >= m_lineIds.Size() || m_removedLines[line.index]) {
+		return {};
+	}
+
+	return m_lineIds.Get(line.index);
+}
+
+std::string_view TransportNetwork::GetRouteId(
+	const RouteHandle route
+) const
+{
+	if (route.index >= m_routeIds.Size() || m_removedRoutes[route.index]) {
+		return {};
+	}
+
+	return m_routeIds.Get(route.index);
+}
+
+bool TransportNetwork::RecordPassengerEvent(
+	const StationHandle station,
+	const PassengerEvent::Type type,
+	const std::chrono::system_clock::time_point timestamp
+)
+{
+	if (!IsValidStation(station)) {
+		return false;
+	}
+
+	switch (type) {
+		case PassengerEvent::Type::In:
+			m_passengerCounts[station.index].count.fetch_add(
+				1,
+				std::memory_order_relaxed
+			);
+			break;
+		case PassengerEvent::Type::Out:
+			m_passengerCounts[station.index].count.fetch_sub(
+				1,
+				std::memory_order_relaxed
+			);
+			break;
+		default:
+			return false;
+	}
+	if (m_flowBucketCount != 0) {
+		RecordPassengerFlow(station.index, type, timestamp);
+	}
+
+	return true;
+}
+
+int64_t TransportNetwork::GetPassengerCount(
+	const StationHandle station
+) const
+{
+	if (!IsValidStation(station)) {
+		throw std::runtime_error("Can't find needed station");
+	}
+
+	return m_passengerCounts[station.index].count.load(
+		std::memory_order_relaxed
+	);
+}
+
+bool TransportNetwork::EnablePassengerFlows(
+	const std::chrono::seconds bucketWidth,
+	const size_t nBuckets
+)
+{
+	if (bucketWidth <= std::chrono::seconds::zero() || nBuckets == 0) {
+		return false;
+	}
+	if (bucketWidth == m_flowBucketWidth && nBuckets == m_flowBucketCount) {
+		return true;
+	}
+
+	m_flowBucketWidth = bucketWidth;
+	m_flowBucketCount = nBuckets;
+	m_flowBuckets.clear();
+	m_flowBuckets.resize(m_stations.size() * m_flowBucketCount);
+
+	return true;
+}
+
+bool TransportNetwork::HasPassengerFlows() const
+{
+	return m_flowBucketCount != 0;
+}
+
+PassengerFlow TransportNetwork::GetPassengerFlow(
+	const StationHandle station,
+	const std::chrono::system_clock::time_point from,
+	const std::chrono::system_clock::time_point to
+) const
+{
+	PassengerFlow flow {};
+	if (!IsValidStation(station)
+		|| m_flowBucketCount == 0
+		|| from >= to) {
+		return flow;
+	}
+
+	const auto first {GetFlowBucket(from)};
+	const auto last {
+		GetFlowBucket(to - std::chrono::system_clock::duration {1}) + 1
+	};
+	auto add {[&flow](const PassengerFlow& bucketFlow) {
+		flow.in += bucketFlow.in;
+		flow.out += bucketFlow.out;
+	}};
+	if (static_cast<uint64_t>(last - first) < m_flowBucketCount) {
+		for (auto bucket {first}; bucket < last; ++bucket) {
+			add(GetFlowBucketCounts(station.index, bucket));
+		}
+	} else {
+		// The window covers the whole ring: visit each slot once and keep the
+		// counts of the buckets that fall in the window.
+		const auto* slots {&m_flowBuckets[station.index * m_flowBucketCount]};
+		for (size_t slot {0}; slot < m_flowBucketCount; ++slot) {
+			const auto in {slots[slot].in.load(std::memory_order_relaxed)};
+			const auto out {slots[slot].out.load(std::memory_order_relaxed)};
+			const int64_t inBucket = in >> 32;
+			const int64_t outBucket = out >> 32;
+			add({
+				inBucket >= first && inBucket < last ? in & 0xffffffff : 0,
+				outBucket >= first && outBucket < last ? out & 0xffffffff : 0,
+			});
+		}
+	}
+
+	return flow;
+}
+
+std::vector<PassengerFlowRate> TransportNetwork::GetPassengerFlowRates(
+	const StationHandle station,
+	const std::chrono::system_clock::time_point from,
+	const std::chrono::system_clock::time_point to,
+	const std::chrono::seconds window
+) const
+{
+	std::vector<PassengerFlowRate> rates {};
+	if (!IsValidStation(station)
+		|| m_flowBucketCount == 0
+		|| from >= to) {
+		return rates;
+	}
+
+	const auto first {GetFlowBucket(from)};
+	const auto last {
+		GetFlowBucket(to - std::chrono::system_clock::duration {1}) + 1
+	};
+	if (static_cast<uint64_t>(last - first) > m_flowBucketCount) {
+		return rates;
+	}
+	const int64_t windowBuckets {std::max<int64_t>(
+		1,
+		(window + m_flowBucketWidth - std::chrono::seconds {1}) / m_flowBucketWidth
+	)};
+	const double windowMinutes {
+		windowBuckets * m_flowBucketWidth.count() / 60.0
+	};
+
+	// Sliding sum over the buckets in (bucket - windowBuckets, bucket].
+	PassengerFlow sum {};
+	for (auto bucket {first - windowBuckets + 1}; bucket < first; ++bucket) {
+		const auto counts {GetFlowBucketCounts(station.index, bucket)};
+		sum.in += counts.in;
+		sum.out += counts.out;
+	}
+	rates.reserve(last - first);
+	for (auto bucket {first}; bucket < last; ++bucket) {
+		const auto added {GetFlowBucketCounts(station.index, bucket)};
+		sum.in += added.in;
+		sum.out += added.out;
+		rates.push_back({sum.in / windowMinutes, sum.out / windowMinutes});
+		const auto removed {
+			GetFlowBucketCounts(station.index, bucket - windowBuckets + 1)
+		};
+		sum.in -= removed.in;
+		sum.out -= removed.out;
+	}
+
+	return rates;
+}
+
+const std::vector<RouteHandle>& TransportNetwork::GetRoutesServingStation(
+	const StationHandle station
+) const
+{
+	static const std::vector<RouteHandle> noRoutes {};
+	if (!IsValidStation(station)) {
+		return noRoutes;
+	}
+
+	return m_stations[station.index].servingRoutes;
+}
+
+uint32_t TransportNetwork::GetTravelTime(
+	const StationHandle stationA,
+	const StationHandle stationB
+) const
+{
+	if (!IsValidStation(stationA)
+		|| !IsValidStation(stationB)) {
+		return 0;
+	}
+
+	return GetTravelTime(stationA.index, stationB.index);
+}
+
+uint32_t TransportNetwork::GetTravelTime(
+	const RouteHandle route,
+	const StationHandle stationA,
+	const StationHandle stationB
+) const
+{
+	if (!IsValidRoute(route)
+		|| !IsValidStation(stationA)
+		|| !IsValidStation(stationB)) {
+		return 0;
+	}
+
+	return GetTravelTime(route.index, stationA.index, stationB.index);
+}
+
+void TransportNetwork::SetLineChangePenalty(
+	const uint32_t penalty
+)
+{
+	m_lineChangePenalty = penalty;
+}
+
+uint32_t TransportNetwork::GetLineChangePenalty() const
+{
+	return m_lineChangePenalty;
+}
+
+Itinerary TransportNetwork::GetFastestPath(
+	const Id& stationIdA,
+	const Id& stationIdB
+) const
+{
+	Itinerary itinerary {};
+
+	const auto stationA {GetStationIndex(stationIdA)};
+	const auto stationB {GetStationIndex(stationIdB)};
+	if (stationA == kInvalidIndex || stationB == kInvalidIndex) {
+		return itinerary;
+	}
+
+	auto& pathEdges {gPathSearchScratch.pathEdges};
+	const auto totalTime {
+		FindFastestPath(stationA, stationB, m_lineChangePenalty, pathEdges)
+	};
+	if (totalTime == kUnreachable) {
+		return itinerary;
+	}
+
+	itinerary.stations.reserve(pathEdges.size() + 1);
+	itinerary.routes.reserve(pathEdges.size());
+	itinerary.stations.emplace_back(m_stationIds.Get(stationA));
+	for (const auto edge: pathEdges) {
+		itinerary.stations.emplace_back(m_stationIds.Get(m_edges[edge].next));
+		itinerary.routes.emplace_back(m_routeIds.Get(m_edges[edge].route));
+	}
+	itinerary.totalTime = totalTime;
+
+	return itinerary;
+}
+
+bool TransportNetwork::GetFastestPath(
+	const StationHandle stationA,
+	const StationHandle stationB,
+	ItineraryHandles& itinerary
+) const
+{
+	itinerary.stations.clear();
+	itinerary.routes.clear();
+	itinerary.totalTime = 0;
+	if (!IsValidStation(stationA)
+		|| !IsValidStation(stationB)) {
+		return false;
+	}
+
+	auto& pathEdges {gPathSearchScratch.pathEdges};
+	const auto totalTime {
+		FindFastestPath(
+			stationA.index,
+			stationB.index,
+			m_lineChangePenalty,
+			pathEdges
+		)
+	};
+	if (totalTime == kUnreachable) {
+		return false;
+	}
+
+	itinerary.stations.push_back(stationA);
+	for (const auto edge: pathEdges) {
+		itinerary.stations.push_back({m_edges[edge].next});
+		itinerary.routes.push_back({m_edges[edge].route});
+	}
+	itinerary.totalTime = totalTime;
+
+	return true;
+}
+
+void TransportNetwork::BuildContractionHierarchy()
+{
+	std::vector<ContractionHierarchy::Arc> arcs {};
+	arcs.reserve(m_edges.size());
+	for (uint32_t station {0}; station < m_stations.size(); ++station) {
+		for (auto edge {m_edgeOffsets[station]};
+			edge < m_edgeOffsets[station + 1]; ++edge) {
+			if (m_edges[edge].route == kInvalidIndex) {
+				continue;
+			}
+			// Closed edges are kept in the hierarchy, so that they can be
+			// opened again without contracting the graph again.
+			arcs.push_back({
+				station,
+				m_edges[edge].next,
+				m_closedEdges[edge] ? kUnreachable : m_edges[edge].travelTime
+			});
+		}
+	}
+	m_hierarchy = ContractionHierarchy(m_stations.size(), arcs);
+}
+
+bool TransportNetwork::HasContractionHierarchy() const
+{
+	return !m_hierarchy.Empty();
+}
+
+uint32_t TransportNetwork::GetFastestTravelTime(
+	const Id& stationIdA,
+	const Id& stationIdB
+) const
+{
+	return GetFastestTravelTime(
+		GetStationHandle(stationIdA),
+		GetStationHandle(stationIdB)
+	);
+}
+
+uint32_t TransportNetwork::GetFastestTravelTime(
+	const StationHandle stationA,
+	const StationHandle stationB
+) const
+{
+	if (!IsValidStation(stationA)
+		|| !IsValidStation(stationB)) {
+		return kUnreachable;
+	}
+
+	if (!m_hierarchy.Empty()) {
+		return m_hierarchy.GetDistance(stationA.index, stationB.index);
+	}
+
+	return FindFastestPath(
+		stationA.index,
+		stationB.index,
+		0,
+		gPathSearchScratch.pathEdges
+	);
+}
+
+uint32_t TransportNetwork::GetStationCount() const
+{
+	return m_stations.size();
+}
+
+void TransportNetwork::BuildTravelTimeMatrix()
+{
+	const size_t nStations {m_stations.size()};
+	m_travelTimeMatrix.assign(nStations * nStations, kUnreachable);
+
+	std::vector<uint32_t> rows(nStations);
+	std::iota(rows.begin(), rows.end(), 0);
+	ComputeMatrixRows(rows);
+}
+
+bool TransportNetwork::HasTravelTimeMatrix() const
+{
+	return !m_travelTimeMatrix.empty();
+}
+
+uint32_t TransportNetwork::LookupTravelTime(
+	const StationHandle stationA,
+	const StationHandle stationB
+) const
+{
+	return m_travelTimeMatrix[
+		static_cast<size_t>(stationA.index) * m_stations.size() + stationB.index
+	];
+}
+
+void TransportNetwork::SetCrowdingCost(
+	const double costPerPassenger
+)
+{
+	m_crowdingCost = costPerPassenger;
+}
+
+double TransportNetwork::GetCrowdingCost() const
+{
+	return m_crowdingCost;
+}
+
+std::vector<Itinerary> TransportNetwork::GetTravelSuggestions(
+	const Id& stationIdA,
+	const Id& stationIdB,
+	const size_t count
+) const
+{
+	std::vector<ItineraryHandles> suggestionHandles {};
+	const auto nSuggestions {GetTravelSuggestions(
+		GetStationHandle(stationIdA),
+		GetStationHandle(stationIdB),
+		count,
+		suggestionHandles
+	)};
+
+	std::vector<Itinerary> suggestions(nSuggestions);
+	for (size_t idx {0}; idx < nSuggestions; ++idx) {
+		const auto& handles {suggestionHandles[idx]};
+		auto& itinerary {suggestions[idx]};
+		for (const auto station: handles.stations) {
+			itinerary.stations.emplace_back(m_stationIds.Get(station.index));
+		}
+		for (const auto route: handles.routes) {
+			itinerary.routes.emplace_back(m_routeIds.Get(route.index));
+		}
+		itinerary.totalTime = handles.totalTime;
+		itinerary.crowdingCost = handles.crowdingCost;
+	}
+
+	return suggestions;
+}
+
+size_t TransportNetwork::GetTravelSuggestions(
+	const StationHandle stationA,
+	const StationHandle stationB,
+	const size_t count,
+	std::vector<ItineraryHandles>& suggestions
+) const
+{
+	const auto maxSuggestions {std::min(count, kMaxTravelSuggestions)};
+	if (!IsValidStation(stationA)
+		|| !IsValidStation(stationB)
+		|| stationA == stationB
+		|| maxSuggestions == 0) {
+		return 0;
+	}
+
+	// Yen's algorithm: each itinerary after the first one is the best
+	// deviation from one of the itineraries found before it. A deviation keeps
+	// the first stops of an itinerary, the root, and continues with the best
+	// spur path from its last stop that takes neither a station of the root
+	// nor the next edge of any itinerary found with the same root.
+	auto& scratch {gPathSearchScratch};
+	auto& paths {scratch.paths};
+	auto& candidates {scratch.candidates};
+	auto& bannedEdges {scratch.bannedEdges};
+	auto& bannedStations {scratch.bannedStations};
+	auto& spurEdges {scratch.pathEdges};
+	bannedStations.assign(m_stations.size(), false);
+	bannedEdges.clear();
+	size_t nPaths {0};
+	size_t nCandidates {0};
+
+	auto getPath {[](auto& items, const size_t idx) -> SuggestionPath& {
+		if (items.size() <= idx) {
+			items.resize(idx + 1);
+		}
+		return items[idx];
+	}};
+	auto setCosts {[this](SuggestionPath& path) {
+		path.totalTime = 0;
+		path.crowdingCost = 0;
+		for (size_t idx {0}; idx < path.edges.size(); ++idx) {
+			const auto& edge {m_edges[path.edges[idx]]};
+			const auto changesLine {
+				idx > 0 && m_edges[path.edges[idx - 1]].line != edge.line
+			};
+			path.totalTime += edge.travelTime
+				+ (changesLine ? m_lineChangePenalty : 0);
+			path.crowdingCost += GetCrowdingCost(edge.next);
+		}
+	}};
+
+	bannedStations[stationA.index] = true;
+	if (!FindSpurPath(
+		stationA.index,
+		kInvalidIndex,
+		stationB.index,
+		spurEdges
+	)) {
+		return 0;
+	}
+	auto& first {getPath(paths, nPaths++)};
+	first.edges.assign(spurEdges.begin(), spurEdges.end());
+	setCosts(first);
+
+	while (nPaths < maxSuggestions) {
+		const auto lastPath {nPaths - 1};
+		const auto nEdges {paths[lastPath].edges.size()};
+		for (size_t spur {0}; spur < nEdges; ++spur) {
+			const auto* root {paths[lastPath].edges.data()};
+			bannedEdges.clear();
+			for (size_t idx {0}; idx < nPaths; ++idx) {
+				const auto& edges {paths[idx].edges};
+				if (edges.size() > spur
+					&& std::equal(root, root + spur, edges.begin())) {
+					bannedEdges.push_back(edges[spur]);
+				}
+			}
+			for (size_t idx {0}; idx < spur; ++idx) {
+				bannedStations[m_edges[root[idx]].next] = true;
+			}
+			const auto spurStation {
+				spur == 0 ? stationA.index : m_edges[root[spur - 1]].next
+			};
+			const auto found {FindSpurPath(
+				spurStation,
+				spur == 0 ? kInvalidIndex : root[spur - 1],
+				stationB.index,
+				spurEdges
+			)};
+			for (size_t idx {0}; idx < spur; ++idx) {
+				bannedStations[m_edges[root[idx]].next] = false;
+			}
+			if (!found) {
+				continue;
+			}
+
+			auto& candidate {getPath(candidates, nCandidates)};
+			root = paths[lastPath].edges.data();
+			candidate.edges.assign(root, root + spur);
+			candidate.edges.insert(
+				candidate.edges.end(),
+				spurEdges.begin(),
+				spurEdges.end()
+			);
+			const auto isDuplicate {std::any_of(
+				candidates.begin(),
+				candidates.begin() + nCandidates,
+				[&candidate](const auto& other) {
+					return other.edges == candidate.edges;
+				}
+			)};
+			if (!isDuplicate) {
+				setCosts(candidate);
+				++nCandidates;
+			}
+		}
+		if (nCandidates == 0) {
+			break;
+		}
+
+		// The best candidate is the next itinerary.
+		auto best {candidates.begin()};
+		const auto lastCandidate {candidates.begin() + nCandidates};
+		for (auto it {candidates.begin()}; it != lastCandidate; ++it) {
+			if (it->totalTime + it->crowdingCost
+				< best->totalTime + best->crowdingCost) {
+				best = it;
+			}
+		}
+		std::swap(getPath(paths, nPaths), *best);
+		++nPaths;
+		std::swap(*best, candidates[--nCandidates]);
+	}
+
+	for (size_t idx {0}; idx < nPaths; ++idx) {
+		if (suggestions.size() <= idx) {
+			suggestions.resize(idx + 1);
+		}
+		auto& itinerary {suggestions[idx]};
+		itinerary.stations.clear();
+		itinerary.routes.clear();
+		itinerary.stations.push_back(stationA);
+		for (const auto edge: paths[idx].edges) {
+			itinerary.stations.push_back({m_edges[edge].next});
+			itinerary.routes.push_back({m_edges[edge].route});
+		}
+		itinerary.totalTime = paths[idx].totalTime;
+		itinerary.crowdingCost = paths[idx].crowdingCost;
+	}
+
+	return nPaths;
+}
+
+bool TransportNetwork::DisableRoute(
+	const RouteHandle route
+)
+{
+	return SetRouteDisabled(route, true);
+}
+
+bool TransportNetwork::EnableRoute(
+	const RouteHandle route
+)
+{
+	return SetRouteDisabled(route, false);
+}
+
+bool TransportNetwork::DisableStation(
+	const StationHandle station
+)
+{
+	return SetStationDisabled(station, true);
+}
+
+bool TransportNetwork::EnableStation(
+	const StationHandle station
+)
+{
+	return SetStationDisabled(station, false);
+}
+
+bool TransportNetwork::DisableEdge(
+	const StationHandle stationA,
+	const StationHandle stationB
+)
+{
+	return SetEdgeDisabled(stationA, stationB, true);
+}
+
+bool TransportNetwork::EnableEdge(
+	const StationHandle stationA,
+	const StationHandle stationB
+)
+{
+	return SetEdgeDisabled(stationA, stationB, false);
+}
+
+// Private functions
+
+// IdTable
+
+uint32_t TransportNetwork::IdTable::Find(
+	std::string_view id
+) const
+{
+	if (m_slots.empty()) {
+		return kInvalidIndex;
+	}
+
+	const size_t mask {m_slots.size() - 1};
+	for (size_t slot {Hash(id) & mask};;
+		slot = (slot + 1) & mask) {
+		const auto index {m_slots[slot]};
+		if (index == kInvalidIndex || Get(index) == id) {
+			return index;
+		}
+	}
+}
+
+uint32_t TransportNetwork::IdTable::Insert(
+	std::string_view id
+)
+{
+	// Keep the load factor at or below 1/2.
+	const auto index {Size()};
+	if (2 * (static_cast<size_t>(index) + 1) > m_slots.size()) {
+		Rehash(std::max<size_t>(16, 2 * m_slots.size()));
+	}
+
+	m_chars.append(id);
+	m_offsets.push_back(m_chars.size());
+
+	const size_t mask {m_slots.size() - 1};
+	size_t slot {Hash(id) & mask};
+	while (m_slots[slot] != kInvalidIndex) {
+		slot = (slot + 1) & mask;
+	}
+	m_slots[slot] = index;
+
+	return index;
+}
+
+std::string_view TransportNetwork::IdTable::Get(
+	const uint32_t index
+) const
+{
+	return std::string_view {m_chars}.substr(
+		m_offsets[index],
+		m_offsets[index + 1] - m_offsets[index]
+	);
+}
+
+uint32_t TransportNetwork::IdTable::Size() const
+{
+	return m_offsets.size() - 1;
+}
+
+void TransportNetwork::IdTable::Reserve(
+	const size_t nIds
+)
+{
+	m_offsets.reserve(nIds + 1);
+	size_t nSlots {std::max<size_t>(16, m_slots.size())};
+	while (nSlots < 2 * nIds) {
+		nSlots *= 2;
+	}
+	if (nSlots > m_slots.size()) {
+		Rehash(nSlots);
+	}
+}
+
+void TransportNetwork::IdTable::Rehash(
+	const size_t nSlots
+)
+{
+	m_slots.assign(nSlots, kInvalidIndex);
+	const size_t mask {nSlots - 1};
+	for (uint32_t index {0}; index < Size(); ++index) {
+		size_t slot {Hash(Get(index)) & mask};
+		while (m_slots[slot] != kInvalidIndex) {
+			slot = (slot + 1) & mask;
+		}
+		m_slots[slot] = index;
+	}
+}
+
+size_t TransportNetwork::IdTable::Hash(
+	std::string_view id
+)
+{
+	return SnapshotFormat::HashId(id);
+}
+
+bool TransportNetwork::IdTable::IsValid() const
+{
+	// Find() relies on the slot array having a power-of-two size and at least
+	// one free slot.
+	if (!SnapshotReader::IsValidOffsets(m_offsets, m_chars.size())) {
+		return false;
+	}
+	if (m_slots.empty()) {
+		return Size() == 0;
+	}
+	if ((m_slots.size() & (m_slots.size() - 1)) != 0 || m_slots.size() <= Size()) {
+		return false;
+	}
+	size_t nUsed {0};
+	for (const auto index: m_slots) {
+		if (index != kInvalidIndex) {
+			if (index >= Size()) {
+				return false;
+			}
+			++nUsed;
+		}
+	}
+	return nUsed == Size();
+}
+
+// NameTable
+
+void TransportNetwork::NameTable::Append(
+	std::string_view name
+)
+{
+	ranges.emplace_back(chars.size(), chars.size() + name.size());
+	chars.append(name);
+}
+
+void TransportNetwork::NameTable::Set(
+	const uint32_t index,
+	std::string_view name
+)
+{
+	ranges[index] = {chars.size(), chars.size() + name.size()};
+	chars.append(name);
+}
+
+std::string_view TransportNetwork::NameTable::Get(
+	const uint32_t index
+) const
+{
+	const auto [first, last] {ranges[index]};
+	return std::string_view {chars}.substr(first, last - first);
+}
+
+uint32_t TransportNetwork::NameTable::Size() const
+{
+	return ranges.size();
+}
+
+// TransportNetwork
+
+uint32_t TransportNetwork::GetStationIndex(
+	const Id& stationId
+) const
+{
+	const auto station {m_stationIds.Find(stationId)};
+	if (station == kInvalidIndex || m_removedStations[station]) {
+		return kInvalidIndex;
+	}
+
+	return station;
+}
+
+uint32_t TransportNetwork::GetLineIndex(
+	const Id& lineId
+) const
+{
+	const auto line {m_lineIds.Find(lineId)};
+	if (line == kInvalidIndex || m_removedLines[line]) {
+		return kInvalidIndex;
+	}
+
+	return line;
+}
+
+uint32_t TransportNetwork::GetRouteIndex(
+	const uint32_t line,
+	const Id& routeId
+) const
+{
+	const auto route {GetRouteIndex(routeId)};
+	if (route == kInvalidIndex || m_routes[route].line != line) {
+		return kInvalidIndex;
+	}
+
+	return route;
+}
+
+uint32_t TransportNetwork::GetRouteIndex(
+	const Id& routeId
+) const
+{
+	const auto route {m_routeIds.Find(routeId)};
+	if (route == kInvalidIndex || m_removedRoutes[route]) {
+		return kInvalidIndex;
+	}
+
+	return route;
+}
+
+bool TransportNetwork::IsValidStation(
+	const StationHandle station
+) const
+{
+	return station.index < m_stations.size()
+		&& !m_removedStations[station.index];
+}
+
+bool TransportNetwork::IsValidRoute(
+	const RouteHandle route
+) const
+{
+	return route.index < m_routes.size() && !m_removedRoutes[route.index];
+}
+
+TransportNetwork::EdgeRange TransportNetwork::GetEdges(
+	const uint32_t station
+) const
+{
+	const auto* edges {m_edges.data()};
+	return {
+		edges + m_edgeOffsets[station],
+		edges + m_edgeOffsets[station + 1]
+	};
+}
+
+void TransportNetwork::Reserve(
+	const size_t nStations,
+	const size_t nLines,
+	const size_t nRoutes,
+	const size_t nStops
+)
+{
+	m_stationIds.Reserve(nStations);
+	m_stationNames.ranges.reserve(nStations);
+	m_stations.reserve(nStations);
+	m_passengerCounts.reserve(nStations);
+	m_lineIds.Reserve(nLines);
+	m_lineNames.ranges.reserve(nLines);
+	m_lines.reserve(nLines);
+	m_routeIds.Reserve(nRoutes);
+	m_routeNames.ranges.reserve(nRoutes);
+	m_routes.reserve(nRoutes);
+	m_routeStops.reserve(nStops);
+	m_cumulativeTravelTimes.reserve(nStops);
+	m_stopPositions.reserve(nStops);
+}
+
+void TransportNetwork::IndexRouteStops(
+	const uint32_t route
+)
+{
+	const auto& routeInternal {m_routes[route]};
+	const auto first {m_stopPositions.begin() + routeInternal.firstStop};
+	for (uint32_t position {0}; position < routeInternal.nStops; ++position) {
+		first[position] = {
+			m_routeStops[routeInternal.firstStop + position],
+			position
+		};
+	}
+
+	// Ties are sorted by position, so a station that appears twice resolves
+	// to its first stop.
+	std::sort(first, first + routeInternal.nStops);
+}
+
+uint32_t TransportNetwork::GetRouteEdge(
+	const uint32_t route,
+	const uint32_t position
+) const
+{
+	const auto* stops {m_routeStops.data() + m_routes[route].firstStop};
+	for (const auto& edge: GetEdges(stops[position])) {
+		if (edge.route == route && edge.next == stops[position + 1]) {
+			return &edge - m_edges.data();
+		}
+	}
+	return kInvalidIndex;
+}
+
+uint32_t TransportNetwork::GetStopPosition(
+	const uint32_t route,
+	const uint32_t station
+) const
+{
+	const auto& routeInternal {m_routes[route]};
+	const auto first {m_stopPositions.begin() + routeInternal.firstStop};
+	const auto last {first + routeInternal.nStops};
+	const auto it {std::lower_bound(
+		first,
+		last,
+		std::pair {station, uint32_t {0}}
+	)};
+	if (it == last || it->first != station) {
+		return kInvalidIndex;
+	}
+
+	return it->second;
+}
+
+uint32_t TransportNetwork::InsertStation(
+	const Station& station
+)
+{
+	auto stationIndex {m_stationIds.Find(station.id)};
+	if (stationIndex != kInvalidIndex) {
+		// A station added again starts without the passengers of the removed
+		// one.
+		m_removedStations[stationIndex] = false;
+		m_stationNames.Set(stationIndex, station.name);
+		m_passengerCounts[stationIndex].count.store(0, std::memory_order_relaxed);
+		for (size_t slot {0}; slot < m_flowBucketCount; ++slot) {
+			auto& bucket {m_flowBuckets[stationIndex * m_flowBucketCount + slot]};
+			bucket.in.store(0, std::memory_order_relaxed);
+			bucket.out.store(0, std::memory_order_relaxed);
+		}
+		return stationIndex;
+	}
+
+	stationIndex = m_stationIds.Insert(station.id);
+	m_stationNames.Append(station.name);
+	m_stations.emplace_back();
+	m_disabledStations.push_back(false);
+	m_removedStations.push_back(false);
+	m_passengerCounts.emplace_back();
+	m_flowBuckets.resize(m_stations.size() * m_flowBucketCount);
+	m_edgeOffsets.push_back(m_edges.size());
+
+	return stationIndex;
+}
+
+uint32_t TransportNetwork::InsertLine(
+	const Line& line,
+	std::vector<std::pair<uint32_t, GraphEdge>>& newEdges
+)
+{
+	auto lineIndex {m_lineIds.Find(line.id)};
+	if (lineIndex != kInvalidIndex) {
+		m_removedLines[lineIndex] = false;
+		m_lineNames.Set(lineIndex, line.name);
+	} else {
+		lineIndex = m_lineIds.Insert(line.id);
+		m_lineNames.Append(line.name);
+		m_lines.emplace_back();
+		m_removedLines.push_back(false);
+	}
+
+	for (const auto& route: line.routes) {
+		AddRouteToLine(lineIndex, route, newEdges);
+	}
+
+	return lineIndex;
 }
 
-uint32_t  TransportNetwork::GetTravelTime(
-	const Id& lineId,
-	const Id& routeId,
-	const Id& stationIdA,
-	const Id& stationIdB
+uint32_t TransportNetwork::AddRouteToLine(
+	const uint32_t line,
+	const Route& route,
+	std::vector<std::pair<uint32_t, GraphEdge>>& newEdges
+)
+{
+	const auto firstStop {static_cast<uint32_t>(m_routeStops.size())};
+	for (const auto& stationId: route.stops) {
+		m_routeStops.push_back(GetStationIndex(stationId));
+	}
+	m_cumulativeTravelTimes.resize(m_routeStops.size(), 0);
+	m_stopPositions.resize(m_routeStops.size());
+	const RouteInternal routeInternal {
+		line,
+		firstStop,
+		static_cast<uint32_t>(route.stops.size())
+	};
+
+	auto routeIndex {m_routeIds.Find(route.id)};
+	if (routeIndex != kInvalidIndex) {
+		m_removedRoutes[routeIndex] = false;
+		m_routeNames.Set(routeIndex, route.name);
+		m_routes[routeIndex] = routeInternal;
+	} else {
+		routeIndex = m_routeIds.Insert(route.id);
+		m_routeNames.Append(route.name);
+		m_disabledRoutes.push_back(false);
+		m_removedRoutes.push_back(false);
+		m_routes.push_back(routeInternal);
+	}
+	m_lines[line].routes.push_back(routeIndex);
+	IndexRouteStops(routeIndex);
+
+	for (auto idx {firstStop}; idx + 1 < m_routeStops.size(); ++idx) {
+		newEdges.emplace_back(
+			m_routeStops[idx],
+			GraphEdge{routeIndex, line, m_routeStops[idx + 1], 0}
+		);
+	}
+
+	// Each stop appears only once in a route, so the route is recorded once
+	// per station, whether it leaves from or terminates at the station.
+	for (auto idx {firstStop}; idx < m_routeStops.size(); ++idx) {
+		m_stations[m_routeStops[idx]].servingRoutes.push_back({routeIndex});
+	}
+
+	return routeIndex;
+}
+
+void TransportNetwork::RemoveRoute(
+	const uint32_t route
+)
+{
+	auto& routeInternal {m_routes[route]};
+	const auto* stops {m_routeStops.data() + routeInternal.firstStop};
+
+	// Free slots are closed, but they are not counted as closed edges.
+	for (uint32_t position {0}; position + 1 < routeInternal.nStops; ++position) {
+		const auto edge {GetRouteEdge(route, position)};
+		m_nClosedEdges -= m_closedEdges[edge] ? 1 : 0;
+		m_edges[edge] = {};
+		m_disabledEdges[edge] = false;
+		m_closedEdges[edge] = true;
+	}
+
+	auto erase {[](auto& items, const auto item) {
+		items.erase(std::remove(items.begin(), items.end(), item), items.end());
+	}};
+	for (uint32_t position {0}; position < routeInternal.nStops; ++position) {
+		erase(m_stations[stops[position]].servingRoutes, RouteHandle {route});
+	}
+	erase(m_lines[routeInternal.line].routes, route);
+
+	routeInternal.nStops = 0;
+	m_disabledRoutes[route] = false;
+	m_removedRoutes[route] = true;
+}
+
+void TransportNetwork::InsertEdges(
+	const std::vector<std::pair<uint32_t, GraphEdge>>& newEdges
+)
+{
+	if (newEdges.empty()) {
+		return;
+	}
+
+	// New edges are closed if they leave or reach a station that is out of
+	// service.
+	auto isClosed {[this](const uint32_t from, const GraphEdge& edge) {
+		return m_disabledRoutes[edge.route]
+			|| m_disabledStations[from]
+			|| m_disabledStations[edge.next];
+	}};
+
+	// Fill the free slots left by removed routes first: the CSR arrays only
+	// need to be rebuilt for the edges that do not fit in their station row.
+	std::vector<std::pair<uint32_t, GraphEdge>> pendingEdges {};
+	for (const auto& [from, edge]: newEdges) {
+		auto slot {m_edgeOffsets[from]};
+		while (slot < m_edgeOffsets[from + 1]
+			&& m_edges[slot].route != kInvalidIndex) {
+			++slot;
+		}
+		if (slot == m_edgeOffsets[from + 1]) {
+			pendingEdges.emplace_back(from, edge);
+			continue;
+		}
+		const bool closed {isClosed(from, edge)};
+		m_edges[slot] = edge;
+		m_disabledEdges[slot] = false;
+		m_closedEdges[slot] = closed;
+		m_nClosedEdges += closed ? 1 : 0;
+	}
+	if (pendingEdges.empty()) {
+		return;
+	}
+
+	// Count the edges leaving each station, then rebuild the CSR arrays in a
+	// single pass. The existing edges of a station keep their order, the
+	// remaining free slots are dropped and the new edges are appended.
+	const auto nStations {m_stations.size()};
+	std::vector<uint32_t> offsets(nStations + 1, 0);
+	for (size_t idx {0}; idx < nStations; ++idx) {
+		for (const auto& edge: GetEdges(idx)) {
+			offsets[idx + 1] += edge.route != kInvalidIndex ? 1 : 0;
+		}
+	}
+	for (const auto& [from, _]: pendingEdges) {
+		++offsets[from + 1];
+	}
+	std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+	// The out-of-service state of the edges moves along with them.
+	std::vector<GraphEdge> edges(offsets[nStations]);
+	std::vector<bool> disabledEdges(edges.size(), false);
+	std::vector<bool> closedEdges(edges.size(), false);
+	std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+	for (size_t idx {0}; idx < nStations; ++idx) {
+		for (auto edge {m_edgeOffsets[idx]}; edge < m_edgeOffsets[idx + 1]; ++edge) {
+			if (m_edges[edge].route == kInvalidIndex) {
+				continue;
+			}
+			edges[cursor[idx]] = m_edges[edge];
+			disabledEdges[cursor[idx]] = m_disabledEdges[edge];
+			closedEdges[cursor[idx]] = m_closedEdges[edge];
+			++cursor[idx];
+		}
+	}
+	for (const auto& [from, edge]: pendingEdges) {
+		const bool closed {isClosed(from, edge)};
+		closedEdges[cursor[from]] = closed;
+		m_nClosedEdges += closed ? 1 : 0;
+		edges[cursor[from]++] = edge;
+	}
+
+	m_edges = std::move(edges);
+	m_edgeOffsets = std::move(offsets);
+	m_disabledEdges = std::move(disabledEdges);
+	m_closedEdges = std::move(closedEdges);
+}
+
+bool TransportNetwork::SetTravelTime(
+	const uint32_t stationA,
+	const uint32_t stationB,
+	const uint32_t travelTime
+)
+{
+	// The matrix rows to update are found by comparing the matrix with the
+	// previous travel times, so this must happen before the edges change.
+	std::vector<uint32_t> affectedRows {};
+	if (!m_travelTimeMatrix.empty()) {
+		affectedRows = GetAffectedMatrixRows(stationA, stationB, travelTime);
+	}
+
+	auto setTravelTime {[this, &travelTime](auto stationFrom, auto stationTo) {
+		bool foundEdge {false};
+		const auto first {m_edges.begin() + m_edgeOffsets[stationFrom]};
+		const auto last {m_edges.begin() + m_edgeOffsets[stationFrom + 1]};
+		for (auto edgeIt {first}; edgeIt != last; ++edgeIt) {
+			if (edgeIt->next == stationTo) {
+				// Shift the cumulative travel times of all the following
+				// stops of the route. Unsigned wrap-around makes this work
+				// for negative differences too.
+				const auto& route {m_routes[edgeIt->route]};
+				const uint32_t delta = travelTime - edgeIt->travelTime;
+				const auto position {GetStopPosition(edgeIt->route, stationFrom)};
+				auto* cumulativeTravelTimes {
+					m_cumulativeTravelTimes.data() + route.firstStop
+				};
+				for (auto idx {position + 1}; idx < route.nStops; ++idx) {
+					cumulativeTravelTimes[idx] += delta;
+				}
+
+				edgeIt->travelTime = travelTime;
+				foundEdge = true;
+			}
+		}
+		if (foundEdge && !m_hierarchy.Empty()) {
+			m_hierarchy.UpdateArc({
+				stationFrom,
+				stationTo,
+				GetArcWeight(stationFrom, stationTo)
+			});
+		}
+		return foundEdge;
+	}};
+	const bool foundAB {setTravelTime(stationA, stationB)};
+	const bool foundBA {setTravelTime(stationB, stationA)};
+
+	if (!affectedRows.empty()) {
+		ComputeMatrixRows(affectedRows);
+	}
+
+	return foundAB || foundBA;
+}
+
+uint32_t TransportNetwork::GetTravelTime(
+	const uint32_t stationA,
+	const uint32_t stationB
 ) const
 {
-	const auto stationA {GetStation(stationIdA)};
-	const auto stationB {GetStation(stationIdB)};
-	if (stationA == nullptr || stationB == nullptr) {
-		return false;
+	for (const auto& [from, to]: {
+		std::pair {stationA, stationB},
+		std::pair {stationB, stationA}
+	}) {
+		for (auto edge {m_edgeOffsets[from]}; edge < m_edgeOffsets[from + 1]; ++edge) {
+			if (m_edges[edge].next == to && !m_closedEdges[edge]) {
+				return m_edges[edge].travelTime;
+			}
+		}
 	}
 
-	auto line {GetLine(lineId)};
-	if (line == nullptr) {
+	return 0;
+}
+
+uint32_t TransportNetwork::GetTravelTime(
+	const uint32_t route,
+	const uint32_t stationA,
+	const uint32_t stationB
+) const
+{
+	const auto positionA {GetStopPosition(route, stationA)};
+	const auto positionB {GetStopPosition(route, stationB)};
+	if (positionA == kInvalidIndex
+		|| positionB == kInvalidIndex
+		|| positionA >= positionB) {
 		return 0;
 	}
 
-	auto route {GetRouteFromLine(line, routeId)};
-	if (route == nullptr) {
+	// Closed edges are rare: only look for them if there are any.
+	if (m_nClosedEdges > 0) {
+		for (auto position {positionA}; position < positionB; ++position) {
+			if (m_closedEdges[GetRouteEdge(route, position)]) {
+				return 0;
+			}
+		}
+	}
+
+	const auto firstStop {m_routes[route].firstStop};
+	return m_cumulativeTravelTimes[firstStop + positionB]
+		- m_cumulativeTravelTimes[firstStop + positionA];
+}
+
+uint32_t TransportNetwork::FindFastestPath(
+	const uint32_t stationA,
+	const uint32_t stationB,
+	const uint32_t lineChangePenalty,
+	std::vector<uint32_t>& pathEdges
+) const
+{
+	pathEdges.clear();
+	if (stationA == stationB) {
 		return 0;
 	}
 
-	bool foundA {false};
-	uint32_t travelTime {0};
-	for (const auto& station : route->stops) {
-		if (station == stationA) {
-			foundA = true;
+	// Dijkstra over the graph edges, with a binary heap of (cost, edge) pairs.
+	// Stale heap entries are skipped when popped instead of being updated in
+	// place.
+	auto& scratch {gPathSearchScratch};
+	scratch.Prepare(m_edges.size());
+	auto& heap {scratch.heap};
+	const auto compare {std::greater<std::pair<uint32_t, uint32_t>> {}};
+
+	auto relax {[&scratch, &heap, &compare](
+		const uint32_t edge,
+		const uint32_t cost,
+		const uint32_t previous
+	) {
+		if (scratch.stamps[edge] == scratch.stamp
+			&& scratch.costs[edge] <= cost) {
+			return;
+		}
+		scratch.stamps[edge] = scratch.stamp;
+		scratch.costs[edge] = cost;
+		scratch.previous[edge] = previous;
+		heap.emplace_back(cost, edge);
+		std::push_heap(heap.begin(), heap.end(), compare);
+	}};
+
+	for (auto edge {m_edgeOffsets[stationA]};
+		edge < m_edgeOffsets[stationA + 1]; ++edge) {
+		if (!m_closedEdges[edge]) {
+			relax(edge, m_edges[edge].travelTime, kInvalidIndex);
+		}
+	}
+
+	while (!heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end(), compare);
+		const auto [cost, edge] {heap.back()};
+		heap.pop_back();
+		if (cost > scratch.costs[edge]) {
+			continue;
 		}
 
-		if (station == stationB) {
-			return travelTime;
+		const auto& current {m_edges[edge]};
+		if (current.next == stationB) {
+			for (auto idx {edge}; idx != kInvalidIndex; idx = scratch.previous[idx]) {
+				pathEdges.push_back(idx);
+			}
+			std::reverse(pathEdges.begin(), pathEdges.end());
+			return cost;
 		}
 
-		if (foundA) {
-			auto edgeIt {
-				std::find_if(
-					station->edges.begin(), 
-					station->edges.end(), 
-					[&route](const GraphEdge& edge) {
-					return edge.route == route;
-				})
+		for (auto next {m_edgeOffsets[current.next]};
+			next < m_edgeOffsets[current.next + 1]; ++next) {
+			if (m_closedEdges[next]) {
+				continue;
+			}
+			const auto& nextEdge {m_edges[next]};
+			const auto penalty {
+				nextEdge.line == current.line ? 0 : lineChangePenalty
 			};
-			if (edgeIt == station->edges.end()) {
-				return 0;
+			relax(next, cost + nextEdge.travelTime + penalty, edge);
+		}
+	}
+
+	return kUnreachable;
+}
+
+bool TransportNetwork::FindSpurPath(
+	const uint32_t station,
+	const uint32_t previousEdge,
+	const uint32_t stationB,
+	std::vector<uint32_t>& pathEdges
+) const
+{
+	pathEdges.clear();
+
+	// Dijkstra over the graph edges, like FindFastestPath, ranked by travel
+	// time, line change penalties and crowding.
+	auto& scratch {gPathSearchScratch};
+	const auto& bannedStations {scratch.bannedStations};
+	const auto& bannedEdges {scratch.bannedEdges};
+	scratch.Prepare(m_edges.size());
+	auto& heap {scratch.heap};
+	const auto compare {std::greater<std::pair<uint32_t, uint32_t>> {}};
+
+	auto relax {[this, &scratch, &heap, &compare, &bannedStations](
+		const uint32_t edge,
+		const uint32_t cost,
+		const uint32_t previous
+	) {
+		const auto& nextEdge {m_edges[edge]};
+		if (m_closedEdges[edge] || bannedStations[nextEdge.next]) {
+			return;
+		}
+		const auto lineCost {
+			previous != kInvalidIndex && m_edges[previous].line != nextEdge.line ?
+				m_lineChangePenalty : 0
+		};
+		const auto nextCost {
+			cost + nextEdge.travelTime + lineCost + GetCrowdingCost(nextEdge.next)
+		};
+		if (scratch.stamps[edge] == scratch.stamp
+			&& scratch.costs[edge] <= nextCost) {
+			return;
+		}
+		scratch.stamps[edge] = scratch.stamp;
+		scratch.costs[edge] = nextCost;
+		scratch.previous[edge] = previous;
+		heap.emplace_back(nextCost, edge);
+		std::push_heap(heap.begin(), heap.end(), compare);
+	}};
+
+	for (auto edge {m_edgeOffsets[station]};
+		edge < m_edgeOffsets[station + 1]; ++edge) {
+		if (std::find(bannedEdges.begin(), bannedEdges.end(), edge)
+			== bannedEdges.end()) {
+			relax(edge, 0, previousEdge);
+		}
+	}
+
+	while (!heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end(), compare);
+		const auto [cost, edge] {heap.back()};
+		heap.pop_back();
+		if (cost > scratch.costs[edge]) {
+			continue;
+		}
+
+		const auto& current {m_edges[edge]};
+		if (current.next == stationB) {
+			for (auto idx {edge}; idx != previousEdge; idx = scratch.previous[idx]) {
+				pathEdges.push_back(idx);
 			}
+			std::reverse(pathEdges.begin(), pathEdges.end());
+			break;
+		}
 
-			travelTime += edgeIt->travelTime;
+		for (auto next {m_edgeOffsets[current.next]};
+			next < m_edgeOffsets[current.next + 1]; ++next) {
+			relax(next, cost, edge);
 		}
 	}
+	if (pathEdges.empty()) {
+		return false;
+	}
 
-	return 0;
+	// The search runs on edges, so a path can go through a station twice, e.g.
+	// to change lines. Cutting out the loop is never slower: the loop costs
+	// at least the line change penalty it saves.
+	for (size_t idx {0}; idx < pathEdges.size(); ++idx) {
+		const auto next {m_edges[pathEdges[idx]].next};
+		for (auto later {pathEdges.size() - 1}; later > idx; --later) {
+			if (m_edges[pathEdges[later]].next == next) {
+				pathEdges.erase(
+					pathEdges.begin() + idx + 1,
+					pathEdges.begin() + later + 1
+				);
+				break;
+			}
+		}
+	}
+
+	return true;
 }
 
-// Private functions
+bool TransportNetwork::IsLayoutValid() const
+{
+	const auto nStations {m_stations.size()};
+	const auto nLines {m_lines.size()};
+	const auto nRoutes {m_routes.size()};
+	if (!m_stationIds.IsValid() || m_stationIds.Size() != nStations
+		|| !m_lineIds.IsValid() || m_lineIds.Size() != nLines
+		|| !m_routeIds.IsValid() || m_routeIds.Size() != nRoutes
+		|| m_stationNames.Size() != nStations
+		|| m_lineNames.Size() != nLines
+		|| m_routeNames.Size() != nRoutes
+		|| m_edgeOffsets.size() != nStations + 1
+		|| !SnapshotReader::IsValidOffsets(m_edgeOffsets, m_edges.size())) {
+		return false;
+	}
 
-std::shared_ptr<TransportNetwork::GraphNode> TransportNetwork::GetStation(
-	const Id& stationId
-) const
+	for (const auto& station: m_stations) {
+		for (const auto route: station.servingRoutes) {
+			if (route.index >= nRoutes) {
+				return false;
+			}
+		}
+	}
+	for (const auto& edge: m_edges) {
+		if (edge.route >= nRoutes || edge.line >= nLines || edge.next >= nStations) {
+			return false;
+		}
+	}
+	for (const auto& line: m_lines) {
+		for (const auto route: line.routes) {
+			if (route >= nRoutes) {
+				return false;
+			}
+		}
+	}
+	if (m_routeStops.size() != m_cumulativeTravelTimes.size()) {
+		return false;
+	}
+	for (const auto& route: m_routes) {
+		if (route.line >= nLines
+			|| route.firstStop + uint64_t {route.nStops} > m_routeStops.size()) {
+			return false;
+		}
+	}
+	for (const auto stop: m_routeStops) {
+		if (stop >= nStations) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void TransportNetwork::RecordPassengerFlow(
+	const uint32_t station,
+	const PassengerEvent::Type type,
+	const std::chrono::system_clock::time_point timestamp
+)
 {
-	const auto stationIt {m_stations.find(stationId)};
-	if (stationIt == m_stations.end()) {
-		return nullptr;
+	const auto bucket {GetFlowBucket(
+		timestamp == std::chrono::system_clock::time_point {} ?
+			std::chrono::system_clock::now() : timestamp
+	)};
+	if (bucket < 0 || bucket > std::numeric_limits<uint32_t>::max()) {
+		return;
 	}
 
-	return stationIt->second;
+	auto& slot {m_flowBuckets[
+		station * m_flowBucketCount + bucket % m_flowBucketCount
+	]};
+	auto& word {type == PassengerEvent::Type::In ? slot.in : slot.out};
+	auto current {word.load(std::memory_order_relaxed)};
+	while (true) {
+		const int64_t currentBucket = current >> 32;
+		uint64_t next {0};
+		if (currentBucket == bucket) {
+			if ((current & 0xffffffff) == 0xffffffff) {
+				return;
+			}
+			next = current + 1;
+		} else if (currentBucket < bucket) {
+			next = (static_cast<uint64_t>(bucket) << 32) | 1;
+		} else {
+			// The slot was already reused for a later bucket.
+			return;
+		}
+		if (word.compare_exchange_weak(
+			current,
+			next,
+			std::memory_order_relaxed
+		)) {
+			return;
+		}
+	}
 }
 
-std::shared_ptr<TransportNetwork::LineInternal> TransportNetwork::GetLine(
-	const Id& lineId
+int64_t TransportNetwork::GetFlowBucket(
+	const std::chrono::system_clock::time_point timestamp
+) const
+{
+	const auto sinceEpoch {
+		std::chrono::floor<std::chrono::seconds>(timestamp.time_since_epoch())
+	};
+	auto bucket {sinceEpoch / m_flowBucketWidth};
+	if (sinceEpoch % m_flowBucketWidth < std::chrono::seconds::zero()) {
+		--bucket;
+	}
+	return bucket;
+}
+
+PassengerFlow TransportNetwork::GetFlowBucketCounts(
+	const uint32_t station,
+	const int64_t bucket
 ) const
 {
-	const auto lineIt {m_lines.find(lineId)};
-	if (lineIt == m_lines.end()) {
-		return nullptr;
+	if (bucket < 0 || bucket > std::numeric_limits<uint32_t>::max()) {
+		return {};
 	}
 
-	return lineIt->second;	
+	const auto& slot {m_flowBuckets[
+		station * m_flowBucketCount + bucket % m_flowBucketCount
+	]};
+	const auto in {slot.in.load(std::memory_order_relaxed)};
+	const auto out {slot.out.load(std::memory_order_relaxed)};
+	return {
+		static_cast<int64_t>(in >> 32) == bucket ? in & 0xffffffff : 0,
+		static_cast<int64_t>(out >> 32) == bucket ? out & 0xffffffff : 0,
+	};
 }
 
-std::shared_ptr<TransportNetwork::RouteInternal> TransportNetwork::GetRouteFromLine(
-	std::shared_ptr<TransportNetwork::LineInternal> line,
-	const Id& routeId
+uint32_t TransportNetwork::GetCrowdingCost(
+	const uint32_t station
 ) const
 {
-	const auto routeIt {line->routes.find(routeId)};
-	if (routeIt == line->routes.end()) {
-		return nullptr;
+	const auto passengerCount {
+		m_passengerCounts[station].count.load(std::memory_order_relaxed)
+	};
+	if (passengerCount <= 0 || m_crowdingCost <= 0.0) {
+		return 0;
 	}
 
-	return routeIt->second;		
+	// Capped so that the sum over an itinerary cannot overflow.
+	return static_cast<uint32_t>(std::min(
+		passengerCount * m_crowdingCost,
+		static_cast<double>(std::numeric_limits<uint16_t>::max())
+	));
+}
+
+void TransportNetwork::InvalidateLayoutCaches()
+{
+	m_hierarchy = {};
+	m_travelTimeMatrix.clear();
+}
+
+void TransportNetwork::ResetItemStates()
+{
+	m_disabledStations.assign(m_stations.size(), false);
+	m_disabledRoutes.assign(m_routes.size(), false);
+	m_disabledEdges.assign(m_edges.size(), false);
+	m_closedEdges.assign(m_edges.size(), false);
+	m_nClosedEdges = 0;
+	m_removedStations.assign(m_stations.size(), false);
+	m_removedLines.assign(m_lines.size(), false);
+	m_removedRoutes.assign(m_routes.size(), false);
 }
 
-bool TransportNetwork::AddRouteToLine(
-	std::shared_ptr<TransportNetwork::LineInternal> line,
-	const Route& route
+bool TransportNetwork::SetRouteDisabled(
+	const RouteHandle route,
+	const bool disabled
 )
 {
-	if (line->routes.find(route.id) != line->routes.end()) {
+	if (!IsValidRoute(route)) {
 		return false;
 	}
 
-	auto routeInternal {
-		std::make_shared<RouteInternal>(
-			RouteInternal{
-				route.id,
-				route.name,
-				line,
-				{}
-			}
-		)
-	};
+	m_disabledRoutes[route.index] = disabled;
+	const auto& routeInternal {m_routes[route.index]};
+	std::vector<std::pair<uint32_t, uint32_t>> edges {};
+	for (uint32_t position {0}; position + 1 < routeInternal.nStops; ++position) {
+		edges.emplace_back(
+			m_routeStops[routeInternal.firstStop + position],
+			GetRouteEdge(route.index, position)
+		);
+	}
+	UpdateClosedEdges(edges);
 
-	routeInternal->stops.reserve(route.stops.size());
-	for (const auto& stationId: route.stops) {
-		const auto station {m_stations.find(stationId)};
-		if (station == m_stations.end()) {
-			return false;
+	return true;
+}
+
+bool TransportNetwork::SetStationDisabled(
+	const StationHandle station,
+	const bool disabled
+)
+{
+	if (!IsValidStation(station)) {
+		return false;
+	}
+
+	// The edges leaving the station are in its CSR row, the edges reaching it
+	// are found through the routes serving it.
+	m_disabledStations[station.index] = disabled;
+	std::vector<std::pair<uint32_t, uint32_t>> edges {};
+	for (auto edge {m_edgeOffsets[station.index]};
+		edge < m_edgeOffsets[station.index + 1]; ++edge) {
+		edges.emplace_back(station.index, edge);
+	}
+	for (const auto route: m_stations[station.index].servingRoutes) {
+		const auto& routeInternal {m_routes[route.index]};
+		const auto* stops {m_routeStops.data() + routeInternal.firstStop};
+		for (uint32_t position {0}; position + 1 < routeInternal.nStops; ++position) {
+			if (stops[position + 1] == station.index) {
+				edges.emplace_back(
+					stops[position],
+					GetRouteEdge(route.index, position)
+				);
+			}
 		}
+	}
+	UpdateClosedEdges(edges);
+
+	return true;
+}
 
-		routeInternal->stops.push_back(station->second);
+bool TransportNetwork::SetEdgeDisabled(
+	const StationHandle stationA,
+	const StationHandle stationB,
+	const bool disabled
+)
+{
+	if (!IsValidStation(stationA)
+		|| !IsValidStation(stationB)) {
+		return false;
+	}
+
+	std::vector<std::pair<uint32_t, uint32_t>> edges {};
+	for (const auto& [from, to]: {
+		std::pair {stationA.index, stationB.index},
+		std::pair {stationB.index, stationA.index}
+	}) {
+		for (auto edge {m_edgeOffsets[from]}; edge < m_edgeOffsets[from + 1]; ++edge) {
+			if (m_edges[edge].next == to) {
+				m_disabledEdges[edge] = disabled;
+				edges.emplace_back(from, edge);
+			}
+		}
+	}
+	if (edges.empty()) {
+		return false;
 	}
+	UpdateClosedEdges(edges);
 
-	for (auto idx {0}; idx < routeInternal->stops.size() - 1; ++ idx) {
-		const auto& thisStop {routeInternal->stops[idx]};
-		const auto& nextStop {routeInternal->stops[idx + 1]};
+	return true;
+}
 
-		GraphEdge edge {
-			routeInternal,
-			nextStop,
-			0
+void TransportNetwork::UpdateClosedEdges(
+	const std::vector<std::pair<uint32_t, uint32_t>>& edges
+)
+{
+	std::vector<EdgeChange> changes {};
+	for (const auto& [station, edge]: edges) {
+		const auto& graphEdge {m_edges[edge]};
+		if (graphEdge.route == kInvalidIndex) {
+			continue;
+		}
+		const bool closed {
+			m_disabledEdges[edge]
+			|| m_disabledRoutes[graphEdge.route]
+			|| m_disabledStations[station]
+			|| m_disabledStations[graphEdge.next]
 		};
+		if (closed == m_closedEdges[edge]) {
+			continue;
+		}
+		m_closedEdges[edge] = closed;
+		m_nClosedEdges = closed ? m_nClosedEdges + 1 : m_nClosedEdges - 1;
+		changes.push_back({
+			station,
+			graphEdge.next,
+			closed ? graphEdge.travelTime : kUnreachable,
+			closed ? kUnreachable : graphEdge.travelTime
+		});
+	}
+	if (!changes.empty()) {
+		UpdateCaches(changes);
+	}
+}
+
+void TransportNetwork::UpdateCaches(
+	const std::vector<EdgeChange>& changes
+)
+{
+	std::vector<uint32_t> affectedRows {};
+	if (!m_travelTimeMatrix.empty()) {
+		affectedRows = GetAffectedMatrixRows(changes);
+	}
+	if (!m_hierarchy.Empty()) {
+		for (const auto& change: changes) {
+			// The hierarchy cannot link stations that were not adjacent when
+			// it was built.
+			if (!m_hierarchy.UpdateArc({
+				change.from,
+				change.next,
+				GetArcWeight(change.from, change.next)
+			})) {
+				m_hierarchy = {};
+				break;
+			}
+		}
+	}
+	if (!affectedRows.empty()) {
+		ComputeMatrixRows(affectedRows);
+	}
+}
 
-		thisStop->edges.emplace_back(std::move(edge));
+uint32_t TransportNetwork::GetArcWeight(
+	const uint32_t stationFrom,
+	const uint32_t stationTo
+) const
+{
+	uint32_t weight {kUnreachable};
+	for (auto edge {m_edgeOffsets[stationFrom]};
+		edge < m_edgeOffsets[stationFrom + 1]; ++edge) {
+		if (m_edges[edge].next == stationTo && !m_closedEdges[edge]) {
+			weight = std::min(weight, m_edges[edge].travelTime);
+		}
 	}
-	line->routes.emplace(route.id, std::move(routeInternal));
+	return weight;
+}
 
-	return true;
+std::vector<uint32_t> TransportNetwork::GetAffectedMatrixRows(
+	const uint32_t stationA,
+	const uint32_t stationB,
+	const uint32_t travelTime
+) const
+{
+	// A row can only change if the edge is, or becomes, part of a fastest
+	// itinerary from the row station: either the edge was on a fastest
+	// itinerary with its old travel time, or it gives a faster itinerary with
+	// its new one.
+	const size_t nStations {m_stations.size()};
+	std::vector<bool> affected(nStations, false);
+	auto check {[&](const uint32_t stationFrom, const uint32_t stationTo) {
+		for (const auto& edge: GetEdges(stationFrom)) {
+			if (edge.next != stationTo) {
+				continue;
+			}
+			const uint64_t minTravelTime {std::min(edge.travelTime, travelTime)};
+			for (size_t row {0}; row < nStations; ++row) {
+				const auto* travelTimes {&m_travelTimeMatrix[row * nStations]};
+				if (travelTimes[stationFrom] != kUnreachable
+					&& travelTimes[stationFrom] + minTravelTime
+						<= travelTimes[stationTo]) {
+					affected[row] = true;
+				}
+			}
+			return;
+		}
+	}};
+	check(stationA, stationB);
+	check(stationB, stationA);
+
+	std::vector<uint32_t> rows {};
+	for (uint32_t row {0}; row < nStations; ++row) {
+		if (affected[row]) {
+			rows.push_back(row);
+		}
+	}
+	return rows;
+}
+
+std::vector<uint32_t> TransportNetwork::GetAffectedMatrixRows(
+	const std::vector<EdgeChange>& changes
+) const
+{
+	// As for a single edge, a row can only change if one of the edges was on
+	// a fastest itinerary from the row station, or gives a faster one. If no
+	// edge does either, the previous travel times stay consistent with every
+	// edge, whether it changed or not.
+	const size_t nStations {m_stations.size()};
+	std::vector<uint32_t> rows {};
+	for (uint32_t row {0}; row < nStations; ++row) {
+		const auto* travelTimes {&m_travelTimeMatrix[row * nStations]};
+		for (const auto& change: changes) {
+			const auto minTravelTime {
+				std::min(change.oldTravelTime, change.newTravelTime)
+			};
+			if (travelTimes[change.from] != kUnreachable
+				&& minTravelTime != kUnreachable
+				&& uint64_t {travelTimes[change.from]} + minTravelTime
+					<= travelTimes[change.next]) {
+				rows.push_back(row);
+				break;
+			}
+		}
+	}
+	return rows;
+}
+
+void TransportNetwork::ComputeMatrixRows(
+	const std::vector<uint32_t>& rows
+)
+{
+	const size_t nStations {m_stations.size()};
+	ParallelFor(rows.size(), [this, &rows, nStations](size_t first, size_t last) {
+		std::vector<std::pair<uint32_t, uint32_t>> heap {};
+		for (auto idx {first}; idx < last; ++idx) {
+			ComputeTravelTimes(
+				rows[idx],
+				&m_travelTimeMatrix[rows[idx] * nStations],
+				heap
+			);
+		}
+	});
+}
+
+void TransportNetwork::ComputeTravelTimes(
+	const uint32_t source,
+	uint32_t* travelTimes,
+	std::vector<std::pair<uint32_t, uint32_t>>& heap
+) const
+{
+	// Dijkstra over the stations, with a binary heap of (travel time, station)
+	// pairs.
+	std::fill(travelTimes, travelTimes + m_stations.size(), kUnreachable);
+	const auto compare {std::greater<std::pair<uint32_t, uint32_t>> {}};
+	heap.clear();
+	travelTimes[source] = 0;
+	heap.emplace_back(0, source);
+	while (!heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end(), compare);
+		const auto [travelTime, station] {heap.back()};
+		heap.pop_back();
+		if (travelTime > travelTimes[station]) {
+			continue;
+		}
+		for (auto edge {m_edgeOffsets[station]};
+			edge < m_edgeOffsets[station + 1]; ++edge) {
+			if (m_closedEdges[edge]) {
+				continue;
+			}
+			const auto& graphEdge {m_edges[edge]};
+			const auto nextTravelTime {travelTime + graphEdge.travelTime};
+			if (nextTravelTime < travelTimes[graphEdge.next]) {
+				travelTimes[graphEdge.next] = nextTravelTime;
+				heap.emplace_back(nextTravelTime, graphEdge.next);
+				std::push_heap(heap.begin(), heap.end(), compare);
+			}
+		}
+	}
 }
@@ -0,0 +1,161 @@
+#include <network-monitor/ContractionHierarchy.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using NetworkMonitor::ContractionHierarchy;
+
+using Arc = ContractionHierarchy::Arc;
+
+// Reference all-pairs distances, computed with Floyd-Warshall.
+static std::vector<std::vector<uint64_t>> GetReferenceDistances(
+    const uint32_t nNodes,
+    const std::vector<Arc>& arcs
+)
+{
+    const uint64_t inf {ContractionHierarchy::kInfinity};
+    std::vector<std::vector<uint64_t>> distances(
+        nNodes,
+        std::vector<uint64_t>(nNodes, inf)
+    );
+    for (uint32_t node {0}; node < nNodes; ++node) {
+        distances[node][node] = 0;
+    }
+    for (const auto& arc: arcs) {
+        auto& distance {distances[arc.from][arc.to]};
+        distance = std::min<uint64_t>(distance, arc.weight);
+    }
+    for (uint32_t via {0}; via < nNodes; ++via) {
+        for (uint32_t from {0}; from < nNodes; ++from) {
+            for (uint32_t to {0}; to < nNodes; ++to) {
+                distances[from][to] = std::min(
+                    distances[from][to],
+                    distances[from][via] + distances[via][to]
+                );
+            }
+        }
+    }
+    for (auto& row: distances) {
+        for (auto& distance: row) {
+            distance = std::min(distance, inf);
+        }
+    }
+    return distances;
+}
+
+static void CheckAllPairs(
+    const ContractionHierarchy& hierarchy,
+    const uint32_t nNodes,
+    const std::vector<Arc>& arcs
+)
+{
+    const auto reference {GetReferenceDistances(nNodes, arcs)};
+    for (uint32_t from {0}; from < nNodes; ++from) {
+        for (uint32_t to {0}; to < nNodes; ++to) {
+            BOOST_TEST_CONTEXT("from " << from << " to " << to) {
+                BOOST_CHECK_EQUAL(
+                    hierarchy.GetDistance(from, to),
+                    reference[from][to]
+                );
+            }
+        }
+    }
+}
+
+static std::vector<Arc> MakeRandomGraph(
+    std::mt19937& generator,
+    const uint32_t nNodes,
+    const uint32_t nArcs
+)
+{
+    std::uniform_int_distribution<uint32_t> node(0, nNodes - 1);
+    std::uniform_int_distribution<uint32_t> weight(1, 20);
+    std::vector<Arc> arcs {};
+    while (arcs.size() < nArcs) {
+        Arc arc {node(generator), node(generator), weight(generator)};
+        if (arc.from != arc.to) {
+            arcs.push_back(arc);
+        }
+    }
+    return arcs;
+}
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_ContractionHierarchy);
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+    ContractionHierarchy hierarchy {};
+    BOOST_CHECK(hierarchy.Empty());
+    BOOST_CHECK_EQUAL(hierarchy.GetDistance(0, 1), ContractionHierarchy::kInfinity);
+    BOOST_CHECK(!hierarchy.UpdateArc({0, 1, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    // 0 --1--> 1 --1--> 2 --1--> 3
+    //  \-----------5----------->/
+    std::vector<Arc> arcs {
+        {0, 1, 1},
+        {1, 2, 1},
+        {2, 3, 1},
+        {0, 3, 5},
+    };
+    ContractionHierarchy hierarchy {4, arcs};
+    BOOST_CHECK(!hierarchy.Empty());
+    BOOST_CHECK_EQUAL(hierarchy.GetDistance(0, 3), 3);
+    BOOST_CHECK_EQUAL(hierarchy.GetDistance(1, 3), 2);
+    BOOST_CHECK_EQUAL(hierarchy.GetDistance(2, 2), 0);
+    BOOST_CHECK_EQUAL(hierarchy.GetDistance(3, 0), ContractionHierarchy::kInfinity);
+    BOOST_CHECK_EQUAL(hierarchy.GetDistance(0, 4), ContractionHierarchy::kInfinity);
+
+    // Make the direct arc the shortest path, then make it longer again.
+    BOOST_REQUIRE(hierarchy.UpdateArc({0, 3, 2}));
+    BOOST_CHECK_EQUAL(hierarchy.GetDistance(0, 3), 2);
+    BOOST_REQUIRE(hierarchy.UpdateArc({0, 3, 7}));
+    BOOST_CHECK_EQUAL(hierarchy.GetDistance(0, 3), 3);
+    BOOST_REQUIRE(hierarchy.UpdateArc({1, 2, 10}));
+    BOOST_CHECK_EQUAL(hierarchy.GetDistance(0, 3), 7);
+
+    // The reverse direction of an input arc can be added.
+    BOOST_REQUIRE(hierarchy.UpdateArc({3, 0, 1}));
+    BOOST_CHECK_EQUAL(hierarchy.GetDistance(3, 1), 2);
+
+    // Arcs between nodes that are not adjacent cannot.
+    BOOST_CHECK(!hierarchy.UpdateArc({0, 0, 1}));
+    BOOST_CHECK(!hierarchy.UpdateArc({0, 4, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(random_graphs)
+{
+    std::mt19937 generator {42};
+    for (uint32_t nNodes: {5, 20, 60}) {
+        auto arcs {MakeRandomGraph(generator, nNodes, 3 * nNodes)};
+        ContractionHierarchy hierarchy {nNodes, arcs};
+        CheckAllPairs(hierarchy, nNodes, arcs);
+
+        // Change some weights, up and down.
+        std::uniform_int_distribution<size_t> pick(0, arcs.size() - 1);
+        std::uniform_int_distribution<uint32_t> weight(1, 40);
+        for (size_t idx {0}; idx < 10; ++idx) {
+            auto& arc {arcs[pick(generator)]};
+            arc.weight = weight(generator);
+            // Parallel arcs share the same weight, as in a TransportNetwork.
+            for (auto& other: arcs) {
+                if (other.from == arc.from && other.to == arc.to) {
+                    other.weight = arc.weight;
+                }
+            }
+            BOOST_REQUIRE(hierarchy.UpdateArc(arc));
+        }
+        CheckAllPairs(hierarchy, nNodes, arcs);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_ContractionHierarchy
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
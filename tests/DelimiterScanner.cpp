@@ -0,0 +1,116 @@
+#include "DelimiterScanner.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using NetworkMonitor::DelimiterScanner;
+
+namespace {
+
+// All the positions returned by the scanner, up to the end of the buffer.
+template <char... Delimiters>
+std::vector<size_t> Scan(
+    const std::string_view data
+)
+{
+    DelimiterScanner<Delimiters...> scanner {data};
+    std::vector<size_t> positions {};
+    for (auto position {scanner.Next()}; position < data.size();
+        position = scanner.Next()) {
+        positions.push_back(position);
+    }
+    return positions;
+}
+
+std::vector<size_t> NaiveScan(
+    const std::string_view data,
+    const std::string_view delimiters
+)
+{
+    std::vector<size_t> positions {};
+    for (size_t idx {0}; idx < data.size(); ++idx) {
+        if (delimiters.find(data[idx]) != std::string_view::npos) {
+            positions.push_back(idx);
+        }
+    }
+    return positions;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_DelimiterScanner);
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+    DelimiterScanner<'\n'> scanner {std::string_view {}};
+    BOOST_CHECK_EQUAL(scanner.Next(), 0);
+    BOOST_CHECK_EQUAL(scanner.Next(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(end_of_buffer)
+{
+    const std::string data {"a\nb\n"};
+    DelimiterScanner<'\n'> scanner {data};
+    BOOST_CHECK_EQUAL(scanner.Next(), 1);
+    BOOST_CHECK_EQUAL(scanner.Next(), 3);
+    BOOST_CHECK_EQUAL(scanner.Next(), data.size());
+    BOOST_CHECK_EQUAL(scanner.Next(), data.size());
+}
+
+// Sizes around the 64-byte blocks cover whole blocks, partial tails and the
+// last bit of each block.
+BOOST_AUTO_TEST_CASE(naive_search)
+{
+    std::mt19937 generator {42};
+    std::uniform_int_distribution<int> bytes {0, 255};
+    std::bernoulli_distribution isDelimiter {0.2};
+    std::uniform_int_distribution<size_t> delimiter {0, 1};
+    const std::string_view delimiters {"\n:"};
+    for (size_t size {0}; size <= 200; ++size) {
+        std::string data(size, '\0');
+        for (auto& c: data) {
+            c = isDelimiter(generator) ?
+                delimiters[delimiter(generator)] :
+                static_cast<char>(bytes(generator));
+        }
+        BOOST_TEST_CONTEXT("size " << size) {
+            const auto expected {NaiveScan(data, delimiters)};
+            const auto positions {Scan<'\n', ':'>(data)};
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                positions.begin(), positions.end(),
+                expected.begin(), expected.end()
+            );
+        }
+    }
+
+    // Delimiters in every byte, and none at all.
+    for (const auto c: {'\n', 'x'}) {
+        const std::string data(130, c);
+        const auto expected {NaiveScan(data, delimiters)};
+        const auto positions {Scan<'\n', ':'>(data)};
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            positions.begin(), positions.end(),
+            expected.begin(), expected.end()
+        );
+    }
+}
+
+// Bytes with the high bit set must not match, whatever the sign of char.
+BOOST_AUTO_TEST_CASE(high_bytes)
+{
+    std::string data(64, '\xff');
+    data[10] = '\x80';
+    BOOST_CHECK((Scan<'\xff'>(data) == NaiveScan(data, "\xff")));
+    BOOST_CHECK((Scan<'\x0a'>(data).empty()));
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_DelimiterScanner
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
@@ -0,0 +1,257 @@
+#include <network-monitor/FileDownloader.h>
+#include <network-monitor/MappedTransportNetwork.h>
+#include <network-monitor/TransportNetwork.h>
+
+#include "SnapshotFormat.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+using NetworkMonitor::LineHandle;
+using NetworkMonitor::MappedTransportNetwork;
+using NetworkMonitor::ParseJsonFile;
+using NetworkMonitor::RouteHandle;
+using NetworkMonitor::StationHandle;
+using NetworkMonitor::TransportNetwork;
+
+namespace SnapshotFormat = NetworkMonitor::SnapshotFormat;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_MappedTransportNetwork);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+    auto snapshotPath {
+        std::filesystem::temp_directory_path() / "network-monitor-mapped.bin"
+    };
+    BOOST_REQUIRE(nw.SaveSnapshot(snapshotPath));
+
+    MappedTransportNetwork mapped {};
+    BOOST_CHECK_EQUAL(mapped.GetStationCount(), 0);
+    BOOST_CHECK(!mapped.GetStationHandle("station_000").IsValid());
+    BOOST_REQUIRE(mapped.Open(snapshotPath));
+
+    // Same answers as the network that saved the snapshot.
+    BOOST_REQUIRE_EQUAL(mapped.GetStationCount(), nw.GetStationCount());
+    for (uint32_t idx {0}; idx < nw.GetStationCount(); ++idx) {
+        const StationHandle station {idx};
+        const auto id {nw.GetStationId(station)};
+        BOOST_REQUIRE(mapped.GetStationHandle(id) == station);
+        BOOST_CHECK_EQUAL(mapped.GetStationId(station), id);
+        BOOST_CHECK(!mapped.GetStationName(station).empty());
+
+        const auto& routes {nw.GetRoutesServingStation(station)};
+        const auto mappedRoutes {mapped.GetRoutesServingStation(station)};
+        BOOST_REQUIRE_EQUAL(mappedRoutes.size(), routes.size());
+        for (size_t route {0}; route < routes.size(); ++route) {
+            BOOST_CHECK(mappedRoutes.first[route] == routes[route]);
+        }
+
+        const StationHandle next {(idx + 1) % static_cast<uint32_t>(nw.GetStationCount())};
+        BOOST_CHECK_EQUAL(
+            mapped.GetTravelTime(station, next),
+            nw.GetTravelTime(station, next)
+        );
+    }
+    BOOST_CHECK(!mapped.GetStationHandle("station_42").IsValid());
+
+    const auto line {mapped.GetLineHandle("line_000")};
+    BOOST_REQUIRE(line.IsValid());
+    const auto route {mapped.GetRouteHandle(line, "route_000")};
+    BOOST_REQUIRE(route.IsValid());
+    BOOST_CHECK(route == nw.GetRouteHandle("line_000", "route_000"));
+    BOOST_CHECK_EQUAL(mapped.GetRouteId(route), "route_000");
+    BOOST_CHECK(!mapped.GetRouteHandle(LineHandle {}, "route_000").IsValid());
+    const auto stationA {mapped.GetStationHandle("station_000")};
+    const auto stationB {mapped.GetStationHandle("station_002")};
+    BOOST_CHECK_EQUAL(
+        mapped.GetTravelTime(route, stationA, stationB),
+        nw.GetTravelTime(route, stationA, stationB)
+    );
+    BOOST_CHECK_EQUAL(mapped.GetTravelTime(route, stationB, stationA), 0);
+
+    // Moving keeps the mapping alive.
+    auto moved {std::move(mapped)};
+    BOOST_CHECK_EQUAL(mapped.GetStationCount(), 0);
+    BOOST_CHECK(moved.GetStationHandle("station_000") == stationA);
+
+    std::filesystem::remove(snapshotPath);
+}
+
+BOOST_AUTO_TEST_CASE(patched_network)
+{
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+    std::vector<std::string> errors {};
+    ok = nw.ApplyPatch(nlohmann::json::parse(R"({
+        "remove": {"lines": ["line_000"], "stations": ["station_000"]}
+    })"), errors);
+    BOOST_REQUIRE(ok);
+    auto snapshotPath {
+        std::filesystem::temp_directory_path() / "network-monitor-mapped.bin"
+    };
+    BOOST_REQUIRE(nw.SaveSnapshot(snapshotPath));
+
+    // Removed items are not in the mapped network.
+    MappedTransportNetwork mapped {};
+    BOOST_REQUIRE(mapped.Open(snapshotPath));
+    BOOST_CHECK_EQUAL(mapped.GetStationCount(), nw.GetStationCount());
+    BOOST_CHECK(!mapped.GetStationHandle("station_000").IsValid());
+    BOOST_CHECK(mapped.GetStationId(StationHandle {0}).empty());
+    BOOST_CHECK(!mapped.GetLineHandle("line_000").IsValid());
+    const auto station1 {mapped.GetStationHandle("station_001")};
+    BOOST_REQUIRE(station1 == nw.GetStationHandle("station_001"));
+    BOOST_CHECK(mapped.GetRoutesServingStation(station1).empty());
+
+    const auto line {mapped.GetLineHandle("line_001")};
+    const auto route {mapped.GetRouteHandle(line, "route_002")};
+    BOOST_REQUIRE(route == nw.GetRouteHandle("line_001", "route_002"));
+    const auto stationA {mapped.GetStationHandle("station_025")};
+    const auto stationB {mapped.GetStationHandle("station_030")};
+    BOOST_CHECK_EQUAL(
+        mapped.GetTravelTime(route, stationA, stationB),
+        nw.GetTravelTime(route, stationA, stationB)
+    );
+
+    std::filesystem::remove(snapshotPath);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_file)
+{
+    auto snapshotPath {
+        std::filesystem::temp_directory_path() / "network-monitor-mapped.bin"
+    };
+
+    MappedTransportNetwork mapped {};
+    BOOST_CHECK(!mapped.Open(snapshotPath.string() + ".missing"));
+
+    {
+        std::ofstream file {snapshotPath, std::ios::binary | std::ios::trunc};
+        file << "not a snapshot";
+    }
+    BOOST_CHECK(!mapped.Open(snapshotPath));
+    BOOST_CHECK_EQUAL(mapped.GetStationCount(), 0);
+
+    // An empty network is a valid snapshot.
+    BOOST_REQUIRE(TransportNetwork {}.SaveSnapshot(snapshotPath));
+    BOOST_CHECK(mapped.Open(snapshotPath));
+    BOOST_CHECK_EQUAL(mapped.GetStationCount(), 0);
+    BOOST_CHECK(!mapped.GetStationHandle("station_000").IsValid());
+
+    std::filesystem::remove(snapshotPath);
+}
+
+BOOST_AUTO_TEST_CASE(corrupted_indices)
+{
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+    auto snapshotPath {
+        std::filesystem::temp_directory_path() / "network-monitor-mapped.bin"
+    };
+    BOOST_REQUIRE(nw.SaveSnapshot(snapshotPath));
+    std::string snapshot {};
+    {
+        std::ifstream file {snapshotPath, std::ios::binary};
+        snapshot.assign(std::istreambuf_iterator<char> {file}, {});
+    }
+    BOOST_REQUIRE_GT(snapshot.size(), sizeof(SnapshotFormat::Header));
+
+    // Get the uint32_t values of a section of the snapshot.
+    auto getSection {[](std::string& bytes, const size_t section) {
+        SnapshotFormat::SectionCursor sections {
+            bytes.data() + sizeof(SnapshotFormat::Header),
+            bytes.size() - sizeof(SnapshotFormat::Header)
+        };
+        const char* chars {nullptr};
+        size_t nChars {0};
+        for (size_t idx {0}; idx < section; ++idx) {
+            BOOST_REQUIRE(sections.Next(chars, nChars));
+        }
+        const uint32_t* items {nullptr};
+        size_t nItems {0};
+        BOOST_REQUIRE(sections.Next(items, nItems));
+        return std::pair {const_cast<uint32_t*>(items), nItems};
+    }};
+
+    // Overwrite `count` values of a section, from `offset`, and save the
+    // snapshot with a valid checksum: only the range checks can reject it.
+    auto saveCorrupted {[&](
+        const size_t section,
+        const size_t offset,
+        const size_t count,
+        const uint32_t value
+    ) {
+        auto corrupted {snapshot};
+        const auto [items, nItems] {getSection(corrupted, section)};
+        BOOST_REQUIRE_LE(offset + count, nItems);
+        std::fill(items + offset, items + offset + count, value);
+
+        SnapshotFormat::Header header {};
+        std::memcpy(&header, corrupted.data(), sizeof(header));
+        header.checksum = SnapshotFormat::GetChecksum(
+            corrupted.data() + sizeof(header),
+            corrupted.size() - sizeof(header)
+        );
+        std::memcpy(corrupted.data(), &header, sizeof(header));
+        std::ofstream file {snapshotPath, std::ios::binary | std::ios::trunc};
+        file << corrupted;
+    }};
+
+    // Sections of the values checked. See SnapshotFormat.h.
+    constexpr size_t kStationSlots {2};
+    constexpr size_t kServingRoutes {11};
+    constexpr size_t kEdges {14};
+    constexpr size_t kRouteLines {21};
+    constexpr size_t kStops {22};
+    constexpr uint32_t kOutOfRange {0xfffffffe};
+    const auto nSlots {getSection(snapshot, kStationSlots).second};
+    MappedTransportNetwork mapped {};
+
+    // A hash slot out of range.
+    saveCorrupted(kStationSlots, 0, nSlots, kOutOfRange);
+    BOOST_CHECK(!mapped.Open(snapshotPath));
+    BOOST_CHECK_EQUAL(mapped.GetStationCount(), 0);
+
+    // No free hash slot: a lookup of a missing ID would never stop.
+    saveCorrupted(kStationSlots, 0, nSlots, 0);
+    BOOST_CHECK(!mapped.Open(snapshotPath));
+
+    saveCorrupted(kServingRoutes, 0, 1, kOutOfRange);
+    BOOST_CHECK(!mapped.Open(snapshotPath));
+
+    // Edges are 4 uint32_t values: route, line, next, travel time.
+    for (size_t field {0}; field < 3; ++field) {
+        saveCorrupted(kEdges, field, 1, kOutOfRange);
+        BOOST_CHECK(!mapped.Open(snapshotPath));
+    }
+
+    saveCorrupted(kRouteLines, 0, 1, kOutOfRange);
+    BOOST_CHECK(!mapped.Open(snapshotPath));
+
+    saveCorrupted(kStops, 0, 1, kOutOfRange);
+    BOOST_CHECK(!mapped.Open(snapshotPath));
+
+    // The travel time is not an index.
+    saveCorrupted(kEdges, 3, 1, kOutOfRange);
+    BOOST_CHECK(mapped.Open(snapshotPath));
+
+    std::filesystem::remove(snapshotPath);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_MappedTransportNetwork
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
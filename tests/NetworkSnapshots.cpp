@@ -0,0 +1,132 @@
+#include <network-monitor/FileDownloader.h>
+#include <network-monitor/NetworkSnapshots.h>
+#include <network-monitor/TransportNetwork.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::NetworkSnapshots;
+using NetworkMonitor::ParseJsonFile;
+using NetworkMonitor::Station;
+using NetworkMonitor::TransportNetwork;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_NetworkSnapshots);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    NetworkSnapshots snapshots {};
+    BOOST_CHECK_EQUAL(snapshots.GetVersion(), 1);
+    BOOST_CHECK_EQUAL(snapshots.Read()->GetStationCount(), 0);
+
+    TransportNetwork nw {};
+    BOOST_REQUIRE(nw.AddStation({"station_000", "Station Name 0"}));
+    snapshots.Publish(nw);
+    BOOST_CHECK_EQUAL(snapshots.GetVersion(), 2);
+    BOOST_CHECK_EQUAL(snapshots.Read()->GetStationCount(), 1);
+
+    // Update a copy of the current version.
+    auto ok {snapshots.Update([](TransportNetwork& network) {
+        return network.AddStation({"station_001", "Station Name 1"});
+    })};
+    BOOST_CHECK(ok);
+    BOOST_CHECK_EQUAL(snapshots.GetVersion(), 3);
+    auto snapshot {snapshots.Read()};
+    BOOST_CHECK_EQUAL(snapshot->GetStationCount(), 2);
+    BOOST_CHECK((*snapshot).GetStationHandle("station_001").IsValid());
+
+    // Failed updates are not published.
+    ok = snapshots.Update([](TransportNetwork& network) {
+        return network.AddStation({"station_001", "Station Name 1"});
+    });
+    BOOST_CHECK(!ok);
+    BOOST_CHECK_EQUAL(snapshots.GetVersion(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(publish_waits_for_readers)
+{
+    NetworkSnapshots snapshots {};
+    std::atomic<bool> published {false};
+    std::thread writer {};
+    {
+        auto snapshot {snapshots.Read()};
+        writer = std::thread {[&snapshots, &published]() {
+            TransportNetwork nw {};
+            nw.AddStation({"station_000", "Station Name 0"});
+            snapshots.Publish(std::move(nw));
+            published = true;
+        }};
+
+        // The new version becomes visible to new readers right away, but the
+        // writer waits for our snapshot to be released.
+        while (snapshots.GetVersion() == 1) {
+            std::this_thread::yield();
+        }
+        BOOST_CHECK_EQUAL(snapshots.Read()->GetStationCount(), 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds {50});
+        BOOST_CHECK(!published);
+        BOOST_CHECK_EQUAL(snapshot->GetStationCount(), 0);
+    }
+    writer.join();
+    BOOST_CHECK(published);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_readers)
+{
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+    const auto nStations {nw.GetStationCount()};
+    NetworkSnapshots snapshots {std::move(nw)};
+
+    // Readers check that each snapshot they get is whole, while a writer keeps
+    // adding stations.
+    constexpr size_t nReaders {4};
+    constexpr size_t nUpdates {50};
+    std::atomic<bool> done {false};
+    std::atomic<size_t> errors {0};
+    std::vector<std::thread> readers {};
+    for (size_t idx {0}; idx < nReaders; ++idx) {
+        readers.emplace_back([&snapshots, &done, &errors, nStations]() {
+            size_t previous {0};
+            while (!done) {
+                auto snapshot {snapshots.Read()};
+                const auto count {snapshot->GetStationCount()};
+                const auto last {snapshot->GetStationHandle(
+                    "station_new_" + std::to_string(count - nStations)
+                )};
+                if (count < previous
+                    || (count > nStations && !last.IsValid())) {
+                    ++errors;
+                }
+                previous = count;
+            }
+        });
+    }
+    for (size_t idx {1}; idx <= nUpdates; ++idx) {
+        snapshots.Update([idx](TransportNetwork& network) {
+            return network.AddStation({
+                "station_new_" + std::to_string(idx),
+                "New Station"
+            });
+        });
+    }
+    done = true;
+    for (auto& reader: readers) {
+        reader.join();
+    }
+
+    BOOST_CHECK_EQUAL(errors, 0);
+    BOOST_CHECK_EQUAL(snapshots.Read()->GetStationCount(), nStations + nUpdates);
+    BOOST_CHECK_EQUAL(snapshots.GetVersion(), nUpdates + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_NetworkSnapshots
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
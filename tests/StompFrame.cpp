@@ -5,6 +5,7 @@
 #include <sstream>
 #include <string>
 
+using NetworkMonitor::BufferedStompFrame;
 using NetworkMonitor::StompCommand;
 using NetworkMonitor::StompError;
 using NetworkMonitor::StompFrame;
@@ -546,8 +547,265 @@ BOOST_AUTO_TEST_CASE(parse_required_headers)
     }
 }
 
+BOOST_AUTO_TEST_CASE(parse_delimiters_across_blocks)
+{
+    // Delimiters land at every offset of the blocks the parser scans.
+    StompError error;
+    for (size_t valueLength {1}; valueLength < 80; ++valueLength) {
+        const std::string value(valueLength, 'v');
+        const std::string body(valueLength - 1, 'b');
+        std::string plain {
+            "SEND\n"
+            "destination:" + value + "\n"
+            "id:" + value + ":" + value + "\n"
+            "\n"
+            + body + "\0\n"s
+        };
+        StompFrame frame {error, std::move(plain)};
+        BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+        BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kDestination), value);
+        BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kId), value + ":" + value);
+        BOOST_CHECK_EQUAL(frame.GetBody(), body);
+
+        std::string missingNewLine {
+            "SEND\n"
+            "destination:" + value
+        };
+        StompFrame missing {error, std::move(missingNewLine)};
+        BOOST_CHECK_EQUAL(error, StompError::kErrorHeaderMissingNewLine);
+
+        std::string missingNull {
+            "SEND\n"
+            "destination:/passengers\n"
+            "\n"
+            + body
+        };
+        StompFrame noNull {error, std::move(missingNull)};
+        BOOST_CHECK_EQUAL(error, StompError::kErrorBodyMissingNull);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(construct_from_headers)
+{
+    StompError error;
+    StompFrame frame {
+        error,
+        StompCommand::kSend,
+        {
+            {StompHeader::kDestination, "/passengers"},
+            {StompHeader::kContentType, "application/json"},
+        },
+        "Frame body"
+    };
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kSend);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kDestination), "/passengers");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kContentType), "application/json");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kId), "");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kUnknown), "");
+    BOOST_CHECK_EQUAL(frame.GetBody(), "Frame body");
+
+    StompFrame parsed {error, frame.ToString()};
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(parsed.GetHeaderValue(StompHeader::kDestination), "/passengers");
+    BOOST_CHECK_EQUAL(parsed.GetHeaderValue(StompHeader::kContentType), "application/json");
+    BOOST_CHECK_EQUAL(parsed.GetBody(), "Frame body");
+}
+
+BOOST_AUTO_TEST_CASE(construct_from_headers_invalid)
+{
+    StompError error;
+    StompFrame unknown {
+        error,
+        StompCommand::kSend,
+        {
+            {StompHeader::kDestination, "/passengers"},
+            {StompHeader::kUnknown, "value"},
+        },
+        ""
+    };
+    BOOST_CHECK_EQUAL(error, StompError::kErrorHeaderInvalidKey);
+
+    StompFrame empty {
+        error,
+        StompCommand::kSend,
+        {
+            {StompHeader::kDestination, ""},
+        },
+        ""
+    };
+    BOOST_CHECK_EQUAL(error, StompError::kErrorHeaderEmptyValue);
+
+    StompFrame missing {error, StompCommand::kSubscribe, {}, ""};
+    BOOST_CHECK_EQUAL(error, StompError::kErrorHeaderMissing);
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // class_StompFrame
 
+BOOST_AUTO_TEST_SUITE(class_BufferedStompFrame);
+
+BOOST_AUTO_TEST_CASE(parse_well_formed)
+{
+    std::string plain {
+        "MESSAGE\n"
+        "destination:/passengers\n"
+        "message-id:42\n"
+        "subscription:sub-0\n"
+        "\n"
+        "Frame body\0"s
+    };
+    StompError error;
+    BufferedStompFrame frame {error, std::move(plain)};
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kMessage);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kDestination), "/passengers");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kMessageId), "42");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kSubscription), "sub-0");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kContentLength), "");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kUnknown), "");
+    BOOST_CHECK_EQUAL(frame.GetBody(), "Frame body");
+}
+
+BOOST_AUTO_TEST_CASE(parse_content_length)
+{
+    std::string plain {
+        "SEND\n"
+        "destination:/passengers\n"
+        "content-length:11\n"
+        "\n"
+        "Frame\0body\n\0\n\n"s
+    };
+    StompError error;
+    BufferedStompFrame frame {error, std::move(plain)};
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kContentLength), "11");
+    BOOST_CHECK_EQUAL(frame.GetBody(), "Frame\0body\n"s);
+}
+
+BOOST_AUTO_TEST_CASE(parse_error)
+{
+    std::string plain {
+        "MESSAGE\n"
+        "destination:/passengers\n"
+        "\n"
+        "Frame body\0"s
+    };
+    StompError error;
+    BufferedStompFrame frame {error, std::move(plain)};
+    BOOST_CHECK_EQUAL(error, StompError::kErrorHeaderMissing);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::kUnknown);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kDestination), "");
+    BOOST_CHECK_EQUAL(frame.GetBody(), "");
+}
+
+BOOST_AUTO_TEST_CASE(parse_repeated_header)
+{
+    std::string plain {
+        "SEND\n"
+        "destination:/first\n"
+        "destination:/second\n"
+        "\n"
+        "\0"s
+    };
+    StompError error;
+    BufferedStompFrame frame {error, std::move(plain)};
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::kDestination), "/first");
+}
+
+BOOST_AUTO_TEST_CASE(views_into_buffer)
+{
+    // Long enough not to fit in the small string buffer.
+    const std::string body(256, 'x');
+    std::string plain {
+        "SEND\n"
+        "destination:/passengers\n"
+        "\n"
+        + body + "\0"s
+    };
+    const auto* bufferFirst {plain.data()};
+    const auto* bufferLast {plain.data() + plain.size()};
+    StompError error;
+    BufferedStompFrame frame {error, std::move(plain)};
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BOOST_CHECK_EQUAL(frame.GetBody(), body);
+    BOOST_CHECK(frame.GetBody().data() >= bufferFirst);
+    BOOST_CHECK(frame.GetBody().data() + body.size() <= bufferLast);
+
+    // The views follow the frame.
+    BufferedStompFrame moved {std::move(frame)};
+    BOOST_CHECK_EQUAL(moved.GetHeaderValue(StompHeader::kDestination), "/passengers");
+    BOOST_CHECK_EQUAL(moved.GetBody(), body);
+    BufferedStompFrame copied {moved};
+    BOOST_CHECK_EQUAL(copied.GetHeaderValue(StompHeader::kDestination), "/passengers");
+    BOOST_CHECK_EQUAL(copied.GetBody(), body);
+}
+
+BOOST_AUTO_TEST_CASE(views_into_small_buffer)
+{
+    std::string plain {
+        "SEND\n"
+        "destination:/a\n"
+        "\n"
+        "b\0"s
+    };
+    StompError error;
+    BufferedStompFrame frame {error, std::move(plain)};
+    BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+    BufferedStompFrame moved {std::move(frame)};
+    BOOST_CHECK_EQUAL(moved.GetHeaderValue(StompHeader::kDestination), "/a");
+    BOOST_CHECK_EQUAL(moved.GetBody(), "b");
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_BufferedStompFrame
+
+BOOST_AUTO_TEST_CASE(enum_names)
+{
+    BOOST_CHECK_EQUAL(ToString(StompCommand::kConnected), "CONNECTED");
+    BOOST_CHECK_EQUAL(ToString(StompCommand::kUnknown), "UNKNOWN COMMAND");
+    BOOST_CHECK_EQUAL(ToString(static_cast<StompCommand>(42)), "UNKNOWN COMMAND");
+    BOOST_CHECK_EQUAL(ToString(StompHeader::kReceiptId), "receipt-id");
+    BOOST_CHECK_EQUAL(ToString(StompHeader::kUnknown), "unknown header");
+    BOOST_CHECK_EQUAL(ToString(static_cast<StompHeader>(42)), "unknown header");
+    BOOST_CHECK_EQUAL(ToString(StompError::kOk), "StompError::kOk");
+    BOOST_CHECK_EQUAL(ToString(static_cast<StompError>(42)), "StompError::kErrorUnknown");
+}
+
+BOOST_AUTO_TEST_CASE(parse_all_header_names)
+{
+    for (size_t idx {0}; idx < static_cast<size_t>(StompHeader::kUnknown); ++idx) {
+        const auto header {static_cast<StompHeader>(idx)};
+        const auto value {header == StompHeader::kContentLength ? "0" : "value"};
+        std::string plain {
+            "SEND\n"
+            "destination:/passengers\n"
+            + std::string {ToString(header)} + ":" + value + "\n"
+            "\n"
+            "\0"s
+        };
+        StompError error;
+        StompFrame frame {error, std::move(plain)};
+        BOOST_REQUIRE_EQUAL(error, StompError::kOk);
+        BOOST_CHECK_EQUAL(frame.GetHeaderValue(header), header == StompHeader::kDestination ? "/passengers" : value);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parse_all_command_names)
+{
+    for (size_t idx {0}; idx < static_cast<size_t>(StompCommand::kUnknown); ++idx) {
+        const auto command {static_cast<StompCommand>(idx)};
+        std::string plain {
+            std::string {ToString(command)} + "\n"
+            "\n"
+            "\0"s
+        };
+        StompError error;
+        StompFrame frame {error, std::move(plain)};
+        // Commands with required headers fail validation, after being parsed.
+        BOOST_CHECK_NE(error, StompError::kErrorCommandInvalid);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // stomp_frame
 
 BOOST_AUTO_TEST_SUITE_END(); // network_monitor
\ No newline at end of file
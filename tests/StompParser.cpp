@@ -0,0 +1,272 @@
+#include <network-monitor/StompParser.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+using NetworkMonitor::BufferedStompFrame;
+using NetworkMonitor::StompCommand;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompHeader;
+using NetworkMonitor::StompParser;
+
+using namespace std::string_literals;
+
+namespace {
+
+struct ParsedFrames {
+    std::vector<StompError> errors {};
+    std::vector<BufferedStompFrame> frames {};
+
+    StompParser::FrameHandler GetHandler()
+    {
+        return [this](auto error, auto&& frame) {
+            errors.push_back(error);
+            frames.push_back(std::move(frame));
+        };
+    }
+};
+
+const std::string kSendFrame {
+    "SEND\n"
+    "destination:/passengers\n"
+    "\n"
+    "Frame body\0"s
+};
+
+const std::string kMessageFrame {
+    "MESSAGE\n"
+    "destination:/passengers\n"
+    "message-id:42\n"
+    "subscription:sub-0\n"
+    "content-length:11\n"
+    "\n"
+    "Frame\0body\n\0"s
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(stomp_parser);
+
+BOOST_AUTO_TEST_SUITE(class_StompParser);
+
+BOOST_AUTO_TEST_CASE(single_frame)
+{
+    ParsedFrames parsed {};
+    StompParser parser {parsed.GetHandler()};
+    parser.Push(kSendFrame);
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 1);
+    BOOST_CHECK_EQUAL(parsed.errors[0], StompError::kOk);
+    BOOST_CHECK_EQUAL(parsed.frames[0].GetCommand(), StompCommand::kSend);
+    BOOST_CHECK_EQUAL(
+        parsed.frames[0].GetHeaderValue(StompHeader::kDestination),
+        "/passengers"
+    );
+    BOOST_CHECK_EQUAL(parsed.frames[0].GetBody(), "Frame body");
+    BOOST_CHECK_EQUAL(parser.GetBufferedSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(concatenated_frames)
+{
+    ParsedFrames parsed {};
+    StompParser parser {parsed.GetHandler()};
+    parser.Push("\n\r\n" + kSendFrame + "\n\n" + kMessageFrame + kSendFrame + "\n");
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 3);
+    for (const auto error: parsed.errors) {
+        BOOST_CHECK_EQUAL(error, StompError::kOk);
+    }
+    BOOST_CHECK_EQUAL(parsed.frames[0].GetCommand(), StompCommand::kSend);
+    BOOST_CHECK_EQUAL(parsed.frames[1].GetCommand(), StompCommand::kMessage);
+    BOOST_CHECK_EQUAL(parsed.frames[1].GetBody(), "Frame\0body\n"s);
+    BOOST_CHECK_EQUAL(parsed.frames[2].GetCommand(), StompCommand::kSend);
+    BOOST_CHECK_EQUAL(parser.GetBufferedSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(heart_beats)
+{
+    ParsedFrames parsed {};
+    StompParser parser {parsed.GetHandler()};
+    parser.Push("\n");
+    parser.Push("\r\n\n");
+    BOOST_CHECK_EQUAL(parsed.frames.size(), 0);
+    BOOST_CHECK_EQUAL(parser.GetBufferedSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(split_frames)
+{
+    // Every byte arrives on its own.
+    const auto stream {kSendFrame + "\n" + kMessageFrame + kSendFrame};
+    ParsedFrames parsed {};
+    StompParser parser {parsed.GetHandler()};
+    for (const auto c: stream) {
+        parser.Push(std::string_view {&c, 1});
+    }
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 3);
+    for (const auto error: parsed.errors) {
+        BOOST_CHECK_EQUAL(error, StompError::kOk);
+    }
+    BOOST_CHECK_EQUAL(parsed.frames[0].GetBody(), "Frame body");
+    BOOST_CHECK_EQUAL(parsed.frames[1].GetBody(), "Frame\0body\n"s);
+    BOOST_CHECK_EQUAL(
+        parsed.frames[1].GetHeaderValue(StompHeader::kMessageId),
+        "42"
+    );
+    BOOST_CHECK_EQUAL(parsed.frames[2].GetBody(), "Frame body");
+    BOOST_CHECK_EQUAL(parser.GetBufferedSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(split_at_every_offset)
+{
+    const auto stream {kMessageFrame + kSendFrame + kMessageFrame};
+    for (size_t split {1}; split < stream.size(); ++split) {
+        ParsedFrames parsed {};
+        StompParser parser {parsed.GetHandler()};
+        parser.Push(std::string_view {stream}.substr(0, split));
+        parser.Push(std::string_view {stream}.substr(split));
+        BOOST_REQUIRE_EQUAL(parsed.frames.size(), 3);
+        BOOST_CHECK_EQUAL(parsed.errors[0], StompError::kOk);
+        BOOST_CHECK_EQUAL(parsed.errors[1], StompError::kOk);
+        BOOST_CHECK_EQUAL(parsed.errors[2], StompError::kOk);
+        BOOST_CHECK_EQUAL(parsed.frames[2].GetBody(), "Frame\0body\n"s);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(invalid_frame)
+{
+    ParsedFrames parsed {};
+    StompParser parser {parsed.GetHandler()};
+    parser.Push(
+        "SEND\n"
+        "\n"
+        "Missing destination\0"s
+        + kSendFrame
+    );
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 2);
+    BOOST_CHECK_EQUAL(parsed.errors[0], StompError::kErrorHeaderMissing);
+    BOOST_CHECK_EQUAL(parsed.frames[0].GetCommand(), StompCommand::kUnknown);
+    BOOST_CHECK_EQUAL(parsed.errors[1], StompError::kOk);
+    BOOST_CHECK_EQUAL(parsed.frames[1].GetBody(), "Frame body");
+}
+
+BOOST_AUTO_TEST_CASE(content_length_missing_null)
+{
+    // The parser resynchronizes at the next NUL byte.
+    ParsedFrames parsed {};
+    StompParser parser {parsed.GetHandler()};
+    parser.Push(
+        "SEND\n"
+        "destination:/passengers\n"
+        "content-length:2\n"
+        "\n"
+        "Frame body\0"s
+        + kSendFrame
+    );
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 2);
+    BOOST_CHECK_EQUAL(parsed.errors[0], StompError::kErrorBodyMissingNull);
+    BOOST_CHECK_EQUAL(parsed.errors[1], StompError::kOk);
+    BOOST_CHECK_EQUAL(parsed.frames[1].GetBody(), "Frame body");
+    BOOST_CHECK_EQUAL(parser.GetBufferedSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(content_length_invalid)
+{
+    // The body ends at the first NUL byte.
+    ParsedFrames parsed {};
+    StompParser parser {parsed.GetHandler()};
+    parser.Push(
+        "SEND\n"
+        "destination:/passengers\n"
+        "content-length:two\n"
+        "\n"
+        "Frame body\0"s
+        + kSendFrame
+    );
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 2);
+    BOOST_CHECK_EQUAL(parsed.errors[0], StompError::kErrorHeaderContentLength);
+    BOOST_CHECK_EQUAL(parsed.errors[1], StompError::kOk);
+}
+
+BOOST_AUTO_TEST_CASE(crlf_line_endings)
+{
+    // The frame is rejected as StompFrame rejects it, without waiting for the
+    // maximum frame size.
+    const std::string crlfFrame {
+        "SEND\r\n"
+        "destination:/passengers\r\n"
+        "\r\n"
+        "Frame body\0"s
+    };
+    StompError expected {};
+    StompFrame {expected, crlfFrame};
+    BOOST_REQUIRE_NE(expected, StompError::kOk);
+
+    ParsedFrames parsed {};
+    StompParser parser {parsed.GetHandler()};
+    parser.Push(crlfFrame + kSendFrame);
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 2);
+    BOOST_CHECK_EQUAL(parsed.errors[0], expected);
+    BOOST_CHECK_EQUAL(parsed.errors[1], StompError::kOk);
+    BOOST_CHECK_EQUAL(parser.GetBufferedSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(max_frame_size)
+{
+    const std::string largeFrame {
+        "SEND\n"
+        "destination:/passengers\n"
+        "\n"
+        + std::string(100, 'x')
+        + "\0"s
+    };
+    const auto maxFrameSize {kSendFrame.size()};
+
+    // A whole frame.
+    {
+        ParsedFrames parsed {};
+        StompParser parser {parsed.GetHandler(), maxFrameSize};
+        parser.Push(largeFrame + kSendFrame);
+        BOOST_REQUIRE_EQUAL(parsed.frames.size(), 2);
+        BOOST_CHECK_EQUAL(parsed.errors[0], StompError::kErrorBodyLength);
+        BOOST_CHECK_EQUAL(parsed.frames[0].GetCommand(), StompCommand::kUnknown);
+        BOOST_CHECK_EQUAL(parsed.errors[1], StompError::kOk);
+    }
+
+    // A frame that arrives in chunks is not buffered past the maximum size.
+    {
+        ParsedFrames parsed {};
+        StompParser parser {parsed.GetHandler(), maxFrameSize};
+        const auto stream {largeFrame + kSendFrame};
+        for (size_t offset {0}; offset < stream.size(); offset += 10) {
+            parser.Push(std::string_view {stream}.substr(offset, 10));
+            BOOST_CHECK_LE(parser.GetBufferedSize(), maxFrameSize);
+        }
+        BOOST_REQUIRE_EQUAL(parsed.frames.size(), 2);
+        BOOST_CHECK_EQUAL(parsed.errors[0], StompError::kErrorBodyLength);
+        BOOST_CHECK_EQUAL(parsed.errors[1], StompError::kOk);
+        BOOST_CHECK_EQUAL(parsed.frames[1].GetBody(), "Frame body");
+        BOOST_CHECK_EQUAL(parser.GetBufferedSize(), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(reset)
+{
+    ParsedFrames parsed {};
+    StompParser parser {parsed.GetHandler()};
+    parser.Push(kSendFrame.substr(0, 10));
+    BOOST_CHECK_EQUAL(parser.GetBufferedSize(), 10);
+    parser.Reset();
+    BOOST_CHECK_EQUAL(parser.GetBufferedSize(), 0);
+    parser.Push(kSendFrame);
+    BOOST_REQUIRE_EQUAL(parsed.frames.size(), 1);
+    BOOST_CHECK_EQUAL(parsed.errors[0], StompError::kOk);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // class_StompParser
+
+BOOST_AUTO_TEST_SUITE_END(); // stomp_parser
+
+BOOST_AUTO_TEST_SUITE_END(); // network_monitor
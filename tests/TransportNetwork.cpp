@@ -3,16 +3,24 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 using NetworkMonitor::Id;
+using NetworkMonitor::ItineraryHandles;
 using NetworkMonitor::Line;
+using NetworkMonitor::NetworkLayout;
 using NetworkMonitor::PassengerEvent;
 using NetworkMonitor::Route;
 using NetworkMonitor::Station;
+using NetworkMonitor::StationHandle;
 using NetworkMonitor::TransportNetwork;
 
 using NetworkMonitor::ParseJsonFile;
@@ -209,6 +217,65 @@ BOOST_AUTO_TEST_CASE(duplicate)
     BOOST_CHECK(!ok);
 }
 
+BOOST_AUTO_TEST_CASE(missing_station)
+{
+    TransportNetwork nw {};
+    bool ok {false};
+
+    // A line with a route through an unknown station is rejected as a whole.
+    // route0: 0 ---> 1
+    // route1: 1 ---> 2 (station 2 is not in the network)
+    Station station0 {
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1 {
+        "station_001",
+        "Station Name 1",
+    };
+    Route route0 {
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_001",
+        {"station_000", "station_001"},
+    };
+    Route route1 {
+        "route_001",
+        "Route Name 1",
+        "line_000",
+        "station_001",
+        "station_002",
+        {"station_001", "station_002"},
+    };
+    Line line {
+        "line_000",
+        "Line Name",
+        {route0, route1},
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    BOOST_REQUIRE(ok);
+    ok = nw.AddLine(line);
+    BOOST_CHECK(!ok);
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation(station0.id).size(), 0);
+    BOOST_CHECK(!nw.SetTravelTime(station0.id, station1.id, 1));
+
+    // Once the station exists, the same line can be added.
+    Station station2 {
+        "station_002",
+        "Station Name 2",
+    };
+    ok = nw.AddStation(station2);
+    BOOST_REQUIRE(ok);
+    ok = nw.AddLine(line);
+    BOOST_CHECK(ok);
+    BOOST_CHECK(nw.SetTravelTime(station1.id, station2.id, 1));
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(station1.id, station2.id), 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // AddLine
 
 BOOST_AUTO_TEST_SUITE(PassengerEvents);
@@ -287,6 +354,219 @@ BOOST_AUTO_TEST_CASE(basic)
     BOOST_CHECK_EQUAL(nw.GetPassengerCount(station2.id), -1);
 }
 
+BOOST_AUTO_TEST_CASE(batch)
+{
+    auto testFilePath {
+        std::filesystem::path(TESTS_JSON_FOLDER) / "network-layout.json"
+    };
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(testFilePath))};
+    BOOST_REQUIRE(ok);
+
+    using EventType = PassengerEvent::Type;
+    std::vector<PassengerEvent> events {
+        {"station_000", EventType::In},
+        {"station_000", EventType::In},
+        {"station_001", EventType::Out},
+        {"station_42", EventType::In}, // Not in the network
+        {"station_000", EventType::Out},
+        {"station_002", EventType::In},
+        {"station_002", EventType::Out},
+        {"station_001", static_cast<EventType>(42)}, // Not recognized
+        {"station_001", EventType::Out},
+    };
+    auto failed {nw.RecordPassengerEvents(events)};
+    BOOST_REQUIRE_EQUAL(failed.size(), 2);
+    BOOST_CHECK_EQUAL(failed[0], 3);
+    BOOST_CHECK_EQUAL(failed[1], 7);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount("station_000"), 1);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount("station_001"), -2);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount("station_002"), 0);
+
+    // A second batch adds to the counts.
+    failed = nw.RecordPassengerEvents(events);
+    BOOST_CHECK_EQUAL(failed.size(), 2);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount("station_000"), 2);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount("station_001"), -4);
+
+    // Empty batch.
+    BOOST_CHECK(nw.RecordPassengerEvents({}).empty());
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount("station_000"), 2);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_writers)
+{
+    auto testFilePath {
+        std::filesystem::path(TESTS_JSON_FOLDER) / "network-layout.json"
+    };
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(testFilePath))};
+    BOOST_REQUIRE(ok);
+
+    // Each thread records events at a shared station and at a station of its
+    // own, while the main thread reads the shared count.
+    constexpr size_t nThreads {4};
+    constexpr int64_t nEvents {20000};
+    auto shared {nw.GetStationHandle("station_000")};
+    std::vector<std::thread> threads {};
+    for (size_t idx {0}; idx < nThreads; ++idx) {
+        threads.emplace_back([&nw, shared, idx]() {
+            using EventType = PassengerEvent::Type;
+            StationHandle own {static_cast<uint32_t>(idx + 1)};
+            for (int64_t event {0}; event < nEvents; ++event) {
+                nw.RecordPassengerEvent(shared, EventType::In);
+                nw.RecordPassengerEvent(own, EventType::Out);
+            }
+        });
+    }
+    int64_t previous {0};
+    for (size_t idx {0}; idx < 1000; ++idx) {
+        auto count {nw.GetPassengerCount(shared)};
+        BOOST_REQUIRE_GE(count, previous);
+        previous = count;
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(shared), nThreads * nEvents);
+    for (size_t idx {0}; idx < nThreads; ++idx) {
+        StationHandle own {static_cast<uint32_t>(idx + 1)};
+        BOOST_CHECK_EQUAL(nw.GetPassengerCount(own), -nEvents);
+    }
+
+    // Copies carry the counts over.
+    auto copy {nw};
+    BOOST_CHECK_EQUAL(copy.GetPassengerCount(shared), nThreads * nEvents);
+}
+
+BOOST_AUTO_TEST_CASE(flows)
+{
+    auto testFilePath {
+        std::filesystem::path(TESTS_JSON_FOLDER) / "network-layout.json"
+    };
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(testFilePath))};
+    BOOST_REQUIRE(ok);
+
+    using namespace std::chrono_literals;
+    using EventType = PassengerEvent::Type;
+    const auto station {nw.GetStationHandle("station_000")};
+    const std::chrono::system_clock::time_point t0 {
+        std::chrono::hours {24 * 365 * 50}
+    };
+
+    // Nothing is recorded until the flows are enabled.
+    BOOST_CHECK(!nw.HasPassengerFlows());
+    BOOST_REQUIRE(nw.RecordPassengerEvent(station, EventType::In, t0));
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station, t0, t0 + 1h).in, 0);
+    BOOST_CHECK(nw.GetPassengerFlowRates(station, t0, t0 + 1h, 1min).empty());
+    BOOST_CHECK(!nw.EnablePassengerFlows(0s, 10));
+    BOOST_CHECK(!nw.EnablePassengerFlows(1min, 0));
+    BOOST_REQUIRE(nw.EnablePassengerFlows());
+    BOOST_CHECK(nw.HasPassengerFlows());
+
+    // 1-minute buckets.
+    // minute 0: 2 in, 1 out
+    // minute 1: 1 out
+    // minute 3: 4 in
+    std::vector<PassengerEvent> events {
+        {"station_000", EventType::In, t0},
+        {"station_000", EventType::Out, t0 + 10s},
+        {"station_000", EventType::In, t0 + 59s},
+        {"station_000", EventType::Out, t0 + 60s},
+        {"station_001", EventType::In, t0 + 60s},
+    };
+    BOOST_REQUIRE(nw.RecordPassengerEvents(events).empty());
+    for (size_t idx {0}; idx < 4; ++idx) {
+        ok = nw.RecordPassengerEvent({"station_000", EventType::In, t0 + 200s});
+        BOOST_REQUIRE(ok);
+    }
+
+    auto flow {nw.GetPassengerFlow(station, t0, t0 + 1h)};
+    BOOST_CHECK_EQUAL(flow.in, 6);
+    BOOST_CHECK_EQUAL(flow.out, 2);
+    flow = nw.GetPassengerFlow(station, t0 + 30s, t0 + 90s);
+    BOOST_CHECK_EQUAL(flow.in, 2); // Widened to [t0, t0 + 2min).
+    BOOST_CHECK_EQUAL(flow.out, 2);
+    flow = nw.GetPassengerFlow(station, t0 + 60s, t0 + 120s);
+    BOOST_CHECK_EQUAL(flow.in, 0);
+    BOOST_CHECK_EQUAL(flow.out, 1);
+    flow = nw.GetPassengerFlow(station, t0 - 24h, t0 + 48h);
+    BOOST_CHECK_EQUAL(flow.in, 6);
+    BOOST_CHECK_EQUAL(flow.out, 2);
+    flow = nw.GetPassengerFlow(nw.GetStationHandle("station_001"), t0, t0 + 1h);
+    BOOST_CHECK_EQUAL(flow.in, 1);
+
+    // Moving average over 2 minutes, in passengers per minute.
+    auto rates {nw.GetPassengerFlowRates(station, t0, t0 + 4min, 2min)};
+    BOOST_REQUIRE_EQUAL(rates.size(), 4);
+    BOOST_CHECK_CLOSE(rates[0].in, 1.0, 1e-9);
+    BOOST_CHECK_CLOSE(rates[0].out, 0.5, 1e-9);
+    BOOST_CHECK_CLOSE(rates[1].in, 1.0, 1e-9);
+    BOOST_CHECK_CLOSE(rates[1].out, 1.0, 1e-9);
+    BOOST_CHECK_CLOSE(rates[2].in, 0.0, 1e-9);
+    BOOST_CHECK_CLOSE(rates[2].out, 0.5, 1e-9);
+    BOOST_CHECK_CLOSE(rates[3].in, 2.0, 1e-9);
+    BOOST_CHECK_CLOSE(rates[3].out, 0.0, 1e-9);
+    BOOST_CHECK(nw.GetPassengerFlowRates(station, t0, t0 + 48h, 1min).empty());
+
+    // Events without a timestamp are recorded now.
+    const auto now {std::chrono::system_clock::now()};
+    BOOST_REQUIRE(nw.RecordPassengerEvent({"station_000", EventType::Out}));
+    flow = nw.GetPassengerFlow(station, now - 1min, now + 1min);
+    BOOST_CHECK_EQUAL(flow.out, 1);
+
+    // The passenger count is not affected by the flows.
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station), 4);
+}
+
+BOOST_AUTO_TEST_CASE(flows_ring)
+{
+    auto testFilePath {
+        std::filesystem::path(TESTS_JSON_FOLDER) / "network-layout.json"
+    };
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(testFilePath))};
+    BOOST_REQUIRE(ok);
+
+    using namespace std::chrono_literals;
+    using EventType = PassengerEvent::Type;
+    const auto station {nw.GetStationHandle("station_000")};
+    const std::chrono::system_clock::time_point t0 {
+        std::chrono::hours {24 * 365 * 50}
+    };
+
+    // 4 buckets of 10 seconds.
+    BOOST_REQUIRE(nw.EnablePassengerFlows(10s, 4));
+    BOOST_REQUIRE(nw.RecordPassengerEvent(station, EventType::In, t0));
+    BOOST_REQUIRE(nw.RecordPassengerEvent(station, EventType::In, t0 + 10s));
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station, t0, t0 + 1min).in, 2);
+
+    // Bucket 4 reuses the slot of bucket 0.
+    BOOST_REQUIRE(nw.RecordPassengerEvent(station, EventType::In, t0 + 40s));
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station, t0, t0 + 10s).in, 0);
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station, t0, t0 + 1min).in, 2);
+
+    // Events older than the ring are dropped.
+    BOOST_REQUIRE(nw.RecordPassengerEvent(station, EventType::In, t0 + 5s));
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station, t0, t0 + 1min).in, 2);
+
+    // Stations added later get their own buckets, and copies keep the flows.
+    BOOST_REQUIRE(nw.AddStation({"station_new", "New Station"}));
+    const auto newStation {nw.GetStationHandle("station_new")};
+    BOOST_REQUIRE(nw.RecordPassengerEvent(newStation, EventType::Out, t0));
+    auto copy {nw};
+    BOOST_CHECK_EQUAL(copy.GetPassengerFlow(newStation, t0, t0 + 10s).out, 1);
+    BOOST_CHECK_EQUAL(copy.GetPassengerFlow(station, t0, t0 + 1min).in, 2);
+
+    // Changing the configuration discards the flows.
+    BOOST_REQUIRE(nw.EnablePassengerFlows(10s, 4));
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station, t0, t0 + 1min).in, 2);
+    BOOST_REQUIRE(nw.EnablePassengerFlows(20s, 4));
+    BOOST_CHECK_EQUAL(nw.GetPassengerFlow(station, t0, t0 + 1min).in, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // PassengerEvents
 
 BOOST_AUTO_TEST_SUITE(GetRoutesServingStation);
@@ -352,6 +632,102 @@ BOOST_AUTO_TEST_CASE(basic)
     BOOST_CHECK_EQUAL(routes.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(departing_and_terminating)
+{
+    TransportNetwork nw {};
+    bool ok {false};
+
+    // Add two lines.
+    // line0, route0: 0 ---> 1 ---> 2
+    // line0, route1: 2 ---> 1 ---> 0
+    // line1, route2: 3 ---> 1
+    Station station0 {
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1 {
+        "station_001",
+        "Station Name 1",
+    };
+    Station station2 {
+        "station_002",
+        "Station Name 2",
+    };
+    Station station3 {
+        "station_003",
+        "Station Name 3",
+    };
+    Route route0 {
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_002",
+        {"station_000", "station_001", "station_002"},
+    };
+    Route route1 {
+        "route_001",
+        "Route Name 1",
+        "line_000",
+        "station_002",
+        "station_000",
+        {"station_002", "station_001", "station_000"},
+    };
+    Route route2 {
+        "route_002",
+        "Route Name 2",
+        "line_001",
+        "station_003",
+        "station_001",
+        {"station_003", "station_001"},
+    };
+    Line line0 {
+        "line_000",
+        "Line Name 0",
+        {route0, route1},
+    };
+    Line line1 {
+        "line_001",
+        "Line Name 1",
+        {route2},
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    ok &= nw.AddStation(station2);
+    ok &= nw.AddStation(station3);
+    BOOST_REQUIRE(ok);
+    ok = true;
+    ok &= nw.AddLine(line0);
+    ok &= nw.AddLine(line1);
+    BOOST_REQUIRE(ok);
+
+    std::vector<Id> routes {};
+    routes = nw.GetRoutesServingStation(station1.id);
+    BOOST_REQUIRE_EQUAL(routes.size(), 3);
+    BOOST_CHECK_EQUAL(routes[0], route0.id);
+    BOOST_CHECK_EQUAL(routes[1], route1.id);
+    BOOST_CHECK_EQUAL(routes[2], route2.id);
+    routes = nw.GetRoutesServingStation(station2.id);
+    BOOST_REQUIRE_EQUAL(routes.size(), 2);
+    BOOST_CHECK_EQUAL(routes[0], route0.id);
+    BOOST_CHECK_EQUAL(routes[1], route1.id);
+    routes = nw.GetRoutesServingStation(station3.id);
+    BOOST_REQUIRE_EQUAL(routes.size(), 1);
+    BOOST_CHECK_EQUAL(routes[0], route2.id);
+
+    // The handle-based overload returns the stored list.
+    const auto& handles {
+        nw.GetRoutesServingStation(nw.GetStationHandle(station0.id))
+    };
+    BOOST_REQUIRE_EQUAL(handles.size(), 2);
+    BOOST_CHECK(handles[0] == nw.GetRouteHandle(line0.id, route0.id));
+    BOOST_CHECK(handles[1] == nw.GetRouteHandle(line0.id, route1.id));
+    BOOST_CHECK(
+        &handles == &nw.GetRoutesServingStation(nw.GetStationHandle(station0.id))
+    );
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // GetRoutesServingStation
 
 BOOST_AUTO_TEST_SUITE(TravelTime);
@@ -528,43 +904,838 @@ BOOST_AUTO_TEST_CASE(over_route)
     );
 }
 
-BOOST_AUTO_TEST_SUITE_END(); // TravelTime
-
-BOOST_AUTO_TEST_SUITE(FromJson);
-
-BOOST_AUTO_TEST_CASE(from_json_1line_1route)
+BOOST_AUTO_TEST_CASE(over_route_update)
 {
-    auto testFilePath {
-        std::filesystem::path(TESTS_JSON_FOLDER) / "from_json_1line_1route.json"
-    };
-    auto src = ParseJsonFile(testFilePath);
-
     TransportNetwork nw {};
-    auto ok {nw.FromJson(std::move(src))};
+    bool ok {false};
+
+    // Add a line with 1 route.
+    // route0: 0 ---> 1 ---> 2 ---> 3
+    Station station0 {
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1 {
+        "station_001",
+        "Station Name 1",
+    };
+    Station station2 {
+        "station_002",
+        "Station Name 2",
+    };
+    Station station3 {
+        "station_003",
+        "Station Name 3",
+    };
+    Route route0 {
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_001", "station_002", "station_003"},
+    };
+    Line line {
+        "line_000",
+        "Line Name",
+        {route0},
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    ok &= nw.AddStation(station2);
+    ok &= nw.AddStation(station3);
+    BOOST_REQUIRE(ok);
+    ok = nw.AddLine(line);
     BOOST_REQUIRE(ok);
 
-    auto routes {nw.GetRoutesServingStation("station_0")};
-    BOOST_REQUIRE_EQUAL(routes.size(), 1);
-    BOOST_CHECK_EQUAL(routes[0], "route_0");
+    ok = true;
+    ok &= nw.SetTravelTime(station0.id, station1.id, 1);
+    ok &= nw.SetTravelTime(station1.id, station2.id, 2);
+    ok &= nw.SetTravelTime(station2.id, station3.id, 3);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime(line.id, route0.id, station0.id, station3.id), 1 + 2 + 3
+    );
 
-	auto travelTime {nw.GetTravelTime(
-		"line_0",
-		"route_0",
-		"station_0",
-		"station_1"
-		)
-	};
-	BOOST_REQUIRE_EQUAL(travelTime, 5);
-	BOOST_REQUIRE_EQUAL(nw.GetTravelTime("station_0", "station_1"), 5);
-	BOOST_REQUIRE_EQUAL(nw.GetTravelTime("station_1", "station_0"), 5);
+    // Changing a travel time updates every trip that goes over it, whether
+    // the new value is larger or smaller.
+    ok = nw.SetTravelTime(station1.id, station2.id, 10);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime(line.id, route0.id, station0.id, station3.id), 1 + 10 + 3
+    );
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime(line.id, route0.id, station2.id, station3.id), 3
+    );
+    ok = nw.SetTravelTime(station2.id, station1.id, 1);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime(line.id, route0.id, station0.id, station3.id), 1 + 1 + 3
+    );
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime(line.id, route0.id, station1.id, station2.id), 1
+    );
 }
 
-BOOST_AUTO_TEST_CASE(from_json_not_connected_stations)
-{
-    auto testFilePath {
-        std::filesystem::path(TESTS_JSON_FOLDER) / "from_json_not_connected_stations.json"
-    };
-    auto src = ParseJsonFile(testFilePath);
+BOOST_AUTO_TEST_SUITE_END(); // TravelTime
+
+BOOST_AUTO_TEST_SUITE(Handles);
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    TransportNetwork nw {};
+    bool ok {false};
+
+    // Add a line with 1 route.
+    // route0: 0 ---> 1 ---> 2
+    Station station0 {
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1 {
+        "station_001",
+        "Station Name 1",
+    };
+    Station station2 {
+        "station_002",
+        "Station Name 2",
+    };
+    Route route0 {
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_002",
+        {"station_000", "station_001", "station_002"},
+    };
+    Line line {
+        "line_000",
+        "Line Name",
+        {route0},
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    ok &= nw.AddStation(station2);
+    BOOST_REQUIRE(ok);
+    ok = nw.AddLine(line);
+    BOOST_REQUIRE(ok);
+    ok = true;
+    ok &= nw.SetTravelTime(station0.id, station1.id, 1);
+    ok &= nw.SetTravelTime(station1.id, station2.id, 2);
+    BOOST_REQUIRE(ok);
+
+    // Resolve the IDs.
+    auto handle0 {nw.GetStationHandle(station0.id)};
+    auto handle1 {nw.GetStationHandle(station1.id)};
+    auto handle2 {nw.GetStationHandle(station2.id)};
+    auto lineHandle {nw.GetLineHandle(line.id)};
+    auto routeHandle {nw.GetRouteHandle(line.id, route0.id)};
+    BOOST_REQUIRE(handle0.IsValid());
+    BOOST_REQUIRE(handle1.IsValid());
+    BOOST_REQUIRE(handle2.IsValid());
+    BOOST_REQUIRE(lineHandle.IsValid());
+    BOOST_REQUIRE(routeHandle.IsValid());
+    BOOST_CHECK(handle0 != handle1);
+    BOOST_CHECK(handle0 == nw.GetStationHandle(station0.id));
+    BOOST_CHECK_EQUAL(nw.GetStationId(handle1), station1.id);
+    BOOST_CHECK_EQUAL(nw.GetLineId(lineHandle), line.id);
+    BOOST_CHECK_EQUAL(nw.GetRouteId(routeHandle), route0.id);
+
+    // Unknown IDs give invalid handles.
+    BOOST_CHECK(!nw.GetStationHandle("station_42").IsValid());
+    BOOST_CHECK(!nw.GetLineHandle("line_42").IsValid());
+    BOOST_CHECK(!nw.GetRouteHandle("line_42", route0.id).IsValid());
+    BOOST_CHECK(!nw.GetRouteHandle(line.id, "route_42").IsValid());
+    BOOST_CHECK_EQUAL(nw.GetStationId({}), "");
+
+    // Handle-based queries.
+    using EventType = PassengerEvent::Type;
+    ok = nw.RecordPassengerEvent(handle1, EventType::In);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(handle1), 1);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station1.id), 1);
+    BOOST_CHECK(!nw.RecordPassengerEvent(StationHandle {}, EventType::In));
+    BOOST_CHECK_THROW(nw.GetPassengerCount(StationHandle {}), std::runtime_error);
+
+    auto routes {nw.GetRoutesServingStation(handle2)};
+    BOOST_REQUIRE_EQUAL(routes.size(), 1);
+    BOOST_CHECK(routes[0] == routeHandle);
+
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(handle1, handle2), 2);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(handle2, handle1), 2);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(routeHandle, handle0, handle2), 1 + 2);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime(routeHandle, handle2, handle0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(duplicate_route_id)
+{
+    TransportNetwork nw {};
+    bool ok {false};
+
+    // Route IDs are unique across all lines.
+    Station station0 {
+        "station_000",
+        "Station Name 0",
+    };
+    Station station1 {
+        "station_001",
+        "Station Name 1",
+    };
+    Route route0 {
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_001",
+        {"station_000", "station_001"},
+    };
+    Line line0 {
+        "line_000",
+        "Line Name 0",
+        {route0},
+    };
+    Line line1 {
+        "line_001",
+        "Line Name 1",
+        {route0},
+    };
+    ok = true;
+    ok &= nw.AddStation(station0);
+    ok &= nw.AddStation(station1);
+    BOOST_REQUIRE(ok);
+    ok = nw.AddLine(line0);
+    BOOST_REQUIRE(ok);
+    ok = nw.AddLine(line1);
+    BOOST_CHECK(!ok);
+    BOOST_CHECK(!nw.GetLineHandle(line1.id).IsValid());
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // Handles
+
+BOOST_AUTO_TEST_SUITE(FastestPath);
+
+// Two lines crossing at station 2.
+// line0, route0: 0 ---> 1 ---> 2 ---> 3
+// line1, route1: 4 ---> 2 ---> 5 ---> 3
+static TransportNetwork MakeCrossingLines()
+{
+    TransportNetwork nw {};
+    bool ok {true};
+    for (const auto& id: {"0", "1", "2", "3", "4", "5"}) {
+        ok &= nw.AddStation({std::string("station_00") + id, "Station Name"});
+    }
+    Route route0 {
+        "route_000",
+        "Route Name 0",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_001", "station_002", "station_003"},
+    };
+    Route route1 {
+        "route_001",
+        "Route Name 1",
+        "line_001",
+        "station_004",
+        "station_003",
+        {"station_004", "station_002", "station_005", "station_003"},
+    };
+    ok &= nw.AddLine({"line_000", "Line Name 0", {route0}});
+    ok &= nw.AddLine({"line_001", "Line Name 1", {route1}});
+    ok &= nw.SetTravelTime("station_000", "station_001", 1);
+    ok &= nw.SetTravelTime("station_001", "station_002", 1);
+    ok &= nw.SetTravelTime("station_002", "station_003", 5);
+    ok &= nw.SetTravelTime("station_004", "station_002", 1);
+    ok &= nw.SetTravelTime("station_002", "station_005", 1);
+    ok &= nw.SetTravelTime("station_005", "station_003", 1);
+    BOOST_REQUIRE(ok);
+    return nw;
+}
+
+BOOST_AUTO_TEST_CASE(basic)
+{
+    auto nw {MakeCrossingLines()};
+
+    // Without penalty, changing to line1 at station 2 is faster.
+    auto itinerary {nw.GetFastestPath("station_000", "station_003")};
+    std::vector<Id> expectedStations {
+        "station_000", "station_001", "station_002", "station_005", "station_003"
+    };
+    std::vector<Id> expectedRoutes {
+        "route_000", "route_000", "route_001", "route_001"
+    };
+    BOOST_CHECK(itinerary.stations == expectedStations);
+    BOOST_CHECK(itinerary.routes == expectedRoutes);
+    BOOST_CHECK_EQUAL(itinerary.totalTime, 1 + 1 + 1 + 1);
+
+    // A large enough penalty makes staying on line0 the fastest option.
+    nw.SetLineChangePenalty(10);
+    BOOST_CHECK_EQUAL(nw.GetLineChangePenalty(), 10);
+    itinerary = nw.GetFastestPath("station_000", "station_003");
+    expectedStations = {
+        "station_000", "station_001", "station_002", "station_003"
+    };
+    expectedRoutes = {"route_000", "route_000", "route_000"};
+    BOOST_CHECK(itinerary.stations == expectedStations);
+    BOOST_CHECK(itinerary.routes == expectedRoutes);
+    BOOST_CHECK_EQUAL(itinerary.totalTime, 1 + 1 + 5);
+
+    // The penalty counts towards the total time when changing is required.
+    itinerary = nw.GetFastestPath("station_000", "station_005");
+    BOOST_CHECK_EQUAL(itinerary.stations.size(), 4);
+    BOOST_CHECK_EQUAL(itinerary.totalTime, 1 + 1 + 10 + 1);
+}
+
+BOOST_AUTO_TEST_CASE(no_path)
+{
+    auto nw {MakeCrossingLines()};
+
+    // Routes only go one way.
+    auto itinerary {nw.GetFastestPath("station_003", "station_000")};
+    BOOST_CHECK(itinerary.stations.empty());
+    BOOST_CHECK(itinerary.routes.empty());
+
+    // Unknown station.
+    itinerary = nw.GetFastestPath("station_000", "station_042");
+    BOOST_CHECK(itinerary.stations.empty());
+
+    // Same station.
+    itinerary = nw.GetFastestPath("station_002", "station_002");
+    BOOST_REQUIRE_EQUAL(itinerary.stations.size(), 1);
+    BOOST_CHECK(itinerary.routes.empty());
+    BOOST_CHECK_EQUAL(itinerary.totalTime, 0);
+}
+
+BOOST_AUTO_TEST_CASE(handles)
+{
+    auto nw {MakeCrossingLines()};
+
+    ItineraryHandles itinerary {};
+    bool ok {nw.GetFastestPath(
+        nw.GetStationHandle("station_004"),
+        nw.GetStationHandle("station_003"),
+        itinerary
+    )};
+    BOOST_REQUIRE(ok);
+    BOOST_REQUIRE_EQUAL(itinerary.stations.size(), 4);
+    BOOST_REQUIRE_EQUAL(itinerary.routes.size(), 3);
+    BOOST_CHECK_EQUAL(nw.GetStationId(itinerary.stations[0]), "station_004");
+    BOOST_CHECK_EQUAL(nw.GetStationId(itinerary.stations[3]), "station_003");
+    BOOST_CHECK(itinerary.routes[0] == nw.GetRouteHandle("line_001", "route_001"));
+    BOOST_CHECK_EQUAL(itinerary.totalTime, 3);
+
+    ok = nw.GetFastestPath(
+        nw.GetStationHandle("station_003"),
+        nw.GetStationHandle("station_004"),
+        itinerary
+    );
+    BOOST_CHECK(!ok);
+    BOOST_CHECK(itinerary.stations.empty());
+}
+
+BOOST_AUTO_TEST_CASE(network_layout)
+{
+    auto testFilePath {
+        std::filesystem::path(TESTS_JSON_FOLDER) / "network-layout.json"
+    };
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(testFilePath))};
+    BOOST_REQUIRE(ok);
+
+    // Along a single route, the fastest path matches the route travel time.
+    auto itinerary {nw.GetFastestPath("station_145", "station_150")};
+    BOOST_REQUIRE(!itinerary.stations.empty());
+    BOOST_CHECK_LE(itinerary.totalTime, nw.GetTravelTime(
+        "line_005", "route_031", "station_145", "station_150"
+    ));
+
+    // The total time is the sum of the travel times between stations.
+    uint32_t totalTime {0};
+    for (size_t idx {0}; idx + 1 < itinerary.stations.size(); ++idx) {
+        totalTime += nw.GetTravelTime(
+            itinerary.stations[idx],
+            itinerary.stations[idx + 1]
+        );
+    }
+    BOOST_CHECK_EQUAL(itinerary.totalTime, totalTime);
+}
+
+BOOST_AUTO_TEST_CASE(contraction_hierarchy)
+{
+    auto testFilePath {
+        std::filesystem::path(TESTS_JSON_FOLDER) / "network-layout.json"
+    };
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(testFilePath))};
+    BOOST_REQUIRE(ok);
+
+    // Reference travel times, without the hierarchy.
+    std::vector<Id> stations {
+        "station_000", "station_017", "station_145", "station_150", "station_231"
+    };
+    std::vector<uint32_t> expected {};
+    for (const auto& stationA: stations) {
+        for (const auto& stationB: stations) {
+            expected.push_back(nw.GetFastestTravelTime(stationA, stationB));
+            BOOST_CHECK_EQUAL(
+                expected.back(),
+                nw.GetFastestPath(stationA, stationB).totalTime
+            );
+        }
+    }
+
+    BOOST_CHECK(!nw.HasContractionHierarchy());
+    nw.BuildContractionHierarchy();
+    BOOST_REQUIRE(nw.HasContractionHierarchy());
+    size_t idx {0};
+    for (const auto& stationA: stations) {
+        for (const auto& stationB: stations) {
+            BOOST_CHECK_EQUAL(
+                nw.GetFastestTravelTime(stationA, stationB),
+                expected[idx++]
+            );
+        }
+    }
+    BOOST_CHECK_EQUAL(
+        nw.GetFastestTravelTime("station_000", "station_042x"),
+        TransportNetwork::kUnreachable
+    );
+
+    // The hierarchy follows travel time changes.
+    auto itinerary {nw.GetFastestPath("station_145", "station_150")};
+    BOOST_REQUIRE_GE(itinerary.stations.size(), 2);
+    ok = nw.SetTravelTime(itinerary.stations[0], itinerary.stations[1], 1000);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(nw.HasContractionHierarchy());
+    for (const auto& stationA: stations) {
+        for (const auto& stationB: stations) {
+            auto travelTime {nw.GetFastestTravelTime(stationA, stationB)};
+            BOOST_CHECK_EQUAL(
+                travelTime,
+                nw.GetFastestPath(stationA, stationB).totalTime
+            );
+        }
+    }
+
+    // Layout changes discard the hierarchy.
+    ok = nw.AddStation({"station_new", "New Station"});
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(!nw.HasContractionHierarchy());
+}
+
+BOOST_AUTO_TEST_CASE(travel_time_matrix)
+{
+    auto testFilePath {
+        std::filesystem::path(TESTS_JSON_FOLDER) / "network-layout.json"
+    };
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(testFilePath))};
+    BOOST_REQUIRE(ok);
+
+    BOOST_CHECK(!nw.HasTravelTimeMatrix());
+    nw.BuildTravelTimeMatrix();
+    BOOST_REQUIRE(nw.HasTravelTimeMatrix());
+    const auto nStations {nw.GetStationCount()};
+    BOOST_REQUIRE_GT(nStations, 0);
+    for (uint32_t stationA {0}; stationA < nStations; stationA += 17) {
+        for (uint32_t stationB {0}; stationB < nStations; stationB += 13) {
+            BOOST_CHECK_EQUAL(
+                nw.LookupTravelTime({stationA}, {stationB}),
+                nw.GetFastestTravelTime(StationHandle {stationA}, {stationB})
+            );
+        }
+    }
+
+    // Change some travel times, both up and down, then compare the updated
+    // matrix with one computed from scratch.
+    auto itinerary {nw.GetFastestPath("station_000", "station_150")};
+    BOOST_REQUIRE_GE(itinerary.stations.size(), 3);
+    ok = true;
+    ok &= nw.SetTravelTime(itinerary.stations[0], itinerary.stations[1], 100);
+    ok &= nw.SetTravelTime(itinerary.stations[2], itinerary.stations[1], 0);
+    BOOST_REQUIRE(ok);
+    BOOST_REQUIRE(nw.HasTravelTimeMatrix());
+
+    auto reference {nw};
+    reference.BuildTravelTimeMatrix();
+    size_t nMismatches {0};
+    for (uint32_t stationA {0}; stationA < nStations; ++stationA) {
+        for (uint32_t stationB {0}; stationB < nStations; ++stationB) {
+            nMismatches += nw.LookupTravelTime({stationA}, {stationB})
+                != reference.LookupTravelTime({stationA}, {stationB});
+        }
+    }
+    BOOST_CHECK_EQUAL(nMismatches, 0);
+
+    // Layout changes discard the matrix.
+    ok = nw.AddStation({"station_new", "New Station"});
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(!nw.HasTravelTimeMatrix());
+}
+
+BOOST_AUTO_TEST_CASE(travel_suggestions)
+{
+    auto nw {MakeCrossingLines()};
+
+    // Two itineraries from 0 to 3: through station 5 (4 minutes) or staying
+    // on line0 (7 minutes).
+    auto suggestions {nw.GetTravelSuggestions("station_000", "station_003", 5)};
+    BOOST_REQUIRE_EQUAL(suggestions.size(), 2);
+    BOOST_CHECK_EQUAL(suggestions[0].stations.size(), 5);
+    BOOST_CHECK_EQUAL(suggestions[0].stations[3], "station_005");
+    BOOST_CHECK_EQUAL(suggestions[0].totalTime, 4);
+    BOOST_CHECK_EQUAL(suggestions[0].crowdingCost, 0);
+    BOOST_CHECK_EQUAL(suggestions[1].stations.size(), 4);
+    BOOST_CHECK_EQUAL(suggestions[1].totalTime, 7);
+
+    // Crowding at station 5 swaps the two suggestions.
+    using EventType = PassengerEvent::Type;
+    for (size_t idx {0}; idx < 20; ++idx) {
+        BOOST_REQUIRE(nw.RecordPassengerEvent({"station_005", EventType::In}));
+    }
+    nw.SetCrowdingCost(0.5);
+    BOOST_CHECK_EQUAL(nw.GetCrowdingCost(), 0.5);
+    suggestions = nw.GetTravelSuggestions("station_000", "station_003", 5);
+    BOOST_REQUIRE_EQUAL(suggestions.size(), 2);
+    BOOST_CHECK_EQUAL(suggestions[0].totalTime, 7);
+    BOOST_CHECK_EQUAL(suggestions[0].crowdingCost, 0);
+    BOOST_CHECK_EQUAL(suggestions[1].totalTime, 4);
+    BOOST_CHECK_EQUAL(suggestions[1].crowdingCost, 10);
+
+    // Limit the number of suggestions.
+    suggestions = nw.GetTravelSuggestions("station_000", "station_003", 1);
+    BOOST_REQUIRE_EQUAL(suggestions.size(), 1);
+    BOOST_CHECK_EQUAL(suggestions[0].totalTime, 7);
+
+    // No suggestions.
+    BOOST_CHECK(nw.GetTravelSuggestions("station_003", "station_000", 5).empty());
+    BOOST_CHECK(nw.GetTravelSuggestions("station_000", "station_000", 5).empty());
+    BOOST_CHECK(nw.GetTravelSuggestions("station_000", "station_042", 5).empty());
+}
+
+BOOST_AUTO_TEST_CASE(travel_suggestions_blocked_prefix)
+{
+    // Two itineraries from A to B: A-Z-B (2 minutes) and A-D-Y-X-Z-B
+    // (13 minutes). Two faster partial itineraries reach the edge Y-X through
+    // Z, and cannot go on without visiting Z again: they must not hide the
+    // second itinerary.
+    TransportNetwork nw {};
+    bool ok {true};
+    for (const auto& id: {"a", "b", "d", "q", "x", "y", "z"}) {
+        ok &= nw.AddStation({std::string("station_") + id, "Station Name"});
+    }
+    std::vector<Route> routes {};
+    for (const auto& stops: std::vector<std::vector<Id>> {
+        {"station_a", "station_z", "station_b"},
+        {"station_z", "station_y", "station_x"},
+        {"station_x", "station_z"},
+        {"station_z", "station_q", "station_y"},
+        {"station_a", "station_d", "station_y"},
+    }) {
+        const auto id {"route_00" + std::to_string(routes.size())};
+        routes.push_back({
+            id,
+            "Route Name",
+            "line_000",
+            stops.front(),
+            stops.back(),
+            stops
+        });
+    }
+    ok &= nw.AddLine({"line_000", "Line Name", routes});
+    for (const auto& [from, to]: std::vector<std::pair<Id, Id>> {
+        {"station_a", "station_z"},
+        {"station_z", "station_b"},
+        {"station_z", "station_y"},
+        {"station_y", "station_x"},
+        {"station_x", "station_z"},
+        {"station_z", "station_q"},
+        {"station_q", "station_y"},
+    }) {
+        ok &= nw.SetTravelTime(from, to, 1);
+    }
+    ok &= nw.SetTravelTime("station_a", "station_d", 5);
+    ok &= nw.SetTravelTime("station_d", "station_y", 5);
+    BOOST_REQUIRE(ok);
+
+    const auto suggestions {nw.GetTravelSuggestions("station_a", "station_b", 2)};
+    BOOST_REQUIRE_EQUAL(suggestions.size(), 2);
+    BOOST_CHECK_EQUAL(suggestions[0].totalTime, 2);
+    BOOST_CHECK_EQUAL(suggestions[1].totalTime, 13);
+    const std::vector<Id> expectedStations {
+        "station_a", "station_d", "station_y", "station_x", "station_z", "station_b"
+    };
+    BOOST_CHECK(suggestions[1].stations == expectedStations);
+
+    // There are no other itineraries.
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelSuggestions("station_a", "station_b", 16).size(),
+        2
+    );
+}
+
+BOOST_AUTO_TEST_CASE(travel_suggestions_handles)
+{
+    auto testFilePath {
+        std::filesystem::path(TESTS_JSON_FOLDER) / "network-layout.json"
+    };
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(testFilePath))};
+    BOOST_REQUIRE(ok);
+    nw.SetLineChangePenalty(5);
+
+    auto stationA {nw.GetStationHandle("station_000")};
+    auto stationB {nw.GetStationHandle("station_150")};
+    std::vector<ItineraryHandles> suggestions {};
+    auto nSuggestions {nw.GetTravelSuggestions(stationA, stationB, 4, suggestions)};
+    BOOST_REQUIRE_EQUAL(nSuggestions, 4);
+    BOOST_REQUIRE_GE(suggestions.size(), 4);
+
+    // The best suggestion is the fastest itinerary, and they are sorted.
+    ItineraryHandles fastest {};
+    BOOST_REQUIRE(nw.GetFastestPath(stationA, stationB, fastest));
+    BOOST_CHECK_EQUAL(suggestions[0].totalTime, fastest.totalTime);
+    for (size_t idx {1}; idx < nSuggestions; ++idx) {
+        BOOST_CHECK_LE(suggestions[idx - 1].totalTime, suggestions[idx].totalTime);
+    }
+
+    // No itinerary visits a station twice.
+    for (size_t idx {0}; idx < nSuggestions; ++idx) {
+        auto stations {suggestions[idx].stations};
+        std::sort(stations.begin(), stations.end(), [](auto a, auto b) {
+            return a.index < b.index;
+        });
+        BOOST_CHECK(std::adjacent_find(stations.begin(), stations.end())
+            == stations.end());
+        BOOST_CHECK(suggestions[idx].stations.front() == stationA);
+        BOOST_CHECK(suggestions[idx].stations.back() == stationB);
+    }
+
+    // The output vector is reused.
+    nSuggestions = nw.GetTravelSuggestions(stationA, stationB, 2, suggestions);
+    BOOST_CHECK_EQUAL(nSuggestions, 2);
+    BOOST_CHECK_GE(suggestions.size(), 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // FastestPath
+
+BOOST_AUTO_TEST_SUITE(Closures);
+
+using FastestPath::MakeCrossingLines;
+
+BOOST_AUTO_TEST_CASE(route)
+{
+    auto nw {MakeCrossingLines()};
+    const auto route1 {nw.GetRouteHandle("line_001", "route_001")};
+    BOOST_REQUIRE_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 4);
+
+    BOOST_CHECK(nw.DisableRoute(route1));
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 7);
+    auto itinerary {nw.GetFastestPath("station_000", "station_003")};
+    std::vector<Id> expectedRoutes {"route_000", "route_000", "route_000"};
+    BOOST_CHECK(itinerary.routes == expectedRoutes);
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_001", "route_001", "station_004", "station_003"),
+        0
+    );
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_002", "station_005"), 0);
+    BOOST_CHECK_EQUAL(
+        nw.GetFastestTravelTime("station_004", "station_003"),
+        TransportNetwork::kUnreachable
+    );
+
+    // The layout is unchanged.
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_005").size(), 1);
+
+    BOOST_CHECK(nw.EnableRoute(route1));
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 4);
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_001", "route_001", "station_004", "station_003"),
+        3
+    );
+
+    BOOST_CHECK(!nw.DisableRoute({}));
+    BOOST_CHECK(!nw.EnableRoute({}));
+}
+
+BOOST_AUTO_TEST_CASE(station)
+{
+    auto nw {MakeCrossingLines()};
+    const auto station2 {nw.GetStationHandle("station_002")};
+    const auto station5 {nw.GetStationHandle("station_005")};
+
+    // Itineraries can neither go through nor stop at the station.
+    BOOST_CHECK(nw.DisableStation(station5));
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 7);
+    BOOST_CHECK_EQUAL(
+        nw.GetFastestTravelTime("station_000", "station_005"),
+        TransportNetwork::kUnreachable
+    );
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_005", "station_003"), 0);
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_001", "route_001", "station_004", "station_002"),
+        1
+    );
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_001", "route_001", "station_004", "station_003"),
+        0
+    );
+
+    BOOST_CHECK(nw.DisableStation(station2));
+    BOOST_CHECK_EQUAL(
+        nw.GetFastestTravelTime("station_000", "station_003"),
+        TransportNetwork::kUnreachable
+    );
+    std::vector<ItineraryHandles> suggestions {};
+    BOOST_CHECK_EQUAL(nw.GetTravelSuggestions(
+        nw.GetStationHandle("station_000"),
+        nw.GetStationHandle("station_003"),
+        4,
+        suggestions
+    ), 0);
+
+    BOOST_CHECK(nw.EnableStation(station2));
+    BOOST_CHECK(nw.EnableStation(station5));
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 4);
+
+    // Routes added later do not serve a station that is out of service.
+    BOOST_CHECK(nw.DisableStation(station5));
+    BOOST_REQUIRE(nw.AddLine({"line_002", "Line Name 2", {{
+        "route_002",
+        "Route Name 2",
+        "line_002",
+        "station_000",
+        "station_003",
+        {"station_000", "station_005", "station_003"},
+    }}}));
+    BOOST_REQUIRE(nw.SetTravelTime("station_000", "station_005", 1));
+    BOOST_REQUIRE(nw.SetTravelTime("station_005", "station_003", 1));
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 7);
+    BOOST_CHECK(nw.EnableStation(station5));
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 2);
+
+    BOOST_CHECK(!nw.DisableStation({}));
+}
+
+BOOST_AUTO_TEST_CASE(edge)
+{
+    auto nw {MakeCrossingLines()};
+    const auto station2 {nw.GetStationHandle("station_002")};
+    const auto station5 {nw.GetStationHandle("station_005")};
+
+    // Both directions are taken out of service.
+    BOOST_CHECK(nw.DisableEdge(station5, station2));
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_002", "station_005"), 0);
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 7);
+    BOOST_CHECK_EQUAL(
+        nw.GetFastestTravelTime("station_004", "station_005"),
+        TransportNetwork::kUnreachable
+    );
+
+    // Travel times can still be changed while the edge is out of service.
+    BOOST_CHECK(nw.SetTravelTime("station_002", "station_005", 2));
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_002", "station_005"), 0);
+
+    // The edge stays closed while one of its stations is out of service.
+    BOOST_CHECK(nw.DisableStation(station5));
+    BOOST_CHECK(nw.EnableEdge(station2, station5));
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 7);
+    BOOST_CHECK(nw.EnableStation(station5));
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_002", "station_005"), 2);
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 5);
+
+    BOOST_CHECK(!nw.DisableEdge(nw.GetStationHandle("station_000"), station5));
+    BOOST_CHECK(!nw.EnableEdge(station2, {}));
+}
+
+BOOST_AUTO_TEST_CASE(caches)
+{
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+    auto cached {nw};
+    cached.BuildContractionHierarchy();
+    cached.BuildTravelTimeMatrix();
+
+    // The hierarchy and the matrix follow the closures, without being rebuilt.
+    const auto nStations {nw.GetStationCount()};
+    auto check {[&]() {
+        BOOST_REQUIRE(cached.HasContractionHierarchy());
+        BOOST_REQUIRE(cached.HasTravelTimeMatrix());
+        for (uint32_t idxA {0}; idxA < nStations; idxA += 13) {
+            for (uint32_t idxB {0}; idxB < nStations; idxB += 7) {
+                const StationHandle stationA {idxA};
+                const StationHandle stationB {idxB};
+                const auto expected {nw.GetFastestTravelTime(stationA, stationB)};
+                BOOST_CHECK_EQUAL(
+                    cached.GetFastestTravelTime(stationA, stationB),
+                    expected
+                );
+                BOOST_CHECK_EQUAL(cached.LookupTravelTime(stationA, stationB), expected);
+            }
+        }
+    }};
+
+    const auto route {nw.GetRouteHandle("line_000", "route_000")};
+    const StationHandle station {42};
+    const StationHandle stationA {nw.GetStationHandle("station_000")};
+    const StationHandle stationB {nw.GetStationHandle("station_001")};
+    for (auto* network: {&nw, &cached}) {
+        BOOST_REQUIRE(network->DisableRoute(route));
+        BOOST_REQUIRE(network->DisableStation(station));
+        BOOST_REQUIRE(network->DisableEdge(stationA, stationB));
+    }
+    check();
+    for (auto* network: {&nw, &cached}) {
+        BOOST_REQUIRE(network->EnableRoute(route));
+        BOOST_REQUIRE(network->EnableStation(station));
+    }
+    check();
+    for (auto* network: {&nw, &cached}) {
+        BOOST_REQUIRE(network->EnableEdge(stationA, stationB));
+    }
+    check();
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // Closures
+
+BOOST_AUTO_TEST_SUITE(FromJson);
+
+BOOST_AUTO_TEST_CASE(from_json_1line_1route)
+{
+    auto testFilePath {
+        std::filesystem::path(TESTS_JSON_FOLDER) / "from_json_1line_1route.json"
+    };
+    auto src = ParseJsonFile(testFilePath);
+
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(std::move(src))};
+    BOOST_REQUIRE(ok);
+
+    auto routes {nw.GetRoutesServingStation("station_0")};
+    BOOST_REQUIRE_EQUAL(routes.size(), 1);
+    BOOST_CHECK_EQUAL(routes[0], "route_0");
+
+	auto travelTime {nw.GetTravelTime(
+		"line_0",
+		"route_0",
+		"station_0",
+		"station_1"
+		)
+	};
+	BOOST_REQUIRE_EQUAL(travelTime, 5);
+	BOOST_REQUIRE_EQUAL(nw.GetTravelTime("station_0", "station_1"), 5);
+	BOOST_REQUIRE_EQUAL(nw.GetTravelTime("station_1", "station_0"), 5);
+}
+
+BOOST_AUTO_TEST_CASE(from_json_not_connected_stations)
+{
+    auto testFilePath {
+        std::filesystem::path(TESTS_JSON_FOLDER) / "from_json_not_connected_stations.json"
+    };
+    auto src = ParseJsonFile(testFilePath);
 
     TransportNetwork nw {};
 	auto ok {nw.FromJson(std::move(src))};
@@ -613,8 +1784,1081 @@ BOOST_AUTO_TEST_CASE(from_json_network_layout)
 	BOOST_REQUIRE_EQUAL(travelTime, 6);
 }
 
+BOOST_AUTO_TEST_CASE(from_json_stream_network_layout)
+{
+    TransportNetwork expected {};
+    auto ok {expected.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+
+    TransportNetwork nw {};
+    ok = nw.FromJsonFile(TESTS_NETWORK_LAYOUT_JSON);
+    BOOST_REQUIRE(ok);
+
+    BOOST_REQUIRE_EQUAL(nw.GetStationCount(), expected.GetStationCount());
+    const auto nStations {static_cast<uint32_t>(nw.GetStationCount())};
+    for (uint32_t idx {0}; idx < nStations; ++idx) {
+        const std::string id {expected.GetStationId(StationHandle {idx})};
+        const std::string next {
+            expected.GetStationId(StationHandle {(idx + 1) % nStations})
+        };
+        BOOST_CHECK(nw.GetRoutesServingStation(id)
+            == expected.GetRoutesServingStation(id));
+        BOOST_CHECK_EQUAL(
+            nw.GetTravelTime(id, next),
+            expected.GetTravelTime(id, next)
+        );
+    }
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_000", "route_000", "station_000", "station_002"),
+        expected.GetTravelTime("line_000", "route_000", "station_000", "station_002")
+    );
+}
+
+BOOST_AUTO_TEST_CASE(from_json_stream_files)
+{
+    TransportNetwork nw {};
+    auto ok {nw.FromJsonFile(
+        std::filesystem::path(TESTS_JSON_FOLDER) / "from_json_1line_1route.json"
+    )};
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_0", "station_1"), 5);
+
+    TransportNetwork badTravelTimes {};
+    ok = badTravelTimes.FromJsonFile(
+        std::filesystem::path(TESTS_JSON_FOLDER) / "from_json_bad_travel_times.json"
+    );
+    BOOST_CHECK(!ok);
+
+    TransportNetwork missing {};
+    BOOST_CHECK_THROW(
+        missing.FromJsonFile(std::filesystem::path(TESTS_JSON_FOLDER) / "missing.json"),
+        std::runtime_error
+    );
+}
+
+BOOST_AUTO_TEST_CASE(from_json_stream_section_order)
+{
+    // Travel times first, stations last.
+    std::istringstream src {R"({
+        "travel_times": [
+            {"start_station_id": "station_0", "end_station_id": "station_1",
+             "travel_time": 5, "line_id": "line_0", "route_id": "route_0"}
+        ],
+        "lines": [
+            {"line_id": "line_0", "name": "Line 0", "extra": {"a": [1, 2]},
+             "routes": [
+                {"route_id": "route_0", "direction": "inbound",
+                 "line_id": "line_0", "start_station_id": "station_0",
+                 "end_station_id": "station_1",
+                 "route_stops": ["station_0", "station_1"]}
+             ]}
+        ],
+        "stations": [
+            {"station_id": "station_0", "name": "Station 0"},
+            {"station_id": "station_1", "name": "Station 1"}
+        ]
+    })"};
+    TransportNetwork nw {};
+    auto ok {nw.FromJsonStream(src)};
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetStationCount(), 2);
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_0").size(), 1);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_0", "station_1"), 5);
+}
+
+BOOST_AUTO_TEST_CASE(from_json_stream_deeply_nested)
+{
+    // Unknown fields are ignored at any depth, as FromJson ignores them.
+    std::string extra {};
+    for (size_t idx {0}; idx < 64; ++idx) {
+        extra += R"({"a": [)";
+    }
+    for (size_t idx {0}; idx < 64; ++idx) {
+        extra += "]}";
+    }
+    const std::string layout {R"({
+        "extra": )" + extra + R"(,
+        "stations": [
+            {"station_id": "station_0", "name": "Station 0", "extra": )"
+                + extra + R"(},
+            {"station_id": "station_1", "name": "Station 1"}
+        ],
+        "lines": [
+            {"line_id": "line_0", "name": "Line 0",
+             "routes": [
+                {"route_id": "route_0", "direction": "inbound",
+                 "line_id": "line_0", "start_station_id": "station_0",
+                 "end_station_id": "station_1", "extra": )" + extra + R"(,
+                 "route_stops": ["station_0", "station_1"]}
+             ]}
+        ],
+        "travel_times": [
+            {"start_station_id": "station_0", "end_station_id": "station_1",
+             "travel_time": 5, "line_id": "line_0", "route_id": "route_0"}
+        ]
+    })"};
+
+    TransportNetwork fromJson {};
+    BOOST_REQUIRE(fromJson.FromJson(nlohmann::json::parse(layout)));
+
+    std::istringstream src {layout};
+    TransportNetwork nw {};
+    auto ok {nw.FromJsonStream(src)};
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetStationCount(), 2);
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_0").size(), 1);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_0", "station_1"), 5);
+}
+
+BOOST_AUTO_TEST_CASE(from_json_stream_errors)
+{
+    // Malformed document.
+    {
+        std::istringstream src {R"({"stations": [)"};
+        TransportNetwork nw {};
+        BOOST_CHECK_THROW(nw.FromJsonStream(src), std::runtime_error);
+    }
+
+    // Missing field.
+    {
+        std::istringstream src {R"({
+            "stations": [{"station_id": "station_0"}],
+            "lines": [],
+            "travel_times": []
+        })"};
+        TransportNetwork nw {};
+        BOOST_CHECK_THROW(nw.FromJsonStream(src), std::runtime_error);
+    }
+
+    // Missing section.
+    {
+        std::istringstream src {R"({"stations": [], "lines": []})"};
+        TransportNetwork nw {};
+        BOOST_CHECK_THROW(nw.FromJsonStream(src), std::runtime_error);
+    }
+
+    // Duplicate station.
+    {
+        std::istringstream src {R"({
+            "stations": [
+                {"station_id": "station_0", "name": "Station 0"},
+                {"station_id": "station_0", "name": "Station 0"}
+            ],
+            "lines": [],
+            "travel_times": []
+        })"};
+        TransportNetwork nw {};
+        BOOST_CHECK_THROW(nw.FromJsonStream(src), std::runtime_error);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END(); // FromJson
 
+BOOST_AUTO_TEST_SUITE(FromLayout);
+
+// Read the layout of a network JSON file, the same way FromJson does.
+static NetworkLayout ReadNetworkLayout(
+    const std::filesystem::path& source
+)
+{
+    auto src = ParseJsonFile(source);
+    NetworkLayout layout {};
+    for (const auto& stationJson: src.at("stations")) {
+        layout.stations.push_back({
+            stationJson.at("station_id").get<std::string>(),
+            stationJson.at("name").get<std::string>(),
+        });
+    }
+    for (const auto& lineJson: src.at("lines")) {
+        Line line {
+            lineJson.at("line_id").get<std::string>(),
+            lineJson.at("name").get<std::string>(),
+            {},
+        };
+        for (const auto& routeJson: lineJson.at("routes")) {
+            line.routes.push_back({
+                routeJson.at("route_id").get<std::string>(),
+                routeJson.at("direction").get<std::string>(),
+                routeJson.at("line_id").get<std::string>(),
+                routeJson.at("start_station_id").get<std::string>(),
+                routeJson.at("end_station_id").get<std::string>(),
+                routeJson.at("route_stops").get<std::vector<Id>>(),
+            });
+        }
+        layout.lines.push_back(std::move(line));
+    }
+    for (const auto& travelTimeJson: src.at("travel_times")) {
+        layout.travelTimes.push_back({
+            travelTimeJson.at("start_station_id").get<std::string>(),
+            travelTimeJson.at("end_station_id").get<std::string>(),
+            travelTimeJson.at("travel_time").get<uint32_t>(),
+        });
+    }
+    return layout;
+}
+
+BOOST_AUTO_TEST_CASE(network_layout)
+{
+    TransportNetwork expected {};
+    auto ok {expected.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+
+    TransportNetwork nw {};
+    nw.SetLineChangePenalty(3);
+    std::vector<std::string> errors {};
+    ok = nw.FromLayout(ReadNetworkLayout(TESTS_NETWORK_LAYOUT_JSON), errors);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(errors.empty());
+    BOOST_CHECK_EQUAL(nw.GetLineChangePenalty(), 3);
+
+    // Same network as the one built item by item.
+    BOOST_REQUIRE_EQUAL(nw.GetStationCount(), expected.GetStationCount());
+    const auto nStations {static_cast<uint32_t>(nw.GetStationCount())};
+    for (uint32_t idx {0}; idx < nStations; ++idx) {
+        const std::string id {expected.GetStationId(StationHandle {idx})};
+        const std::string next {
+            expected.GetStationId(StationHandle {(idx + 1) % nStations})
+        };
+        BOOST_CHECK_EQUAL(nw.GetStationId(StationHandle {idx}), id);
+        BOOST_CHECK(nw.GetRoutesServingStation(id)
+            == expected.GetRoutesServingStation(id));
+        BOOST_CHECK_EQUAL(
+            nw.GetTravelTime(id, next),
+            expected.GetTravelTime(id, next)
+        );
+    }
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_000", "route_000", "station_000", "station_002"),
+        expected.GetTravelTime("line_000", "route_000", "station_000", "station_002")
+    );
+    expected.SetLineChangePenalty(3);
+    ItineraryHandles itinerary {};
+    ItineraryHandles expectedItinerary {};
+    for (uint32_t idx {1}; idx < nStations; idx += 37) {
+        BOOST_REQUIRE_EQUAL(
+            nw.GetFastestPath(StationHandle {0}, StationHandle {idx}, itinerary),
+            expected.GetFastestPath(
+                StationHandle {0}, StationHandle {idx}, expectedItinerary
+            )
+        );
+        BOOST_CHECK_EQUAL(itinerary.totalTime, expectedItinerary.totalTime);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+    NetworkLayout layout {
+        {
+            {"station_0", "Station 0"},
+            {"station_1", "Station 1"},
+            {"station_0", "Station 0 again"},
+            {"station_2", "Station 2"},
+        },
+        {
+            {"line_0", "Line 0", {
+                {"route_0", "inbound", "line_0", "station_0", "station_1",
+                    {"station_0", "station_1"}},
+                {"route_1", "inbound", "line_0", "station_0", "station_9",
+                    {"station_0", "station_9", "station_8"}},
+            }},
+            {"line_1", "Line 1", {
+                {"route_0", "inbound", "line_1", "station_0", "station_1",
+                    {"station_0", "station_1"}},
+                {"route_2", "inbound", "line_1", "station_2", "station_2",
+                    {"station_2"}},
+            }},
+            {"line_0", "Line 0 again", {}},
+        },
+        {
+            {"station_0", "station_1", 1},
+            {"station_0", "station_7", 1},
+        },
+    };
+
+    // Every error is reported, in layout order.
+    TransportNetwork nw {};
+    std::vector<std::string> errors {};
+    BOOST_CHECK(!nw.FromLayout(layout, errors));
+    BOOST_REQUIRE_EQUAL(errors.size(), 7);
+    BOOST_CHECK_EQUAL(errors[0], "Station station_0: duplicate ID");
+    BOOST_CHECK_EQUAL(errors[1], "Route route_0: duplicate ID");
+    BOOST_CHECK_EQUAL(errors[2], "Line line_0: duplicate ID");
+    BOOST_CHECK_EQUAL(errors[3], "Route route_1: unknown station station_9");
+    BOOST_CHECK_EQUAL(errors[4], "Route route_1: unknown station station_8");
+    BOOST_CHECK_EQUAL(errors[5], "Route route_2: less than 2 stops");
+    BOOST_CHECK_EQUAL(
+        errors[6],
+        "Travel time station_0 - station_7: unknown station station_7"
+    );
+    BOOST_CHECK_EQUAL(nw.GetStationCount(), 0);
+
+    // Travel times between stations that are not adjacent.
+    layout.stations.erase(layout.stations.begin() + 2);
+    layout.lines.resize(1);
+    layout.lines[0].routes.resize(1);
+    layout.travelTimes = {{"station_0", "station_2", 1}};
+    BOOST_CHECK(!nw.FromLayout(layout, errors));
+    BOOST_REQUIRE_EQUAL(errors.size(), 1);
+    BOOST_CHECK_EQUAL(
+        errors[0],
+        "Travel time station_0 - station_2: stations not adjacent"
+    );
+
+    // Valid layout, but the network is not empty anymore.
+    layout.travelTimes = {{"station_0", "station_1", 4}};
+    BOOST_REQUIRE(nw.FromLayout(layout, errors));
+    BOOST_CHECK(errors.empty());
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_0", "station_1"), 4);
+    BOOST_CHECK(!nw.FromLayout(layout, errors));
+    BOOST_CHECK_EQUAL(errors.size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // FromLayout
+
+BOOST_AUTO_TEST_SUITE(Clone);
+
+BOOST_AUTO_TEST_CASE(independent)
+{
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+    nw.SetLineChangePenalty(5);
+    BOOST_REQUIRE(nw.RecordPassengerEvent({"station_000", PassengerEvent::Type::In}));
+    const auto travelTime {nw.GetTravelTime("station_000", "station_001")};
+    const auto routeTravelTime {
+        nw.GetTravelTime("line_000", "route_000", "station_000", "station_002")
+    };
+    const auto fastestTravelTime {
+        nw.GetFastestTravelTime(StationHandle {0}, StationHandle {42})
+    };
+
+    auto clone {nw.Clone()};
+    BOOST_REQUIRE_EQUAL(clone.GetStationCount(), nw.GetStationCount());
+    BOOST_CHECK_EQUAL(clone.GetLineChangePenalty(), 5);
+    BOOST_CHECK_EQUAL(clone.GetPassengerCount("station_000"), 1);
+    BOOST_CHECK_EQUAL(clone.GetTravelTime("station_000", "station_001"), travelTime);
+    BOOST_CHECK_EQUAL(
+        clone.GetFastestTravelTime(StationHandle {0}, StationHandle {42}),
+        fastestTravelTime
+    );
+
+    // Changes to the clone do not show in the original network.
+    BOOST_REQUIRE(clone.RecordPassengerEvent({"station_000", PassengerEvent::Type::In}));
+    BOOST_REQUIRE(clone.SetTravelTime("station_000", "station_001", travelTime + 10));
+    BOOST_REQUIRE(clone.AddStation({"station_new", "New Station"}));
+    BOOST_CHECK_EQUAL(clone.GetPassengerCount("station_000"), 2);
+    BOOST_CHECK_EQUAL(
+        clone.GetTravelTime("line_000", "route_000", "station_000", "station_002"),
+        routeTravelTime + 10
+    );
+
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount("station_000"), 1);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_000", "station_001"), travelTime);
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_000", "route_000", "station_000", "station_002"),
+        routeTravelTime
+    );
+    BOOST_CHECK_EQUAL(
+        nw.GetFastestTravelTime(StationHandle {0}, StationHandle {42}),
+        fastestTravelTime
+    );
+    BOOST_CHECK(!nw.GetStationHandle("station_new").IsValid());
+    BOOST_CHECK_EQUAL(clone.GetStationCount(), nw.GetStationCount() + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // Clone
+
+BOOST_AUTO_TEST_SUITE(Patch);
+
+using FastestPath::MakeCrossingLines;
+
+BOOST_AUTO_TEST_CASE(add)
+{
+    auto nw {MakeCrossingLines()};
+    const auto nStations {nw.GetStationCount()};
+    std::vector<std::string> errors {};
+    auto ok {nw.ApplyPatch(nlohmann::json::parse(R"({
+        "add": {
+            "stations": [
+                {"station_id": "station_006", "name": "Station Name"}
+            ],
+            "lines": [
+                {
+                    "line_id": "line_002",
+                    "name": "Line Name 2",
+                    "routes": [
+                        {
+                            "route_id": "route_002",
+                            "direction": "outbound",
+                            "line_id": "line_002",
+                            "start_station_id": "station_003",
+                            "end_station_id": "station_006",
+                            "route_stops": ["station_003", "station_006"]
+                        }
+                    ]
+                }
+            ],
+            "routes": [
+                {
+                    "route_id": "route_003",
+                    "direction": "inbound",
+                    "line_id": "line_001",
+                    "start_station_id": "station_006",
+                    "end_station_id": "station_000",
+                    "route_stops": ["station_006", "station_000"]
+                }
+            ]
+        },
+        "travel_times": [
+            {
+                "start_station_id": "station_003",
+                "end_station_id": "station_006",
+                "travel_time": 2
+            },
+            {
+                "start_station_id": "station_006",
+                "end_station_id": "station_000",
+                "travel_time": 3
+            }
+        ]
+    })"), errors)};
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(errors.empty());
+    BOOST_CHECK_EQUAL(nw.GetStationCount(), nStations + 1);
+    BOOST_CHECK(nw.GetRouteHandle("line_002", "route_002").IsValid());
+    BOOST_CHECK(nw.GetRouteHandle("line_001", "route_003").IsValid());
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_003", "station_006"), 2);
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_001", "route_003", "station_006", "station_000"),
+        3
+    );
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_006"), 6);
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_003", "station_001"), 6);
+
+    // An empty patch is valid.
+    BOOST_CHECK(nw.ApplyPatch(nlohmann::json::object(), errors));
+    BOOST_CHECK_EQUAL(nw.GetStationCount(), nStations + 1);
+}
+
+BOOST_AUTO_TEST_CASE(remove_route)
+{
+    auto nw {MakeCrossingLines()};
+    const auto route1 {nw.GetRouteHandle("line_001", "route_001")};
+    std::vector<std::string> errors {};
+    auto ok {nw.ApplyPatch(nlohmann::json::parse(R"({
+        "remove": {"routes": ["route_001"]}
+    })"), errors)};
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(!nw.GetRouteHandle("line_001", "route_001").IsValid());
+    BOOST_CHECK(nw.GetRouteId(route1).empty());
+    BOOST_CHECK(nw.GetLineHandle("line_001").IsValid());
+    BOOST_CHECK(nw.GetRoutesServingStation("station_005").empty());
+    BOOST_CHECK_EQUAL(nw.GetRoutesServingStation("station_002").size(), 1);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_002", "station_005"), 0);
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 7);
+    BOOST_CHECK(!nw.DisableRoute(route1));
+
+    // The route is gone for good.
+    ok = nw.ApplyPatch(nlohmann::json::parse(R"({
+        "remove": {"routes": ["route_001"]}
+    })"), errors);
+    BOOST_CHECK(!ok);
+    BOOST_CHECK(errors == std::vector<std::string> {
+        "Route route_001: unknown ID"
+    });
+}
+
+BOOST_AUTO_TEST_CASE(modify_route)
+{
+    auto nw {MakeCrossingLines()};
+    const auto route1 {nw.GetRouteHandle("line_001", "route_001")};
+    nw.DisableRoute(route1);
+
+    // The route now skips station 5. Its edges are new, so their travel times
+    // are set again.
+    std::vector<std::string> errors {};
+    auto ok {nw.ApplyPatch(nlohmann::json::parse(R"({
+        "remove": {"routes": ["route_001"]},
+        "add": {
+            "routes": [
+                {
+                    "route_id": "route_001",
+                    "direction": "outbound",
+                    "line_id": "line_001",
+                    "start_station_id": "station_004",
+                    "end_station_id": "station_003",
+                    "route_stops": ["station_004", "station_002", "station_003"]
+                }
+            ]
+        },
+        "travel_times": [
+            {
+                "start_station_id": "station_004",
+                "end_station_id": "station_002",
+                "travel_time": 1
+            },
+            {
+                "start_station_id": "station_002",
+                "end_station_id": "station_003",
+                "travel_time": 4
+            }
+        ]
+    })"), errors)};
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(nw.GetRouteHandle("line_001", "route_001") == route1);
+    BOOST_CHECK_EQUAL(nw.GetRouteId(route1), "route_001");
+    BOOST_CHECK(nw.GetRoutesServingStation("station_005").empty());
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_001", "route_001", "station_004", "station_003"),
+        5
+    );
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_000", "route_000", "station_000", "station_003"),
+        6
+    );
+
+    // The route comes back in service.
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_004", "station_003"), 5);
+}
+
+BOOST_AUTO_TEST_CASE(station)
+{
+    auto nw {MakeCrossingLines()};
+    const auto station5 {nw.GetStationHandle("station_005")};
+    const auto nStations {nw.GetStationCount()};
+    std::vector<std::string> errors {};
+
+    // The station is still served.
+    auto ok {nw.ApplyPatch(nlohmann::json::parse(R"({
+        "remove": {"stations": ["station_005"]}
+    })"), errors)};
+    BOOST_CHECK(!ok);
+    BOOST_CHECK(errors == std::vector<std::string> {
+        "Station station_005: served by route route_001"
+    });
+    BOOST_CHECK(nw.GetStationHandle("station_005") == station5);
+
+    BOOST_REQUIRE(nw.RecordPassengerEvent({"station_005", PassengerEvent::Type::In}));
+    ok = nw.ApplyPatch(nlohmann::json::parse(R"({
+        "remove": {"stations": ["station_005"], "routes": ["route_001"]}
+    })"), errors);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(!nw.GetStationHandle("station_005").IsValid());
+    BOOST_CHECK(nw.GetStationId(station5).empty());
+    BOOST_CHECK(!nw.DisableStation(station5));
+    BOOST_CHECK_EQUAL(nw.GetStationCount(), nStations);
+
+    // The handle of the removed station is stale.
+    BOOST_CHECK(!nw.RecordPassengerEvent(station5, PassengerEvent::Type::In));
+    BOOST_CHECK_THROW(nw.GetPassengerCount(station5), std::runtime_error);
+    BOOST_CHECK(nw.GetRoutesServingStation(station5).empty());
+
+    // Adding the station again brings back its handle.
+    ok = nw.ApplyPatch(nlohmann::json::parse(R"({
+        "add": {
+            "stations": [
+                {"station_id": "station_005", "name": "New Name"}
+            ],
+            "routes": [
+                {
+                    "route_id": "route_002",
+                    "direction": "outbound",
+                    "line_id": "line_001",
+                    "start_station_id": "station_003",
+                    "end_station_id": "station_005",
+                    "route_stops": ["station_003", "station_005"]
+                }
+            ]
+        },
+        "travel_times": [
+            {
+                "start_station_id": "station_003",
+                "end_station_id": "station_005",
+                "travel_time": 3
+            }
+        ]
+    })"), errors);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(nw.GetStationHandle("station_005") == station5);
+    BOOST_CHECK_EQUAL(nw.GetStationCount(), nStations);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount("station_005"), 0);
+    BOOST_CHECK_EQUAL(nw.GetPassengerCount(station5), 0);
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_005"), 10);
+}
+
+BOOST_AUTO_TEST_CASE(remove_line)
+{
+    auto nw {MakeCrossingLines()};
+    std::vector<std::string> errors {};
+    auto ok {nw.ApplyPatch(nlohmann::json::parse(R"({
+        "remove": {"lines": ["line_000"], "stations": ["station_000"]}
+    })"), errors)};
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(!nw.GetLineHandle("line_000").IsValid());
+    BOOST_CHECK(!nw.GetRouteHandle("line_000", "route_000").IsValid());
+    BOOST_CHECK(!nw.GetStationHandle("station_000").IsValid());
+    BOOST_CHECK(nw.GetRoutesServingStation("station_001").empty());
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_004", "station_003"), 3);
+    BOOST_CHECK_EQUAL(
+        nw.GetFastestTravelTime("station_001", "station_003"),
+        TransportNetwork::kUnreachable
+    );
+
+    // Routes cannot be added to a removed line.
+    ok = nw.ApplyPatch(nlohmann::json::parse(R"({
+        "add": {
+            "routes": [
+                {
+                    "route_id": "route_002",
+                    "direction": "outbound",
+                    "line_id": "line_000",
+                    "start_station_id": "station_001",
+                    "end_station_id": "station_002",
+                    "route_stops": ["station_001", "station_002"]
+                }
+            ]
+        },
+        "travel_times": [
+            {
+                "start_station_id": "station_001",
+                "end_station_id": "station_002",
+                "travel_time": 1
+            }
+        ]
+    })"), errors);
+    BOOST_CHECK(!ok);
+    BOOST_CHECK(errors == std::vector<std::string> {
+        "Route route_002: unknown line line_000"
+    });
+}
+
+BOOST_AUTO_TEST_CASE(modify_route_travel_times)
+{
+    // The route is shortened by removing it and adding it again, without
+    // repeating the travel times of the stops it keeps.
+    auto nw {MakeCrossingLines()};
+    std::vector<std::string> errors {};
+    auto ok {nw.ApplyPatch(nlohmann::json::parse(R"({
+        "remove": {"routes": ["route_000"]},
+        "add": {
+            "routes": [
+                {
+                    "route_id": "route_000",
+                    "direction": "outbound",
+                    "line_id": "line_000",
+                    "start_station_id": "station_000",
+                    "end_station_id": "station_002",
+                    "route_stops": ["station_000", "station_001", "station_002"]
+                }
+            ]
+        }
+    })"), errors)};
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_000", "station_001"), 1);
+    BOOST_CHECK_EQUAL(nw.GetTravelTime("station_001", "station_002"), 1);
+    BOOST_CHECK_EQUAL(
+        nw.GetTravelTime("line_000", "route_000", "station_000", "station_002"),
+        2
+    );
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_002"), 2);
+
+    // A route between stations that are not adjacent yet needs a travel time.
+    ok = nw.ApplyPatch(nlohmann::json::parse(R"({
+        "add": {
+            "routes": [
+                {
+                    "route_id": "route_002",
+                    "direction": "outbound",
+                    "line_id": "line_000",
+                    "start_station_id": "station_000",
+                    "end_station_id": "station_004",
+                    "route_stops": ["station_000", "station_004"]
+                }
+            ]
+        }
+    })"), errors);
+    BOOST_CHECK(!ok);
+    BOOST_CHECK(errors == std::vector<std::string> {
+        "Travel time station_000 - station_004: missing"
+    });
+    BOOST_CHECK(!nw.GetRouteHandle("line_000", "route_002").IsValid());
+}
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+    auto nw {MakeCrossingLines()};
+    const auto copy {nw};
+    std::vector<std::string> errors {};
+    auto ok {nw.ApplyPatch(nlohmann::json::parse(R"({
+        "remove": {
+            "stations": ["station_042"],
+            "lines": ["line_042"],
+            "routes": ["route_000"]
+        },
+        "add": {
+            "stations": [
+                {"station_id": "station_001", "name": "Station Name"},
+                {"station_id": "station_006", "name": "Station Name"},
+                {"station_id": "station_006", "name": "Station Name"}
+            ],
+            "lines": [
+                {"line_id": "line_001", "name": "Line Name", "routes": []}
+            ],
+            "routes": [
+                {
+                    "route_id": "route_001",
+                    "direction": "outbound",
+                    "line_id": "line_001",
+                    "start_station_id": "station_000",
+                    "end_station_id": "station_000",
+                    "route_stops": ["station_042"]
+                }
+            ]
+        },
+        "travel_times": [
+            {
+                "start_station_id": "station_000",
+                "end_station_id": "station_001",
+                "travel_time": 1
+            },
+            {
+                "start_station_id": "station_000",
+                "end_station_id": "station_043",
+                "travel_time": 1
+            }
+        ]
+    })"), errors)};
+    BOOST_CHECK(!ok);
+    const std::vector<std::string> expected {
+        "Line line_042: unknown ID",
+        "Station station_042: unknown ID",
+        "Station station_001: duplicate ID",
+        "Station station_006: duplicate ID",
+        "Line line_001: duplicate ID",
+        "Route route_001: duplicate ID",
+        "Route route_001: less than 2 stops",
+        "Route route_001: unknown station station_042",
+        "Travel time station_000 - station_001: stations not adjacent",
+        "Travel time station_000 - station_043: unknown station station_043",
+    };
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        errors.begin(), errors.end(),
+        expected.begin(), expected.end()
+    );
+
+    // Nothing changed.
+    BOOST_CHECK(nw.GetRouteHandle("line_000", "route_000").IsValid());
+    BOOST_CHECK(!nw.GetStationHandle("station_006").IsValid());
+    BOOST_CHECK_EQUAL(nw.GetFastestTravelTime("station_000", "station_003"), 4);
+
+    // Malformed items throw.
+    BOOST_CHECK_THROW(
+        nw.ApplyPatch(nlohmann::json::parse(R"({
+            "add": {"stations": [{"station_id": "station_006"}]}
+        })"), errors),
+        nlohmann::json::exception
+    );
+    BOOST_CHECK(!nw.GetStationHandle("station_006").IsValid());
+}
+
+BOOST_AUTO_TEST_CASE(caches)
+{
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+    auto cached {nw};
+    cached.BuildContractionHierarchy();
+    cached.BuildTravelTimeMatrix();
+
+    // Same checks as for the closures. The hierarchy is only checked while it
+    // is kept.
+    const auto nStations {nw.GetStationCount()};
+    auto check {[&]() {
+        BOOST_REQUIRE(cached.HasTravelTimeMatrix());
+        for (uint32_t idxA {0}; idxA < nStations; idxA += 13) {
+            for (uint32_t idxB {0}; idxB < nStations; idxB += 7) {
+                const StationHandle stationA {idxA};
+                const StationHandle stationB {idxB};
+                // The handles of removed stations are not valid for lookups.
+                if (nw.GetStationId(stationA).empty()
+                    || nw.GetStationId(stationB).empty()) {
+                    continue;
+                }
+                const auto expected {nw.GetFastestTravelTime(stationA, stationB)};
+                if (cached.HasContractionHierarchy()) {
+                    BOOST_CHECK_EQUAL(
+                        cached.GetFastestTravelTime(stationA, stationB),
+                        expected
+                    );
+                }
+                BOOST_CHECK_EQUAL(cached.LookupTravelTime(stationA, stationB), expected);
+            }
+        }
+    }};
+    std::vector<std::string> errors {};
+    auto apply {[&](const char* patch) {
+        BOOST_REQUIRE(nw.ApplyPatch(nlohmann::json::parse(patch), errors));
+        BOOST_REQUIRE(cached.ApplyPatch(nlohmann::json::parse(patch), errors));
+    }};
+
+    // A shorter route and a slower edge.
+    apply(R"({
+        "remove": {"routes": ["route_000"]},
+        "add": {
+            "routes": [
+                {
+                    "route_id": "route_000",
+                    "direction": "outbound",
+                    "line_id": "line_000",
+                    "start_station_id": "station_000",
+                    "end_station_id": "station_003",
+                    "route_stops": [
+                        "station_000", "station_001", "station_002", "station_003"
+                    ]
+                }
+            ]
+        },
+        "travel_times": [
+            {
+                "start_station_id": "station_000",
+                "end_station_id": "station_001",
+                "travel_time": 20
+            },
+            {
+                "start_station_id": "station_001",
+                "end_station_id": "station_002",
+                "travel_time": 2
+            },
+            {
+                "start_station_id": "station_002",
+                "end_station_id": "station_003",
+                "travel_time": 2
+            }
+        ]
+    })");
+    BOOST_CHECK(cached.HasContractionHierarchy());
+    check();
+
+    // A removed line and station.
+    apply(R"({
+        "remove": {"lines": ["line_000"], "stations": ["station_000"]}
+    })");
+    BOOST_CHECK(cached.HasContractionHierarchy());
+    check();
+
+    // A shortcut between stations that were not adjacent: only the matrix is
+    // kept.
+    apply(R"({
+        "add": {
+            "routes": [
+                {
+                    "route_id": "route_shortcut",
+                    "direction": "outbound",
+                    "line_id": "line_001",
+                    "start_station_id": "station_001",
+                    "end_station_id": "station_100",
+                    "route_stops": ["station_001", "station_100"]
+                }
+            ]
+        },
+        "travel_times": [
+            {
+                "start_station_id": "station_001",
+                "end_station_id": "station_100",
+                "travel_time": 1
+            }
+        ]
+    })");
+    BOOST_CHECK(!cached.HasContractionHierarchy());
+    check();
+
+    // New stations change the size of the caches.
+    apply(R"({
+        "add": {"stations": [{"station_id": "station_new", "name": "New"}]}
+    })");
+    BOOST_CHECK(!cached.HasTravelTimeMatrix());
+}
+
+BOOST_AUTO_TEST_CASE(snapshot)
+{
+    auto nw {MakeCrossingLines()};
+    std::vector<std::string> errors {};
+    auto ok {nw.ApplyPatch(nlohmann::json::parse(R"({
+        "remove": {"routes": ["route_000"], "stations": ["station_000"]},
+        "add": {
+            "routes": [
+                {
+                    "route_id": "route_002",
+                    "direction": "outbound",
+                    "line_id": "line_000",
+                    "start_station_id": "station_001",
+                    "end_station_id": "station_003",
+                    "route_stops": ["station_001", "station_002", "station_003"]
+                }
+            ]
+        },
+        "travel_times": [
+            {
+                "start_station_id": "station_001",
+                "end_station_id": "station_002",
+                "travel_time": 2
+            },
+            {
+                "start_station_id": "station_002",
+                "end_station_id": "station_003",
+                "travel_time": 5
+            }
+        ]
+    })"), errors)};
+    BOOST_REQUIRE(ok);
+    auto snapshotPath {
+        std::filesystem::temp_directory_path() / "network-monitor-patch.bin"
+    };
+    BOOST_REQUIRE(nw.SaveSnapshot(snapshotPath));
+    TransportNetwork loaded {};
+    BOOST_REQUIRE(loaded.LoadSnapshot(snapshotPath));
+    std::filesystem::remove(snapshotPath);
+
+    BOOST_CHECK_EQUAL(loaded.GetStationCount(), nw.GetStationCount());
+    BOOST_CHECK(!loaded.GetStationHandle("station_000").IsValid());
+    BOOST_CHECK(!loaded.GetRouteHandle("line_000", "route_000").IsValid());
+    BOOST_CHECK(loaded.GetRouteHandle("line_000", "route_002")
+        == nw.GetRouteHandle("line_000", "route_002"));
+    BOOST_CHECK_EQUAL(
+        loaded.GetTravelTime("line_000", "route_002", "station_001", "station_003"),
+        7
+    );
+    BOOST_CHECK_EQUAL(loaded.GetFastestTravelTime("station_004", "station_003"), 3);
+
+    // The removed station can come back after loading.
+    ok = loaded.ApplyPatch(nlohmann::json::parse(R"({
+        "add": {"stations": [{"station_id": "station_000", "name": "Name"}]}
+    })"), errors);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(loaded.GetStationHandle("station_000") == StationHandle {0});
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // Patch
+
+BOOST_AUTO_TEST_SUITE(Snapshot);
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+    auto snapshotPath {
+        std::filesystem::temp_directory_path() / "network-monitor-snapshot.bin"
+    };
+    BOOST_REQUIRE(nw.SaveSnapshot(snapshotPath));
+
+    TransportNetwork loaded {};
+    BOOST_REQUIRE(loaded.AddStation({"station_old", "Old Station"}));
+    loaded.SetLineChangePenalty(5);
+    loaded.SetCrowdingCost(0.5);
+    BOOST_REQUIRE(loaded.EnablePassengerFlows(std::chrono::minutes {1}, 60));
+    BOOST_REQUIRE(loaded.LoadSnapshot(snapshotPath));
+    std::filesystem::remove(snapshotPath);
+    BOOST_CHECK(!loaded.GetStationHandle("station_old").IsValid());
+
+    // The settings of the network are kept.
+    BOOST_CHECK_EQUAL(loaded.GetLineChangePenalty(), 5);
+    BOOST_CHECK_EQUAL(loaded.GetCrowdingCost(), 0.5);
+    BOOST_REQUIRE(loaded.HasPassengerFlows());
+
+    // Same stations, routes and travel times.
+    BOOST_REQUIRE_EQUAL(loaded.GetStationCount(), nw.GetStationCount());
+    for (uint32_t idx {0}; idx < nw.GetStationCount(); ++idx) {
+        const std::string id {nw.GetStationId(StationHandle {idx})};
+        BOOST_REQUIRE(loaded.GetStationHandle(id) == StationHandle {idx});
+        BOOST_CHECK(loaded.GetRoutesServingStation(id)
+            == nw.GetRoutesServingStation(id));
+        BOOST_CHECK_EQUAL(loaded.GetPassengerCount(id), 0);
+    }
+    BOOST_CHECK_EQUAL(
+        loaded.GetTravelTime("line_000", "route_000", "station_000", "station_002"),
+        nw.GetTravelTime("line_000", "route_000", "station_000", "station_002")
+    );
+    for (uint32_t idx {1}; idx < nw.GetStationCount(); idx += 37) {
+        BOOST_CHECK_EQUAL(
+            loaded.GetFastestTravelTime(StationHandle {0}, StationHandle {idx}),
+            nw.GetFastestTravelTime(StationHandle {0}, StationHandle {idx})
+        );
+    }
+
+    // The loaded network can still be modified.
+    BOOST_REQUIRE(loaded.AddStation({"station_new", "New Station"}));
+    BOOST_CHECK(loaded.GetStationHandle("station_new").IsValid());
+    BOOST_CHECK(loaded.SetTravelTime("station_000", "station_001", 42));
+    BOOST_CHECK_EQUAL(loaded.GetTravelTime("station_000", "station_001"), 42);
+
+    // Flows are recorded for the loaded stations.
+    const auto station {loaded.GetStationHandle("station_000")};
+    const std::chrono::system_clock::time_point t0 {std::chrono::hours {1}};
+    BOOST_REQUIRE(loaded.RecordPassengerEvent(
+        station,
+        PassengerEvent::Type::In,
+        t0
+    ));
+    BOOST_CHECK_EQUAL(
+        loaded.GetPassengerFlow(station, t0, t0 + std::chrono::minutes {1}).in,
+        1
+    );
+}
+
+BOOST_AUTO_TEST_CASE(invalid_file)
+{
+    TransportNetwork nw {};
+    auto ok {nw.FromJson(ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+    auto snapshotPath {
+        std::filesystem::temp_directory_path() / "network-monitor-snapshot.bin"
+    };
+    BOOST_REQUIRE(nw.SaveSnapshot(snapshotPath));
+    std::string content {};
+    {
+        std::ifstream file {snapshotPath, std::ios::binary};
+        content.assign(std::istreambuf_iterator<char> {file}, {});
+    }
+    auto writeFile {[&snapshotPath](const std::string& data) {
+        std::ofstream file {snapshotPath, std::ios::binary | std::ios::trunc};
+        file.write(data.data(), data.size());
+    }};
+
+    TransportNetwork loaded {};
+    BOOST_REQUIRE(loaded.AddStation({"station_old", "Old Station"}));
+
+    // Corrupted payload.
+    auto corrupted {content};
+    corrupted[corrupted.size() / 2] ^= 0x01;
+    writeFile(corrupted);
+    BOOST_CHECK(!loaded.LoadSnapshot(snapshotPath));
+
+    // Truncated file.
+    writeFile(content.substr(0, content.size() - 8));
+    BOOST_CHECK(!loaded.LoadSnapshot(snapshotPath));
+
+    // Wrong format version.
+    auto version {content};
+    version[8] ^= 0x01;
+    writeFile(version);
+    BOOST_CHECK(!loaded.LoadSnapshot(snapshotPath));
+
+    // Not a snapshot.
+    writeFile("{}");
+    BOOST_CHECK(!loaded.LoadSnapshot(snapshotPath));
+
+    // Missing file.
+    std::filesystem::remove(snapshotPath);
+    BOOST_CHECK(!loaded.LoadSnapshot(snapshotPath));
+
+    // The network is unchanged.
+    BOOST_CHECK_EQUAL(loaded.GetStationCount(), 1);
+    BOOST_CHECK(loaded.GetStationHandle("station_old").IsValid());
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // Snapshot
+
 BOOST_AUTO_TEST_SUITE_END(); // class_TransportNetwork
 
 BOOST_AUTO_TEST_SUITE_END(); // network_monitor
\ No newline at end of file